@@ -4,5 +4,5 @@
 
 USER_OBJS :=
 
-LIBS := -lprotoc -lprotobuf
+LIBS := -lprotoc -lprotobuf -lpthread
 
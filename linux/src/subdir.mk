@@ -5,14 +5,41 @@
 # Add inputs and outputs from these tool invocations to the build variables 
 CC_SRCS += \
 ../src/docbook_generator.cc \
+../src/docbook_heap_profile.cc \
+../src/docbook_number_format.cc \
+../src/docbook_ordered_queue.cc \
+../src/docbook_parsed_sources.cc \
+../src/docbook_plugin.cc \
+../src/docbook_sized_stream.cc \
+../src/docbook_task_scheduler.cc \
+../src/docbook_thread.cc \
+../src/docbook_watch.cc \
 ../src/main.cc 
 
 OBJS += \
 ./src/docbook_generator.o \
+./src/docbook_heap_profile.o \
+./src/docbook_number_format.o \
+./src/docbook_ordered_queue.o \
+./src/docbook_parsed_sources.o \
+./src/docbook_plugin.o \
+./src/docbook_sized_stream.o \
+./src/docbook_task_scheduler.o \
+./src/docbook_thread.o \
+./src/docbook_watch.o \
 ./src/main.o 
 
 CC_DEPS += \
 ./src/docbook_generator.d \
+./src/docbook_heap_profile.d \
+./src/docbook_number_format.d \
+./src/docbook_ordered_queue.d \
+./src/docbook_parsed_sources.d \
+./src/docbook_plugin.d \
+./src/docbook_sized_stream.d \
+./src/docbook_task_scheduler.d \
+./src/docbook_thread.d \
+./src/docbook_watch.d \
 ./src/main.d 
 
 
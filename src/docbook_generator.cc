@@ -1,1642 +1,6569 @@
-// protoc-gen-docbook
-// http://code.google.com/p/protoc-gen-docbook/
-//
-// Redistribution and use in source and binary forms, with or without
-//// modification, are permitted provided that the following conditions are
-// met:
-//
-//     * Redistributions of source code must retain the above copyright
-// notice, this list of conditions and the following disclaimer.
-//     * Redistributions in binary form must reproduce the above
-// copyright notice, this list of conditions and the following disclaimer
-// in the documentation and/or other materials provided with the
-// distribution.
-//     * Neither the name of Google Inc. nor the names of its
-// contributors may be used to endorse or promote products derived from
-// this software without specific prior written permission.
-//
-// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
-// "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
-// LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
-// A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
-// OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
-// SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
-// LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
-// DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
-// THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
-// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
-// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
-//
-// Author: askldjd@gmail.com
-//
-// This file holds the generator that walks through the proto descriptor
-// structures and convert them to DocBook tables.
-// See http://code.google.com/p/protoc-gen-docbook/ for more information.
-//
-
-#include "docbook_generator.h"
-#include <google/protobuf/io/printer.h>
-#include <google/protobuf/io/zero_copy_stream.h>
-#include <google/protobuf/descriptor.pb.h>
-#include <google/protobuf/stubs/strutil.h>
-#include <iostream>
-#include <fstream>
-#include <string>
-#include <sstream>
-#include <map>
-#include <iomanip>
-// For debugging only
-//#include <Windows.h>
-
-namespace google { namespace protobuf { namespace compiler { namespace docbook {
-
-namespace utils {
-
-	//! @details
-	//! Helper method to trim the beginning and ending white spaces within 
-	//! a string.
-	string Trim(const string& str)
-	{
-		string s = str;
-		unsigned int p;
-		while ((p = s.length()) > 0 && (unsigned char)s[p-1] <= ' ')
-			s.resize(p-1);
-		while ((p = s.length()) > 0 && (unsigned char)s[0] <= ' ')
-			s.erase(0, 1);
-		return s;
-	}
-
-	//! @details
-	//! This method parses a Java like .properties file that is k=v pairs.
-	//!
-	//! @param[in] filePath
-	//! File path to the property file.
-	//!
-	//! @return
-	//! k/v pairs that represents the property file.
-	//!
-	//! @remark
-	//! Hate to reinvent the wheel here since there are about a million 
-	//! parser implementations out there. However, I hate to bring in Boost 
-	//! library just for something this trivial.
-	//!
-	//! This parser isn't smart enough to strip out comments on the
-	//! same line as the k/v pair.
-	std::map <string, string> ParseProperty(string const &filePath)
-	{
-		std::map <string, string> options;
-		std::ifstream ifs(filePath.c_str(), std::ifstream::in);
-		if(ifs.is_open())
-		{
-			string line;
-			while(std::getline(ifs, line))
-			{
-				line = Trim(line);
-
-				// First non-space char that is '#' is a comment line.
-				if(line.empty() == false && line[0]=='#') 
-					continue;
-
-				int p = 0;
-				if ((p = (int)line.find('=')) > 0)
-				{
-					string k = Trim(line.substr(0, p));
-					string v = Trim(line.substr(p+1));
-					if (!k.empty() && !v.empty())
-						options[k] = v;
-				}
-			}
-		}
-
-		ifs.close();
-		return options;
-	}
-}
-
-namespace {
-
-	//! These options are part of the layout look-and-feel parameters that
-	//! adjusts the informaltable column widths.
-	char const* OPTION_NAME_FIELD_NAME_COLUMN_WIDTH = "field_name_column_width";
-	char const *OPTION_NAME_FIELD_TYPE_COLUMN_WIDTH = "field_type_column_width";
-	char const *OPTION_NAME_FIELD_RULE_COLUMN_WIDTH = "field_rules_column_width";
-	char const *OPTION_NAME_FIELD_DESC_COLUMN_WIDTH = "field_desc_column_width";
-
-	//! These options are part of the layout look-and-feel parameters that
-	//! adjusts the informaltable color scheme
-	char const *OPTION_NAME_COLUMN_HEADER_COLOR = "column_header_color";
-	char const *OPTION_NAME_ROW_COLOR = "row_color"; // odd rows color
-	char const *OPTION_NAME_ROW_COLOR_ALT = "row_color_alt"; // even rows color
-
-	//! @details
-	//! Scalar Value Table is a table that holds descriptions for primitive 
-	//! types in protobuf (e.g. int32, fixed32, etc). It is a convenient reminder
-	//! on what those type means.
-	//!
-	//! 1 to include 
-	//! 0 to exclude
-	//!
-	char const *OPTION_NAME_INCLUDE_SCALAR_VALUE_TABLE = "include_scalar_value_table";
-
-	//! @details
-	//! Each table generated by protoc-gen-docbook is under a <section> tag with
-	//! a specific level. (e.g. sec1, sect2 ... sect5)
-	//! By adjusting this field, you may increase the first section level used.
-	//! [default = 1, must be <= 5]
-	char const *OPTION_NAME_STARTING_SECTION_LEVEL = "starting_section_level";
-
-	//! @details
-	//! Add a timestamp at the bottom of the document to indicate when it was
-	//! generated.
-	//!
-	//! This option is only available if custom template is NOT used.
-	//!
-	//! 1 to include
-	//! 0 to exclude
-	//!
-	//! [default = 0]
-	char const *OPTION_NAME_INCLUDE_TIMESTAMP = "include_timestamp";
-
-	//! @details
-	//! Preserve line breaks within the comment in .proto into the generated DocBook.
-	//! This implies all \r\n or \n will be converted into <sbr/>
-	//!
-	//! 1 to preserve
-	//! 0 to ignore (All line breaks in comment converts into space.)
-	//!
-	//! [default = 0]
-	//! See Issue #3
-	char const *OPTION_NAME_PRESERVE_COMMENT_LINE_BREAKS = "preserve_comment_line_breaks";
-
-	//! @details
-	//! Custom template file allows user to provide their own template file
-	//! and use "insertion point" to pinpoint where the tables should be
-	//! located. If not provided, a default template is provided.
-	char const *OPTION_NAME_CUSTOM_TEMPLATE_FILE = "custom_template_file";
-
-	//! @details
-	//! Default output file name, not adjustable at the moment.
-	char const *DEFAULT_OUTPUT_NAME = "docbook_out.xml";
-
-	char const *DEFAULT_INSERTION_POINT= "insertion_point";
-
-	char const *SCALAR_TABLE_INSERTION_POINT = "scalar_table";
-
-	char const *SCALAR_VALUE_TYPES_TABLE_XML_ID = "protobuf_scalar_value_types";
-
-	//! @details
-	//! Column width measurement
-	//!
-	//! From DocBook official documentation:
-	//! ColWidth specifies the desired width of the relevant column. 
-	//! It can be either a fixed measure using one of the CALS units 
-	//! (36pt, 10pc, etc.) or a proportional measure. Proportional measures 
-	//! have the form number*, meaning this column should be number times 
-	//! wider than a column with the measure 1* (or just *). These two forms 
-	//! can be mixed, as in 3*+1pc. 
-	//! See http://www.docbook.org/tdg/en/html/colspec.html
-	char const *DEFAULT_FIELD_NAME_COLUMN_WIDTH = "3";
-	char const *DEFAULT_FIELD_TYPE_COLUMN_WIDTH = "2";
-	char const *DEFAULT_FIELD_RULES_COLUMN_WIDTH = "2";
-	char const *DEFAULT_FIELD_DESC_COLUMN_WIDTH = "6";
-
-	//! @details
-	//! The insertion points syntax is defined by protobuf library.
-	//! See https://developers.google.com/protocol-buffers/docs/reference/cpp/google.protobuf.compiler.plugin.pb
-	char const *INSERTION_POINT_START_TAG = "<!-- @@protoc_insertion_point(";
-	char const *INSERTION_POINT_END_TAG = ") -->";
-	
-	//! @details
-	//! Highest <section> level, defined by DocBook
-	//! see http://oreilly.com/openbook/docbook/book/sect1.html
-	int const MAX_SECTION_LEVEL = 5;
-
-	//! @details
-	//! Highest <section> level allowed by the user.
-	//! protoc-gen-doc needs at least 2 levels to operate correctly
-	//! Worst case, we may use sect4 and sect5.
-	int const MAX_ALLOWED_SECTION_LEVEL_OPTION = 4;
-
-	//! @details
-	//! K/V pair that holds the options name and the options value.
-	std::map<string, string> s_docbookOptions;
-
-	//! @details
-	//! Static field that controls the row color. May be overridden through
-	//! OPTION_NAME_ROW_COLOR.
-	string s_rowColor = "ffffff";
-
-	//! @details
-	//! Static field that controls the alternate row color. May be 
-	//! overridden through OPTION_NAME_ROW_COLOR_ALT.
-	string s_rowColorAlt = "f0f0f0";
-
-	//! @details
-	//! Static field that controls the header color. May be overridden through
-	//! OPTION_NAME_COLUMN_HEADER_COLOR.
-	string s_columnHeaderColor = "A6B4C4";
-
-	//! @details
-	//! The name of the custom template file.
-	//! see s_customTemplateFile
-	string s_customTemplateFileName;
-
-	//! @details
-	//! Merge the output table into the template file. This is optional.
-	//! If template file is not specified, we should run in stand-alone
-	//! mode to generate a complete document.
-	string s_customTemplateFile;
-
-	//! @details
-	//! To include or exclude the scalar value table.
-	//! See OPTION_NAME_INCLUDE_SCALAR_VALUE_TABLE
-	bool s_includeScalarValueTable = true;
-
-	//! @details
-	//! To include or exclude the timestamp in the generated document.
-	//! See OPTION_NAME_INCLUDE_TIMESTAMP
-	bool s_includeTimestamp = false;
-
-	//! @details
-	//! To preserve line breaks from comment field in the generated document.
-	//! See OPTION_NAME_PRESERVE_COMMENT_LINE_BREAKS
-	bool s_preserve_comment_line_breaks = false;
-
-	//! @details
-	//! This field marks the first time DocBookGenerator::Generate method is
-	//! called. If it is the first time, we need to generate the template 
-	//! DocBook file. 
-	//!
-	//! @remark
-	//! In case you are wondering, yes this is a hack. The problem is that
-	//! the DocBookGenerator::Generate by const by contract, and therefore
-	//! can only be stateless. This is likely because in normal language, 
-	//! every .proto file tends to generate its own source file, but 
-	//! DocbookGenerator needs to merge them all into the same xml file. The 
-	//! nature of this incompatibility results in this hack.
-	bool s_templateFileMade = false;
-
-	//! @details
-	//! Name of the DocBook output file.
-	string s_docbookOuputFileName = DEFAULT_OUTPUT_NAME;
-
-	//! @details
-	//! The starting <sect> used for the generated table.
-	int s_startingSectionLevel = 1;
-
-	int const NUM_SCALAR_TABLE_TYPE = 15;
-	int const NUM_SCALAR_TABLE_COLUMN = 4;
-
-	//! @details
-	//! Giant table used for the Scalar Type Table. This information is
-	//! copied directly from protobuf guide.
-	char const * s_scalarTable[NUM_SCALAR_TABLE_TYPE][NUM_SCALAR_TABLE_COLUMN] = {
-		{
-			"double", 
-				"", 
-				"double", 
-				"double"
-		} 
-		, 
-		{
-			"float", 
-				"", 
-				"float", 
-				"float"
-		} 
-		, 	
-		{
-			"int32", 
-				"Uses variable-length encoding. Inefficient for encoding \
-				negative numbers - if your field is likely to have negative \
-				values, use sint32 instead.", 
-				"int32", 
-				"int"
-		} 
-		, 	
-		{
-			"int64", 
-				"Uses variable-length encoding. Inefficient for encoding \
-				negative numbers - if your field is likely to have negative \
-				values, use sint64 instead.", 
-				"int64", 
-				"long"
-		} 
-		, 	
-		{
-			"uint32", 
-				"Uses variable-length encoding.", 
-				"uint32", 
-				"int"
-		} 
-		, 	
-		{
-			"uint64", 
-				"	Uses variable-length encoding.", 
-				"uint64", 
-				"long"
-		} 
-		, 	
-		{
-			"sint32", 
-				"Uses variable-length encoding. Signed int value. These \
-				more efficiently encode negative numbers than regular int32s.", 
-				"int32", 
-				"int"
-		} 
-		, 	
-		{
-			"sint64", 
-				"Uses variable-length encoding. Signed int value. These more\
-				efficiently encode negative numbers than regular int64s.", 
-				"int64", 
-				"long"
-		} 
-		, 	
-		{
-			"fixed32", 
-				"Always four bytes. More efficient than uint32 if values are \
-				often greater than 2^28.", 
-				"uint32", 
-				"int"
-		} 
-		, 	
-		{
-			"fixed64", 
-				"Always eight bytes. More efficient than uint64 if values \
-				are often greater than 2^56.", 
-				"uint64", 
-				"long"
-		} 
-		, 	
-		{
-			"sfixed32", 
-				"Always four bytes..", 
-				"int32", 
-				"int"
-		} 
-		, 	
-		{
-			"sfixed64", 
-				"Always eight bytes.", 
-				"int64", 
-				"long"
-		} 
-		, 	
-		{
-			"bool", 
-				"", 
-				"bool", 
-				"boolean"
-		} 
-		, 	
-		{
-			"string", 
-				"	A string must always contain UTF-8 encoded or 7-bit ASCII text.", 
-				"string", 
-				"String"
-		} 
-		, 	
-		{
-			"bytes", 
-				"May contain any arbitrary sequence of bytes.", 
-				"string", 
-				"ByteString"
-		} 
-	};
-
-	//! @details
-	//! Clean up the comment string for any special characters
-	//! to ensure it is acceptable in XML format.
-	//!
-	//! @warning
-	//! Currently this method does not handle UTF-8 correctly, and this
-	//! should be revisited if unicode comments become a concern.
-	//!
-	string SanitizeCommentForXML(string const &comment)
-	{
-		string cleanedComment;
-		cleanedComment.reserve(comment.size());
-		for(size_t pos = 0; pos != comment.size(); ++pos) 
-		{
-			char c = comment[pos];
-			switch(c) 
-			{
-			case '&':  
-				cleanedComment.append("&amp;");       
-				break;
-			case '\"': 
-				cleanedComment.append("&quot;");      
-				break;
-			case '\'': 
-				cleanedComment.append("&apos;");      
-				break;
-			case '<':  
-				cleanedComment.append("&lt;");
-				break;
-			case '>':  
-				cleanedComment.append("&gt;");
-				break;
-			case '\n':
-				if(s_preserve_comment_line_breaks) 
-				{
-					cleanedComment.append("<sbr/>");
-				}				
-				break;
-			case '\r':
-				cleanedComment.append(" ");				
-				break;
-			default:
-				// Space out all null character because stream can't handle it.
-				if(c == 0) 
-				{
-					c = ' ';
-				}
-				cleanedComment.append(1, c); 
-				break;
-			}
-		}
-		return cleanedComment;
-	}
-
-
-	//! @details
-	//! Turn comments into docbook paragraph form by replacing 
-	//! every 2 newlines into a paragraph.
-	//! Experimental, doesn't seem to work too well in all scenarios.
-	string ParagraphFormatComment(string const &comment)
-	{
-		string cleanComment = SanitizeCommentForXML(comment);
-
-		// Occasionally there are some comments that has nothing but white
-		// spaces. This will eliminate those useless fillers and sanitize the
-		// comments.
-		if(utils::Trim(cleanComment).empty())
-		{
-			return "";
-		}
-
-		size_t index = 0;
-		string paragraph  = "<para>";
-		paragraph += cleanComment;
-		for(;;)
-		{
-			index = paragraph.find("\n\n", index);
-			if (index == string::npos)
-				break;
-
-			paragraph.replace(index, 2, "</para>\n<para>");
-
-			index += 3;
-		}
-		paragraph += "</para>";
-		return paragraph;
-	}
-
-	//! @details
-	//! Helper method that guards the section level field.
-	//!
-	//! @param[in] sectionLevel
-	//! level to guard
-	//!
-	//! @return
-	//! MAX_SECTION_LEVEL if too large, 1 if <= 0
-	int SectionLevel(int sectionLevel)
-	{
-		if(sectionLevel > MAX_SECTION_LEVEL)
-			return MAX_SECTION_LEVEL;
-
-		if(sectionLevel <= 0)
-			return 1;
-
-		return sectionLevel;
-	}
-
-	//! @details
-	//! Generate a Xlink for a message. This Xlink allows user to click
-	//! and navigate to different messages and enums.
-	//!
-	//! @param[in,out] string const & messageName
-	//! The full globally uniquue message name used to generate the link.
-	//!
-	//! @param[in,out] string const & displayName
-	//! The name of the link to display to user
-	//!
-	//! @return std::string
-	//! The generated Xlink
-	//!
-	string MakeXLink(string const &messageName, string const &displayName)
-	{
-		std::ostringstream os;
-
-		// Can't have "." in link, so replace them with underscores.
-		string refName = messageName;
-		std::replace(refName.begin(), refName.end(), '.', '_');
-
-		os 
-			<< "<emphasis role=\"underline\""
-			<< " xlink:href=\"" << "#" << refName << "\">"
-			<< displayName<< "</emphasis>";
-
-		return os.str();
-	}
-
-	//! @details
-	//! Generate a Xlink to the Scalar Table. 
-	//! See OPTION_NAME_INCLUDE_SCALAR_VALUE_TABLE
-	//!
-	//! @param[in,out] string const & displayName
-	//! The name of the link to display to user
-	//!
-	//! @return std::string
-	//! The generated Xlink
-	//!
-	string MakeXLinkScalarTable(string const &displayName)
-	{
-		std::ostringstream os;
-
-		os 
-			<< "<emphasis role=\"underline\""
-			<< " xlink:href=\"" << "#" << SCALAR_VALUE_TYPES_TABLE_XML_ID << "\">"
-			<< displayName<< "</emphasis>";
-
-		return os.str();
-	}
-
-	//! @details
-	//! Helper method to return an informative string if "packed" option
-	//! is enabled.
-	//! See https://developers.google.com/protocol-buffers/docs/proto
-	string MakePackedString(FieldDescriptor const *fd)
-	{
-		if(fd->is_packed())
-		{
-			return "[packed = true]";
-		}
-		return "";
-	}
-
-
-	//! @details
-	//! This method generate an informative default string if the field
-	//! has a default value.
-	//!
-	//! @param[in,out] FieldDescriptor const * fd
-	//! The descriptor of the field that may have the default value.
-	//!
-	//! @return std::string
-	//! A string that contains the default value, empty if no defaults.
-	//!
-	string MakeDefaultValueString(FieldDescriptor const *fd)
-	{
-		std::ostringstream defaultStringOs;
-		if(fd->has_default_value())
-		{
-			defaultStringOs << "\n[default = ";
-			switch(fd->type())
-			{
-			case FieldDescriptor::TYPE_BOOL:
-				{
-					if(fd->default_value_bool())
-						defaultStringOs << "true";
-					else 
-						defaultStringOs << "false";
-				}
-				break;
-			case FieldDescriptor::TYPE_BYTES:
-				{
-					std::string const &bytes = fd->default_value_string();
-					std::ostringstream ss;
-					ss << std::hex << std::uppercase << std::setfill( '0' );
-					for(unsigned int i=0; i<bytes.size(); ++i)
-					{
-						ss << std::setw( 2 ) << (int)bytes[i]<< ' ';
-					}
-
-					defaultStringOs << ss.str();
-				}
-				break;
-			case FieldDescriptor::TYPE_STRING:
-				defaultStringOs << SanitizeCommentForXML(fd->default_value_string());
-				break;
-			case FieldDescriptor::TYPE_DOUBLE:
-				defaultStringOs << fd->default_value_double();
-				break;
-			case FieldDescriptor::TYPE_ENUM:
-				defaultStringOs << fd->default_value_enum()->name();
-				break;
-			case FieldDescriptor::TYPE_FIXED32:
-				defaultStringOs << fd->default_value_int32();
-				break;
-			case FieldDescriptor::TYPE_FIXED64:
-				defaultStringOs << fd->default_value_int64();
-				break;
-			case FieldDescriptor::TYPE_FLOAT:
-				defaultStringOs << fd->default_value_float();
-				break;
-			case FieldDescriptor::TYPE_GROUP:
-				break;
-			case FieldDescriptor::TYPE_INT32:
-				defaultStringOs << fd->default_value_int32();
-				break;
-			case FieldDescriptor::TYPE_INT64:
-				defaultStringOs << fd->default_value_int64();
-				break;
-			case FieldDescriptor::TYPE_SFIXED32:
-				defaultStringOs << fd->default_value_int32();
-				break;
-			case FieldDescriptor::TYPE_SFIXED64:
-				defaultStringOs << fd->default_value_int64();
-				break;
-			case FieldDescriptor::TYPE_SINT32:
-				defaultStringOs << fd->default_value_int32();
-				break;
-			case FieldDescriptor::TYPE_SINT64:
-				defaultStringOs << fd->default_value_int64();
-				break;
-			case FieldDescriptor::TYPE_UINT32:
-				defaultStringOs << fd->default_value_uint32();
-				break;
-			case FieldDescriptor::TYPE_UINT64:
-				defaultStringOs << fd->default_value_uint64();
-				break;
-			default:
-				return "";
-			}
-
-			defaultStringOs << " ]";
-		}
-
-		string packedString = MakePackedString(fd);
-
-		if(packedString.empty() == false) 
-		{
-			defaultStringOs << " " << packedString;
-		}
-		return defaultStringOs.str();
-	}
-
-	template <typename DescriptorType>
-	static string GetDescriptorComment(const DescriptorType* descriptor) {
-		SourceLocation location;
-		string comments;
-		if (descriptor->GetSourceLocation(&location)) {
-			comments = location.leading_comments;
-			comments += " ";
-			comments += location.trailing_comments;
-		}
-
-		return comments;
-	}
-
-	//! @details
-	//! Docbook header that wraps the document under the Article tag.
-	//!
-	//! @param[in,out] std::ostringstream & os
-	//! The accumulated stream.
-	void WriteDocbookHeader(std::ostringstream &os)
-	{
-		os 
-			<< "<?xml version=\"1.0\""
-			<< " encoding=\"utf-8\""
-			<< " standalone=\"no\"?>"
-			<< "<article xmlns=\"http://docbook.org/ns/docbook\""
-			<< " xmlns:xlink=\"http://www.w3.org/1999/xlink\""
-			<< " version=\"5.0\">" 
-			<< std::endl;		
-	}
-
-	//! @details
-	//! Docbook footer that closes the article tag
-	//!
-	//! @param[in,out] std::ostringstream & os
-	//! The accumulated stream.
-	void WriteDocbookFooter(std::ostringstream &os)
-	{
-		if(s_includeTimestamp)
-		{
-			// Use "Complete ISO date and time, including offset from UTC."
-			// See http://www.sagehill.net/docbookxsl/Datetime.html for 
-			// formatting options.
-			os << "<para>This document was generated <?dbtimestamp \
-				  format=\"c\"?>.</para>" << std::endl;
-		}
-		os << "</article>" << std::endl;		
-	}
-
-	void WriteProtoFileHeader(
-		std::ostringstream &os, 
-		FileDescriptor const *fd, 
-		int sectionLevel)
-	{
-		os 
-			<< "<sect" << SectionLevel(sectionLevel) << ">"
-			<< "<title> File: " << fd->name() << "</title>" << std::endl;
-	}
-
-	//! @details
-	//! Proto file footer that closes the file section scope.
-	//!
-	//! @param[in,out] std::ostringstream & os
-	//! The accumulated stream.
-	//!
-	//! @param[in] int sectionLevel
-	//!
-	//! @return void
-	
-	void WriteProtoFileFooter(std::ostringstream &os, int sectionLevel)
-	{
-		os << "</sect" << SectionLevel(sectionLevel) << ">" << std::endl;
-	}
-
-	//! @details
-	//! Write the Informal Table Header for a Message type.
-	//! This will define the column header, width and style of the
-	//! field table.
-	void WriteMessageInformalTableHeader(
-		std::ostringstream &os, 
-		string const &xmlID, 
-		string const &title,
-		string const &comment,
-		int sectionLevel)
-	{
-		std::map<string,string>::const_iterator itr;
-
-		string paragraphComment = ParagraphFormatComment(comment);
-
-		os 
-			<< "<sect" << SectionLevel(sectionLevel) << ">"
-			<< "<title> Message: " << title << "</title>" << std::endl
-			<< paragraphComment << std::endl
-			<< "<informaltable frame=\"all\""
-			<< " xml:id=\"" << xmlID << "\">" << std::endl
-			<< "<tgroup cols=\"4\">" << std::endl
-			<< " <colspec colname=\"c1\" colnum=\"1\" colwidth=\"";
-
-		itr = s_docbookOptions.find(OPTION_NAME_FIELD_NAME_COLUMN_WIDTH);
-		if(itr != s_docbookOptions.end())
-			os << itr->second;
-		else
-			os << DEFAULT_FIELD_NAME_COLUMN_WIDTH;
-
-		os
-			<< "*\" />"<< std::endl
-			<< "<colspec colname=\"c2\" colnum=\"2\""
-			<< " colwidth=\"";
-
-		itr = s_docbookOptions.find(OPTION_NAME_FIELD_TYPE_COLUMN_WIDTH);
-		if(itr != s_docbookOptions.end())
-			os << itr->second;
-		else
-			os << DEFAULT_FIELD_TYPE_COLUMN_WIDTH;
-
-		os
-			<< "*\" />" << std::endl
-			<< "<colspec colname=\"c3\" colnum=\"3\""
-			<< " colwidth=\"";
-
-		itr = s_docbookOptions.find(OPTION_NAME_FIELD_RULE_COLUMN_WIDTH);
-		if(itr != s_docbookOptions.end())
-			os << itr->second;
-		else
-			os << DEFAULT_FIELD_RULES_COLUMN_WIDTH;
-
-		os
-			<< "*\" />" << std::endl
-			<< "<colspec colname=\"c4\" colnum=\"4\""
-			<< " colwidth=\"";
-
-		itr = s_docbookOptions.find(OPTION_NAME_FIELD_DESC_COLUMN_WIDTH);
-		if(itr != s_docbookOptions.end())
-			os << itr->second;
-		else
-			os << DEFAULT_FIELD_DESC_COLUMN_WIDTH;
-
-		os
-			<<"*\" />" << std::endl
-			<< "<thead>" << std::endl
-			<< "<row>" << std::endl
-			<< "<?dbhtml bgcolor=\"#";
-
-		os << s_columnHeaderColor;
-
-		os
-			<<"\" ?>"<< std::endl
-			<< "<?dbfo bgcolor=\"#";
-
-		os << s_columnHeaderColor;
-		os
-			<<"\" ?>"<< std::endl
-			<< "\t<entry>Field</entry>" << std::endl
-			<< "\t<entry>Type</entry>"<< std::endl
-			<< "\t<entry>Rule</entry>"<< std::endl
-			<< "\t<entry>Description</entry>"<< std::endl
-			<< "</row>"<< std::endl
-			<< "</thead>"<< std::endl
-			<< "<tbody>"<< std::endl;
-	}
-
-	void WriteEnumInformalTableHeader(
-		std::ostringstream &os, 
-		string const &xmlID, 
-		string const &title,
-		string const &description,
-		int sectionLevel)
-	{
-		std::map<string,string>::const_iterator itr;
-
-		os 
-			<< "<sect" << SectionLevel(sectionLevel) << ">"
-			<< "<title> Enum: " << title << "</title>" << std::endl
-			<< "<para>" << description << "</para>" << std::endl
-			<< "<informaltable frame=\"all\""
-			<< " xml:id=\"" << xmlID << "\">" << std::endl
-			<< "<tgroup cols=\"3\">" << std::endl
-			<< " <colspec colname=\"c1\" colnum=\"1\" colwidth=\"";
-
-		itr = s_docbookOptions.find(OPTION_NAME_FIELD_NAME_COLUMN_WIDTH);
-		if(itr != s_docbookOptions.end())
-			os << itr->second;
-		else
-			os << DEFAULT_FIELD_NAME_COLUMN_WIDTH;
-
-		os
-			<< "*\" />"<< std::endl
-			<< "<colspec colname=\"c2\" colnum=\"2\""
-			<< " colwidth=\"";
-
-		itr = s_docbookOptions.find(OPTION_NAME_FIELD_TYPE_COLUMN_WIDTH);
-		if(itr != s_docbookOptions.end())
-			os << itr->second;
-		else
-			os << DEFAULT_FIELD_TYPE_COLUMN_WIDTH;
-
-		os
-			<< "*\" />" << std::endl
-			<< "<colspec colname=\"c3\" colnum=\"3\""
-			<< " colwidth=\"";
-
-		itr = s_docbookOptions.find(OPTION_NAME_FIELD_DESC_COLUMN_WIDTH);
-		if(itr != s_docbookOptions.end())
-			os << itr->second;
-		else
-			os << DEFAULT_FIELD_RULES_COLUMN_WIDTH;
-
-		os
-			<< "*\" />" << std::endl
-			<< "<thead>" << std::endl
-			<< "<row>" << std::endl
-			<< "<?dbhtml bgcolor=\"#";
-
-		os << s_columnHeaderColor;
-
-		os
-			<<"\" ?>"<< std::endl
-			<< "<?dbfo bgcolor=\"#";
-
-		os << s_columnHeaderColor;
-
-		os
-			<<"\" ?>"<< std::endl
-			<< "\t<entry>Element</entry>" << std::endl
-			<< "\t<entry>Value</entry>"<< std::endl
-			<< "\t<entry>Description</entry>"<< std::endl
-			<< "</row>"<< std::endl
-			<< "</thead>"<< std::endl
-			<< "<tbody>"<< std::endl;
-	}
-
-	void WriteInformalTableFooter(std::ostringstream &os)
-	{
-		os 
-			<< "</tbody>"<< std::endl
-			<< "</tgroup>"<< std::endl
-			<< "</informaltable>"<< std::endl;
-	}
-
-	//! @details
-	//! Writes out the close section tag.
-	//! 
-	void WriteCloseSection(std::ostringstream &os, int sectionLevel)
-	{
-		os << "</sect"<< SectionLevel(sectionLevel) << ">" <<std::endl;
-	}
-
-	void WriteInformalTableFooter(std::ostringstream &os, int sectionLevel)
-	{
-		os 
-			<< "</tbody>"<< std::endl
-			<< "</tgroup>"<< std::endl
-			<< "</informaltable>"<< std::endl
-			<< "</sect"<< SectionLevel(sectionLevel) << ">" <<std::endl;
-	}
-
-	void WriteMessageInformalTableEntry(
-		std::ostringstream &os, 
-		string const &fieldname,
-		string const &type,
-		string const &occurrence,
-		string const &defaultString,
-		string const &comment,
-		bool alternateColor)
-	{
-		string paragraphComment = ParagraphFormatComment(comment);
-		string cellcolor = s_rowColor;
-		if(alternateColor)
-		{
-			cellcolor = s_rowColorAlt;
-		}
-		os 
-			<< "<row>"
-			<< "<?dbhtml bgcolor=\"#" << cellcolor <<"\" ?>" << std::endl
-			<<"<?dbfo bgcolor=\"#" << cellcolor <<"\" ?>"<< std::endl
-			<< "\t<entry>" << fieldname << "</entry>" << std::endl
-			<< "\t<entry>" << type << "</entry>" << std::endl
-			<< "\t<entry>" << occurrence << "</entry>" << std::endl
-			<< "\t<entry>" << paragraphComment;
-
-		if(defaultString.empty() == false)
-		{
-			if(paragraphComment.empty())
-			{
-				os << defaultString << std::endl;
-			}
-			else
-			{
-				os << "<para>" << defaultString << "</para>" << std::endl;
-			}
-		}
-
-		os << "</entry>" << std::endl;
-		
-		os
-			<< "</row>"<<std::endl
-			<< std::endl;
-	}
-
-	void WriteEnumInformalTableEntry(
-		std::ostringstream &os, 
-		string const &fieldname,
-		int enumValue,
-		string const &comment,
-		bool alternateColor)
-	{
-		string paragraphComment = ParagraphFormatComment(comment);
-
-		string cellcolor = s_rowColor;
-		if(alternateColor)
-		{
-			cellcolor = s_rowColorAlt;
-		}
-
-		os 
-			<< "<row>"<<std::endl
-			<< "<?dbhtml bgcolor=\"#" << cellcolor <<"\" ?>" << std::endl
-			<<"<?dbfo bgcolor=\"#" << cellcolor <<"\" ?>"<< std::endl
-			<< "\t<entry>" << fieldname << "</entry>" << std::endl
-			<< "\t<entry>" << enumValue << "</entry>" << std::endl
-			<< "\t<entry>" << paragraphComment << "</entry>" << std::endl
-			<< "</row>"<<std::endl
-			<< std::endl;
-	}
-
-	void WriteMessageFieldEntries( 
-		std::ostringstream &os, 
-		Descriptor const *messageDescriptor)
-	{
-		for (int i = 0; i < messageDescriptor->field_count(); i++) {
-			string labelStr;
-
-			FieldDescriptor const *fd = messageDescriptor->field(i);
-
-			switch(fd->label())
-			{
-			case FieldDescriptor::LABEL_OPTIONAL:
-				labelStr = "optional";
-				break;
-			case FieldDescriptor::LABEL_REPEATED:
-				labelStr = "repeated";
-				break;
-			case FieldDescriptor::LABEL_REQUIRED:
-				labelStr = "required";
-				break;
-			}
-
-			string typeName;
-
-			switch(fd->type())
-			{
-			case FieldDescriptor::TYPE_MESSAGE:
-				typeName = MakeXLink(
-					fd->message_type()->full_name(),
-					fd->message_type()->name());
-				break;
-			case FieldDescriptor::TYPE_ENUM:
-				typeName = MakeXLink(
-					fd->enum_type()->full_name(),
-					fd->enum_type()->name());
-				break;
-			default:
-
-				if(s_includeScalarValueTable)
-				{
-					typeName = MakeXLinkScalarTable(fd->type_name());
-				}
-				else
-				{
-					typeName = fd->type_name();
-				}
-				
-				break;
-			}
-
-			bool alternateColor = (i%2 != 0);
-			WriteMessageInformalTableEntry(
-				os, 
-				fd->name(),
-				typeName,
-				labelStr,
-				MakeDefaultValueString(fd),
-				GetDescriptorComment(fd),
-				alternateColor);
-		}
-	}
-
-	void WriteEnumFieldEntries(
-		std::ostringstream &os, 
-		EnumDescriptor const *enumDescriptor)
-	{
-		for (int i = 0; i < enumDescriptor->value_count(); i++) 
-		{
-			bool alternateColor = (i%2 != 0);
-			WriteEnumInformalTableEntry(
-				os, 
-				enumDescriptor->value(i)->name(),
-				i,
-				GetDescriptorComment(enumDescriptor->value(i)),
-				alternateColor);
-		}
-	}
-
-	//! @details
-	//! This method writes the Enum table that belongs to a descriptor.
-	//!
-	//! This method is templatized because Enums may live under file or message
-	//! descriptor under the protobuf definition. Since it is the same code,
-	//! template saves some time.
-	//!
-	//! @param[in] DescriptorType const * descriptor
-	//! The ptr to the descriptor
-	//!
-	//! @param[in,out] std::ostringstream & os
-	//! The accumulated string
-	//!
-	//! @param[in] string const & prefix
-	//! The prefix holds the scope of the enum. E.g. If the enum E is nested with 
-	//! message M, the prefix should be "M.". This way, it shows up as M.E in the 
-	//! document.
-	//!
-	//! @param[in] int section
-	//! Section level is used to describe which <secX> tag to use.
-	//!
-	template <typename DescriptorType>
-	void WriteEnumTable( 
-		DescriptorType const *descriptor, 
-		std::ostringstream &os,
-		string const &prefix,
-		int section)
-	{
-		for (int i = 0; i < descriptor->enum_type_count(); i++) 
-		{
-			EnumDescriptor const *enumDescriptor = descriptor->enum_type(i);
-
-			string xmlID = enumDescriptor->full_name();
-			std::replace(xmlID.begin(), xmlID.end(),'.','_');
-
-			string enumName;
-			if(prefix.empty() == false)
-			{
-				enumName = prefix;
-				enumName += ".";
-				enumName += enumDescriptor->name();
-			}
-			else
-			{
-				enumName = enumDescriptor->name();
-			}
-
-			WriteEnumInformalTableHeader(
-				os,
-				xmlID, 
-				enumName,
-				GetDescriptorComment(enumDescriptor),
-				section);
-
-			WriteEnumFieldEntries(os, enumDescriptor);
-			WriteInformalTableFooter(os, section);
-		}
-	}
-
-	//! @details
-	//! This method writes a table for a single message. If the message
-	//! has no fields, no tables will be written.
-	//!
-	//! @param[in,out] std::ostringstream & os
-	//! The accumulated string
-	//!
-	//! @param[in] Descriptor const * messageDescriptor
-	//! The ptr to the message descriptor
-	//!
-	//! @param[in] string const & descriptorName
-	//! The human readable name of this descriptor 
-	//!
-	//! @param[in] int sectionLevel
-	//! Section level is used to describe which <secX> tag to use.
-	//!
-	//! @return
-	//! true if a message is written, false otherwise. This is useful to
-	//! determine if a </sectX> tag is needed.
-	//!
-	bool WriteMessageTable(std::ostringstream &os, 
-		Descriptor const *messageDescriptor, 
-		string const &descriptorName,
-		int sectionLevel)
-	{
-		if(messageDescriptor->field_count() > 0)
-		{
-			// XML ID is an unique ID that is used in XLink. Since "." is not 
-			// allowed, some sanitization is needed by replacing "." with "_".
-			string xmlID = messageDescriptor->full_name();
-			std::replace(xmlID.begin(), xmlID.end(),'.', '_');
-
-			WriteMessageInformalTableHeader(
-				os,
-				xmlID, 
-				descriptorName,
-				GetDescriptorComment(messageDescriptor),
-				SectionLevel(sectionLevel));
-
-			WriteMessageFieldEntries(os, messageDescriptor);
-
-			WriteInformalTableFooter(os);
-
-			return true;
-		}
-
-		return false;
-	}
-
-	//! @details
-	//! Writes the message and recursively traverse its nested type into 
-	//! the stream.
-	//!
-	//! @param[in,out] std::ostringstream & os
-	//! Stream to write to.
-	//!
-	//! @param[in,out] Descriptor const * messageDescriptor
-	//! The message descriptor that we are writing at the moment
-	//!
-	//! @param[in,out] string const & prefix
-	//! The prefix that should be appended to the name.
-	//!
-	//! @param[in,out] int depth
-	//! The depth of the recursion we are in.
-	//!
-	void WriteMessage(
-		std::ostringstream &os, 
-		Descriptor const *messageDescriptor, 
-		string const &prefix, 
-		int depth)
-	{
-		// Append the prefix to descriptor name so that the name will be
-		// scoped descriptively. (E.g. name.child_type1.child_type2)
-		string descriptorName;
-		if(prefix.empty() == false)
-		{
-			descriptorName = prefix;
-			descriptorName += ".";
-			descriptorName += messageDescriptor->name();
-		}
-		else
-		{
-			descriptorName = messageDescriptor->name();
-		}
-
-		// Print this message with all of its field. This should generate a
-		// InformalTable type in DocBook for this message.
-		bool messageWritten = 
-			WriteMessageTable(os, messageDescriptor, descriptorName, depth);
-
-		// Print the enums nested with this message. Since enum is defined 
-		// within the message, its section level should be one below the 
-		// parent message, hence +3.
-		WriteEnumTable(messageDescriptor, os, descriptorName, depth+1);
-
-		// Base case for the recursive call. If there is no nested type, 
-		// then the formatting for this message is done.
-		// Otherwise, for each nested type, recursively print its own table.
-		// Because of the recursive layout, the deepest layered message will
-		// be printed last within its root message.
-		if(messageDescriptor->nested_type_count() > 0)
-		{
-			for(int i=0; i<messageDescriptor->nested_type_count(); ++i)
-			{
-				WriteMessage(
-					os, 
-					messageDescriptor->nested_type(i), 
-					descriptorName, 
-					depth+1);
-			}
-		}
-
-		// If a message was written, close the corresponding section. This 
-		// preserves the section hierarchy. See Issue #5.
-		if(messageWritten)
-		{
-			WriteCloseSection(os, depth);
-		}
-	}
-
-	//! @details
-	//! Scalar Value Table is a table that holds descriptions for primitive 
-	//! types in protobuf (e.g. int32, fixed32, etc). It is a convenient reminder
-	//! on what those type means.
-	//! 
-	//! see OPTION_NAME_INCLUDE_SCALAR_VALUE_TABLE
-	//!
-	//! see https://developers.google.com/protocol-buffers/docs/proto
-	void WriteScalarValueTable(std::ostringstream &os)
-	{
-		os 
-			<< "<sect1>"
-			<< "<title>Scalar Value Types</title>" << std::endl
-			<< "<para> A scalar message field can have one of the following types - \
-			   the table shows the type specified in the .proto file, and the \
-			   corresponding type in the automatically generated class: </para>" << std::endl
-			<< "<informaltable frame=\"all\""
-			<< " xml:id=\"" << SCALAR_VALUE_TYPES_TABLE_XML_ID << "\">" << std::endl
-			<< "<tgroup cols=\"4\">" << std::endl
-			<< " <colspec colname=\"c1\" colnum=\"1\" colwidth=\"2*\"/>" << std::endl
-			<< " <colspec colname=\"c2\" colnum=\"2\" colwidth=\"6*\"/>" << std::endl
-			<< " <colspec colname=\"c3\" colnum=\"3\" colwidth=\"2*\"/>" << std::endl
-			<< " <colspec colname=\"c4\" colnum=\"4\" colwidth=\"2*\"/>" << std::endl
-			<< "<thead>" << std::endl
-			<< "<row>" << std::endl
-
-			<< "<?dbhtml bgcolor=\"#" <<s_columnHeaderColor << "\" ?>" << std::endl
-			<< "<?dbfo bgcolor=\"#" <<s_columnHeaderColor << "\" ?>" << std::endl
-
-			<< "<entry>Type</entry>" << std::endl
-			<< "<entry>Notes</entry>" << std::endl
-			<< "<entry>C++ Type</entry>" << std::endl
-			<< "<entry>Java Type</entry>" << std::endl
-
-			<< "</row>" << std::endl
-			<< "</thead>" << std::endl
-			
-			<< "<tbody>" << std::endl;
-
-		int i=0;
-		int j=0;
-		for(i=0; i<NUM_SCALAR_TABLE_TYPE; ++i)
-		{
-			string cellcolor = s_rowColor;
-			if(i%2 == 1)
-			{
-				cellcolor = s_rowColorAlt;
-			}
-			os
-				<< "<row>"
-				<< "<?dbhtml bgcolor=\"#" <<cellcolor << "\" ?>" << std::endl
-				<< "<?dbfo bgcolor=\"#" <<cellcolor << "\" ?>" << std::endl;
-			for(j=0; j<NUM_SCALAR_TABLE_COLUMN; ++j)
-			{
-				os << "<entry>" << s_scalarTable[i][j] << "</entry>" << std::endl;
-			}
-			os<< "</row>" << std::endl;
-		}
-
-		os
-			<< "</tbody>" << std::endl
-			<< "</tgroup>" << std::endl
-			<< "</informaltable>" << std::endl
-			<< "</sect1>"<< std::endl;
-	}
-
-	//! @details
-	//! Makes the template file for the very first call of 
-	//! DocGenerator::Generate method. This is needed because 
-	//! GeneratorContext::OpenForInsert requires knowledge of the output file.
-	//! Hence, GeneratorContext::Open must be called once before 
-	//! GeneratorContext::OpenForInsert would work.
-	//!
-	//! @param[in,out] context
-	//! The generator context used to write the file.
-	void MakeTemplateFile(GeneratorContext &context)
-	{
-		// If there is no custom template filename, it implies that we
-		// are going to use the default file template.
-		if(s_customTemplateFileName.empty())
-		{
-			std::ostringstream defaultTemplateOs;
-			WriteDocbookHeader(defaultTemplateOs);		
-			defaultTemplateOs 
-				<< INSERTION_POINT_START_TAG
-				<< DEFAULT_INSERTION_POINT
-				<< INSERTION_POINT_END_TAG
-				<< std::endl;
-
-			if(s_includeScalarValueTable)
-			{
-				WriteScalarValueTable(defaultTemplateOs);
-			}
-
-			WriteDocbookFooter(defaultTemplateOs);
-
-			scoped_ptr<io::ZeroCopyOutputStream> output(
-				context.Open(s_docbookOuputFileName));
-
-			io::Printer printer(output.get(), '$');
-			printer.PrintRaw(defaultTemplateOs.str().c_str());
-		}
-		// Otherwise, user has provided a template. We use the user's
-		// template as base and clone a new file.
-		else
-		{
-			// This section writes the cloned file.
-			{
-				scoped_ptr<io::ZeroCopyOutputStream> output(
-					context.Open(s_docbookOuputFileName));
-
-				io::Printer printer(output.get(), '$');
-				printer.PrintRaw(s_customTemplateFile.c_str());
-			}
-			// This section copies the scalar table if necessary into
-			// the file.
-			{
-				if(s_includeScalarValueTable)
-				{
-					std::ostringstream os;
-					WriteScalarValueTable(os);
-
-					scoped_ptr<io::ZeroCopyOutputStream> output(
-						context.OpenForInsert(
-						s_docbookOuputFileName, 
-						SCALAR_TABLE_INSERTION_POINT));
-
-					io::Printer printer(output.get(), '$');
-					printer.PrintRaw(os.str().c_str());
-				}
-			}
-		}
-	}
-
-	//! @details
-	//! Get the file content into a string buffer.
-	//! 
-	//! @remarks
-	//! Apparently this is one of the fastest method out there.
-	//! http://insanecoding.blogspot.com/2011/11/reading-in-entire-file-at-once-in-c.html
-	std::string GetFileContent(char const *filename)
-	{
-		std::string contents;
-		std::ifstream in(filename, std::ios::in | std::ios::binary);
-		if (in)
-		{
-			in.seekg(0, std::ios::end);
-			contents.resize(in.tellg());
-			in.seekg(0, std::ios::beg);
-			in.read(&contents[0], contents.size());
-			in.close();
-			return(contents);
-		}
-
-		return contents;
-	}
-
-	//! 
-	//! @details
-	//! This method writes the accumulated data buffer into the 
-	//! GeneratorContext. This allows protoc framework to take care of the
-	//! file IO.
-	//!
-	//! @param[in,out] std::ostringstream & os
-	//! The accumulated stream so far.
-	//!
-	//! @param[in,out] GeneratorContext * context
-	//! The context that we are writing to.
-	//!
-	//! @param[in,out] string * error
-	//! Error strings that may be passed out.
-	//!
-	//! @param[in,out] string const & fileName
-	//! The filename we are writing to.
-	//!
-	//! @return bool
-	//! true if success, false otherwise.
-	//!
-	bool WriteToDocBookFile(
-		std::ostringstream &os, 
-		GeneratorContext *context, 
-		string *error, 
-		string const &fileName)
-	{
-		if(s_customTemplateFileName.empty())
-		{
-			// Everything should be appended below the "insertion point" so that 
-			// all information is written to a single docbook file.
-			scoped_ptr<io::ZeroCopyOutputStream> output(
-				context->OpenForInsert(
-				s_docbookOuputFileName, 
-				DEFAULT_INSERTION_POINT));
-
-			io::Printer printer(output.get(), '$');
-			printer.PrintRaw(os.str().c_str());
-
-			if (printer.failed()) 
-			{
-				*error = "CodeGenerator detected write error.";
-				return false;
-			}
-		}
-		else
-		{
-			scoped_ptr<io::ZeroCopyOutputStream> output(
-				context->OpenForInsert(
-					s_docbookOuputFileName, 
-					fileName));
-
-			io::Printer printer(output.get(), '$');
-			printer.PrintRaw(os.str().c_str());
-
-			if (printer.failed()) 
-			{
-				*error = "CodeGenerator detected write error.";
-				return false;
-			}
-		}
-		return true;
-	}
-} // end anonymous namespace
-
-//! @details
-//! Constructor
-//! Upon construction, options from docbook.properties (if available) will 
-//! be loaded. Under the protoc plugin framework, only one instance of
-//! DocbookGenerator is ever created, so options will only be loaded once.
-//!
-DocbookGenerator::DocbookGenerator()
-{
-	//! @remark
-	//! Wait a bit to allow human being to attach the debugger to this process.
-	//! Not sure if this is the best way to debug this type of interprocess
-	//! program, but it works well enough for me. (askldjd)
-	//Sleep(10000);
-
-	// Upon construction, read the docbook.properties file once to load up
-	// all the user options.
-	s_docbookOptions = utils::ParseProperty("docbook.properties");
-
-	std::map<string, string>::const_iterator itr;
-	itr = s_docbookOptions.find(OPTION_NAME_ROW_COLOR);
-	if(itr != s_docbookOptions.end())
-	{
-		s_rowColor = itr->second;
-	}
-
-	itr = s_docbookOptions.find(OPTION_NAME_ROW_COLOR_ALT);
-	if(itr != s_docbookOptions.end())
-	{
-		s_rowColorAlt = itr->second;
-	}
-
-	itr = s_docbookOptions.find(OPTION_NAME_COLUMN_HEADER_COLOR);
-	if(itr != s_docbookOptions.end())
-	{
-		s_columnHeaderColor = itr->second;
-	}
-
-	itr = s_docbookOptions.find(OPTION_NAME_INCLUDE_SCALAR_VALUE_TABLE);
-	if(itr != s_docbookOptions.end())
-	{
-		if(itr->second == "0")
-		{
-			s_includeScalarValueTable = false;
-		}
-		else
-		{
-			s_includeScalarValueTable = true;
-		}
-	}
-
-	// User provides a custom template file.
-	itr = s_docbookOptions.find(OPTION_NAME_CUSTOM_TEMPLATE_FILE);
-	if(itr != s_docbookOptions.end())
-	{
-		// Copy the content in memory, and if successful, consider this
-		// file valid by saving its name.
-		s_customTemplateFile = GetFileContent(itr->second.c_str());
-
-		if(s_customTemplateFile.empty() == false)
-		{
-			s_customTemplateFileName = itr->second;
-			s_docbookOuputFileName = s_customTemplateFileName;
-			int lastindex = s_docbookOuputFileName.find_last_of("."); 
-			s_docbookOuputFileName.insert(lastindex, "-out");
-		}
-	}
-
-	itr = s_docbookOptions.find(OPTION_NAME_STARTING_SECTION_LEVEL);
-	if(itr != s_docbookOptions.end())
-	{
-		std::istringstream buffer(itr->second);
-		buffer >> s_startingSectionLevel;
-
-		if(s_startingSectionLevel <= 0 || 
-			s_startingSectionLevel > MAX_ALLOWED_SECTION_LEVEL_OPTION)
-		{
-			s_startingSectionLevel = 1;
-		}
-	}
-
-	itr = s_docbookOptions.find(OPTION_NAME_INCLUDE_TIMESTAMP);
-	if(itr != s_docbookOptions.end())
-	{
-		if(itr->second == "0")
-		{
-			s_includeTimestamp = false;
-		}
-		else
-		{
-			s_includeTimestamp = true;
-		}
-	}
-
-	itr = s_docbookOptions.find(OPTION_NAME_PRESERVE_COMMENT_LINE_BREAKS);
-	if(itr != s_docbookOptions.end())
-	{
-		if(itr->second == "0")
-		{
-			s_preserve_comment_line_breaks = false;
-		}
-		else
-		{
-			s_preserve_comment_line_breaks = true;
-		}
-	}
-}
-
-DocbookGenerator::~DocbookGenerator() 
-{
-}
-
-//! @details
-//! This is the main entry point for this plugin. For each file parsed by 
-//! protoc, it will forward the .proto parsed tree into FileDescriptor
-//! format. DocbookGenerator will then traverse the information and generate
-//! the equivalent DocBook output.
-//!
-//! @param [in] file
-//! The parsed information in FileDescriptor form.
-//!
-//! @param [in] context
-//! The context object is used to concat DocBook stream into the target file.
-//! This is part of the protoc framework.
-//!
-//! @param [in] error
-//! String for any error that has occurred.
-//!
-bool DocbookGenerator::Generate(
-	FileDescriptor const *file,
-	string const &/*parameter*/,
-	GeneratorContext *context,
-	string *error) const 
-{
-	std::ostringstream os;
-
-	WriteProtoFileHeader(os, file, s_startingSectionLevel);
-
-	// Go through each message defined within the file and write their
-	// information out recursively.
-	for (int i = 0; i < file->message_type_count(); i++) 
-	{
-		WriteMessage(os, file->message_type(i), "", s_startingSectionLevel+1);
-	}
-
-	// Write out the Enums defined within the scope of the file. These
-	// enums are not nested within Messages.
-	WriteEnumTable(file, os, "", s_startingSectionLevel+1);
-
-	// Close out the Proto and get ready for the next file.
-	WriteProtoFileFooter(os, s_startingSectionLevel);
-
-	if(s_templateFileMade == false) 
-	{
-		s_templateFileMade = true;
-		MakeTemplateFile(*context);
-	}
-
-	return WriteToDocBookFile(os, context, error, file->name());
-}
-
-}}}}  // end namespace
+// protoc-gen-docbook
+// http://code.google.com/p/protoc-gen-docbook/
+//
+// Redistribution and use in source and binary forms, with or without
+//// modification, are permitted provided that the following conditions are
+// met:
+//
+//     * Redistributions of source code must retain the above copyright
+// notice, this list of conditions and the following disclaimer.
+//     * Redistributions in binary form must reproduce the above
+// copyright notice, this list of conditions and the following disclaimer
+// in the documentation and/or other materials provided with the
+// distribution.
+//     * Neither the name of Google Inc. nor the names of its
+// contributors may be used to endorse or promote products derived from
+// this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+// "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+// LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+// A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+// OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+// SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+// LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+// DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+// THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//
+// Author: askldjd@gmail.com
+//
+// This file holds the generator that walks through the proto descriptor
+// structures and convert them to DocBook tables.
+// See http://code.google.com/p/protoc-gen-docbook/ for more information.
+//
+
+#include "docbook_generator.h"
+#include "docbook_generator_internal.h"
+#include "docbook_hash.h"
+#include "docbook_heap_profile.h"
+#include "docbook_number_format.h"
+#include "docbook_ordered_queue.h"
+#include "docbook_parsed_sources.h"
+#include "docbook_sized_stream.h"
+#include "docbook_thread.h"
+#include <google/protobuf/io/coded_stream.h>
+#include <google/protobuf/io/printer.h>
+#include <google/protobuf/io/zero_copy_stream.h>
+#include <google/protobuf/io/zero_copy_stream_impl_lite.h>
+#include <google/protobuf/descriptor.pb.h>
+#include <google/protobuf/dynamic_message.h>
+#include <google/protobuf/unknown_field_set.h>
+#include <google/protobuf/wire_format.h>
+#include <google/protobuf/wire_format_lite.h>
+#include <google/protobuf/stubs/strutil.h>
+#include <iostream>
+#include <fstream>
+#include <string>
+#include <sstream>
+#include <map>
+#include <vector>
+#include <iomanip>
+#include <algorithm>
+// For debugging only
+//#include <Windows.h>
+
+namespace google { namespace protobuf { namespace compiler { namespace docbook {
+
+namespace utils {
+
+	//! @details
+	//! Helper method to trim the beginning and ending white spaces within 
+	//! a string.
+	string Trim(const string& str)
+	{
+		string s = str;
+		unsigned int p;
+		while ((p = s.length()) > 0 && (unsigned char)s[p-1] <= ' ')
+			s.resize(p-1);
+		while ((p = s.length()) > 0 && (unsigned char)s[0] <= ' ')
+			s.erase(0, 1);
+		return s;
+	}
+
+	//! @details
+	//! This method parses a Java like .properties file that is k=v pairs.
+	//!
+	//! @param[in] filePath
+	//! File path to the property file.
+	//!
+	//! @return
+	//! k/v pairs that represents the property file.
+	//!
+	//! @remark
+	//! Hate to reinvent the wheel here since there are about a million 
+	//! parser implementations out there. However, I hate to bring in Boost 
+	//! library just for something this trivial.
+	//!
+	//! This parser isn't smart enough to strip out comments on the
+	//! same line as the k/v pair.
+	std::map <string, string> ParseProperty(string const &filePath)
+	{
+		std::map <string, string> options;
+		std::ifstream ifs(filePath.c_str(), std::ifstream::in);
+		if(ifs.is_open())
+		{
+			string line;
+			while(std::getline(ifs, line))
+			{
+				line = Trim(line);
+
+				// First non-space char that is '#' is a comment line.
+				if(line.empty() == false && line[0]=='#') 
+					continue;
+
+				int p = 0;
+				if ((p = (int)line.find('=')) > 0)
+				{
+					string k = Trim(line.substr(0, p));
+					string v = Trim(line.substr(p+1));
+					if (!k.empty() && !v.empty())
+						options[k] = v;
+				}
+			}
+		}
+
+		ifs.close();
+		return options;
+	}
+
+	//! @details
+	//! Override the options with the comma separated k=v pairs of a 
+	//! generator parameter (e.g. --docbook_out=row_color=ffffff:.).
+	void ApplyParameter(string const &parameter, std::map<string, string> *options)
+	{
+		vector<pair<string, string> > parameters;
+		ParseGeneratorParameter(parameter, &parameters);
+		for(size_t i = 0; i < parameters.size(); ++i)
+		{
+			(*options)[parameters[i].first] = parameters[i].second;
+		}
+	}
+}
+
+namespace {
+
+	//! These options are part of the layout look-and-feel parameters that
+	//! adjusts the informaltable column widths.
+	char const* OPTION_NAME_FIELD_NAME_COLUMN_WIDTH = "field_name_column_width";
+	char const *OPTION_NAME_FIELD_TYPE_COLUMN_WIDTH = "field_type_column_width";
+	char const *OPTION_NAME_FIELD_RULE_COLUMN_WIDTH = "field_rules_column_width";
+	char const *OPTION_NAME_FIELD_DESC_COLUMN_WIDTH = "field_desc_column_width";
+	char const *OPTION_NAME_FIELD_WIRE_COLUMN_WIDTH = "field_wire_column_width";
+	char const *OPTION_NAME_FIELD_CPP_COLUMN_WIDTH = "field_cpp_column_width";
+
+	//! These options are part of the layout look-and-feel parameters that
+	//! adjusts the informaltable color scheme
+	char const *OPTION_NAME_COLUMN_HEADER_COLOR = "column_header_color";
+	char const *OPTION_NAME_ROW_COLOR = "row_color"; // odd rows color
+	char const *OPTION_NAME_ROW_COLOR_ALT = "row_color_alt"; // even rows color
+
+	//! @details
+	//! Scalar Value Table is a table that holds descriptions for primitive 
+	//! types in protobuf (e.g. int32, fixed32, etc). It is a convenient reminder
+	//! on what those type means.
+	//!
+	//! 1 to include 
+	//! 0 to exclude
+	//!
+	char const *OPTION_NAME_INCLUDE_SCALAR_VALUE_TABLE = "include_scalar_value_table";
+
+	//! @details
+	//! Write the custom options (extensions of FieldOptions, MessageOptions,
+	//! EnumOptions and EnumValueOptions) set on fields, messages, enums 
+	//! and enum values, next to their description.
+	//!
+	//! 1 to include 
+	//! 0 to exclude
+	//!
+	//! [default = 0]
+	char const *OPTION_NAME_INCLUDE_CUSTOM_OPTIONS = "include_custom_options";
+
+	//! @details
+	//! List under each message and enum table the messages of the run 
+	//! that have a field of that type, as links to their tables.
+	//!
+	//! 1 to include 
+	//! 0 to exclude
+	//!
+	//! [default = 0]
+	char const *OPTION_NAME_INCLUDE_REFERENCED_BY = "include_referenced_by";
+
+	//! @details
+	//! Add a column with the encoded size of each field: its tag, and the
+	//! fixed size or varint range of its value, packed or not. Under each
+	//! message, its smallest encoded size (only the required fields, with
+	//! the smallest values) and its typical one (every field set once, 
+	//! repeated fields with one element, varints of one byte, enums at 
+	//! their default value, strings and bytes of TYPICAL_LENGTH_DELIMITED_SIZE
+	//! bytes). Fields that nest the message within itself, directly or 
+	//! through other messages, are left out of the typical size and count
+	//! as an empty message in the smallest one. See WireSizeIndex.
+	//!
+	//! 1 to include 
+	//! 0 to exclude
+	//!
+	//! [default = 0]
+	char const *OPTION_NAME_INCLUDE_WIRE_SIZE = "include_wire_size";
+
+	//! @details
+	//! Estimate the size of the objects of the C++ classes protoc 2.5 
+	//! generates for the messages, on a 64-bit target: a column with the
+	//! size of the member of each field, the object size under each 
+	//! message, and a section at the end of the document listing the 
+	//! messages from the heaviest object down. With a custom template, the
+	//! section goes to the "cpp_size" insertion point. See CppSizeIndex.
+	//!
+	//! 1 to include 
+	//! 0 to exclude
+	//!
+	//! [default = 0]
+	char const *OPTION_NAME_INCLUDE_CPP_SIZE = "include_cpp_size";
+
+	//! @details
+	//! Each table generated by protoc-gen-docbook is under a <section> tag with
+	//! a specific level. (e.g. sec1, sect2 ... sect5)
+	//! By adjusting this field, you may increase the first section level used.
+	//! [default = 1, must be <= 5]
+	char const *OPTION_NAME_STARTING_SECTION_LEVEL = "starting_section_level";
+
+	//! @details
+	//! Add a timestamp at the bottom of the document to indicate when it was
+	//! generated.
+	//!
+	//! This option is only available if custom template is NOT used.
+	//!
+	//! 1 to include
+	//! 0 to exclude
+	//!
+	//! [default = 0]
+	char const *OPTION_NAME_INCLUDE_TIMESTAMP = "include_timestamp";
+
+	//! @details
+	//! Preserve line breaks within the comment in .proto into the generated DocBook.
+	//! This implies all \r\n or \n will be converted into <sbr/>
+	//!
+	//! 1 to preserve
+	//! 0 to ignore (All line breaks in comment converts into space.)
+	//!
+	//! [default = 0]
+	//! See Issue #3
+	char const *OPTION_NAME_PRESERVE_COMMENT_LINE_BREAKS = "preserve_comment_line_breaks";
+
+	//! @details
+	//! Custom template file allows user to provide their own template file
+	//! and use "insertion point" to pinpoint where the tables should be
+	//! located. If not provided, a default template is provided.
+	char const *OPTION_NAME_CUSTOM_TEMPLATE_FILE = "custom_template_file";
+
+	//! @details
+	//! Number of threads used to render the messages of a file. Top level 
+	//! messages and their nested messages are rendered as separate pieces,
+	//! so a single large .proto file is spread across cores. The document
+	//! is the same for any number of threads.
+	//!
+	//! 0 to use one thread per processor
+	//!
+	//! [default = 1]
+	char const *OPTION_NAME_THREADS = "threads";
+
+	//! @details
+	//! Most body rows in one message or enum table. Longer tables are 
+	//! split into continuation tables that repeat the column headers, so
+	//! that FOP lays out a few smaller tables instead of a huge one. Only
+	//! the first part carries the xml:id of the type, and the row colors
+	//! alternate across the parts as if they were one table.
+	//!
+	//! 0 for no limit
+	//!
+	//! [default = 0]
+	char const *OPTION_NAME_MAX_ROWS_PER_TABLE = "max_rows_per_table";
+
+	//! @details
+	//! What to do with links that would not resolve in the document: links
+	//! to a type that is not documented in the run (e.g. it lives in an 
+	//! imported file that is not generated, or it is a message without 
+	//! fields), and links to an id shared by several types (e.g. a.b_c and
+	//! a_b.c both become a_b_c). Every such link is reported on stderr at 
+	//! the end of the run.
+	//!
+	//! keep  to write the link anyway
+	//! plain to write the type name without a link
+	//! error to fail the run
+	//!
+	//! [default = keep]
+	char const *OPTION_NAME_BROKEN_LINKS = "broken_links";
+
+	//! @details
+	//! Write the tables without the whitespace between elements, and 
+	//! without the color processing instructions on every body row. The
+	//! tables get a tabstyle and the alternate rows a role instead, so the
+	//! stylesheet can color them (see COMPACT_TABLE_STYLE). The header row
+	//! keeps its color, since it is only written once per table.
+	//!
+	//! [default = 0]
+	char const *OPTION_NAME_COMPACT = "compact";
+
+	//! @details
+	//! Collapse the runs of at least ENUM_RANGE_MIN_VALUES enum values with
+	//! consecutive numbers into a single row, as long as none of them has
+	//! a comment, custom options or an alias. Large generated enums (error
+	//! codes, message ids) then take a few rows instead of pages.
+	//!
+	//! [default = 0]
+	char const *OPTION_NAME_COMPACT_ENUM_RANGES = "compact_enum_ranges";
+
+	//! @details
+	//! Use short ids made of a hash of the full name, instead of the full
+	//! name itself, for the tables and the links to them. The ids do not
+	//! change from run to run, but links written by hand into a custom 
+	//! template must use the hashed form.
+	//!
+	//! [default = 0]
+	char const *OPTION_NAME_SHORT_IDS = "short_ids";
+
+	//! @details
+	//! Render only a share of the files, as i/n with 0 <= i < n, so that
+	//! n processes or build workers can generate a large run together. 
+	//! The files are balanced by their estimated cost, the same way on 
+	//! every shard. Instead of the document, each shard writes a fragment
+	//! file, and --merge combines the fragments of all shards into the 
+	//! document a single run would have written. 
+	//!
+	//! [default = 0/1]
+	char const *OPTION_NAME_SHARD = "shard";
+
+	//! @details
+	//! Name of a DocBook olink target database to write next to the 
+	//! document, listing the id of every table. Other runs read it with
+	//! OPTION_NAME_OLINK_DATABASE, so that documents built separately can
+	//! link to each other's types. Both runs must agree on 
+	//! OPTION_NAME_SHORT_IDS.
+	//!
+	//! [default = none]
+	char const *OPTION_NAME_OLINK_TARGETS = "olink_targets";
+
+	//! @details
+	//! Prefix of the options naming the target databases of other 
+	//! documents, as olink_database.<targetdoc> = <path to targets.db>. A 
+	//! link to a type that has no table in the run but is found in one of
+	//! them is written as an olink to that document, instead of being a 
+	//! broken link.
+	char const *OPTION_NAME_OLINK_DATABASE = "olink_database.";
+
+	//! @details
+	//! Look for encoding pitfalls in the fields of the run, and list them 
+	//! in a section at the end of the document, with a link to the table of
+	//! each field. They are also written to <output>.lint, one tab 
+	//! separated "rule file field message" line each, for scripts. With a 
+	//! custom template, the section goes to the "lint" insertion point.
+	//!
+	//!	unpacked_repeated   repeated scalars without [packed = true]
+	//!	negative_default    int32/int64 with a negative default, shorter as sint
+	//!	high_field_number   required or repeated fields with a tag of two bytes 
+	//!	                    or more, while numbers 1..15 are free
+	//!	fixed_small_value   fixed fields whose default is shorter as a varint
+	//!	deep_required_chain chains of more than LINT_MAX_REQUIRED_DEPTH 
+	//!	                    nested required messages, reported at their head
+	//!
+	//! 1 to lint
+	//! 0 not to
+	//!
+	//! [default = 0]
+	char const *OPTION_NAME_LINT = "lint";
+
+	//! @details
+	//! Default output file name, not adjustable at the moment.
+	char const *DEFAULT_OUTPUT_NAME = "docbook_out.xml";
+
+	char const *DEFAULT_INSERTION_POINT= "insertion_point";
+
+	char const *SCALAR_TABLE_INSERTION_POINT = "scalar_table";
+
+	char const *SCALAR_VALUE_TYPES_TABLE_XML_ID = "protobuf_scalar_value_types";
+
+	//! @details
+	//! Insertion point of the schema change report in a custom template.
+	//! See GenerateDocbookDiff.
+	char const *SCHEMA_CHANGES_INSERTION_POINT = "schema_changes";
+
+	//! @details
+	//! Insertion point of the lint section in a custom template. See 
+	//! OPTION_NAME_LINT.
+	char const *LINT_INSERTION_POINT = "lint";
+
+	//! @details
+	//! Suffix of the lint report written next to the document.
+	char const *LINT_REPORT_SUFFIX = ".lint";
+
+	//! @details
+	//! Longest chain of nested required messages not reported by the lint.
+	int const LINT_MAX_REQUIRED_DEPTH = 3;
+
+	//! @details
+	//! Shortest run of values collapsed into a single row. Two values take
+	//! no more room as rows of their own. See OPTION_NAME_COMPACT_ENUM_RANGES.
+	size_t const ENUM_RANGE_MIN_VALUES = 3;
+
+	//! @details
+	//! Insertion point of the C++ footprint section in a custom template.
+	//! See OPTION_NAME_INCLUDE_CPP_SIZE.
+	char const *CPP_SIZE_INSERTION_POINT = "cpp_size";
+
+	//! @details
+	//! Prefix of the ids of the tables in the schema change report, so 
+	//! that they never clash with the ones of the regular output.
+	char const *SCHEMA_CHANGES_ID_PREFIX = "schema_changes.";
+
+	//! @details
+	//! First line of a shard fragment. See OPTION_NAME_SHARD.
+	//! <?protoc-gen-docbook-shard shard="i/n" files="total number of files"?>
+	char const *SHARD_FRAGMENT_TAG = "<?protoc-gen-docbook-shard";
+
+	//! @details
+	//! Line before each section of a shard fragment, followed by the bytes
+	//! of the section and a line break.
+	//! <?protoc-gen-docbook-section index="i" file="name" bytes="size"?>
+	char const *SHARD_SECTION_TAG = "<?protoc-gen-docbook-section";
+
+	//! @details
+	//! Pieces of the document each rendering thread may be ahead of the 
+	//! writer. See WriteFilesPipelined.
+	int const PIPELINE_PIECES_PER_THREAD = 2;
+
+	//! @details
+	//! tabstyle of the tables in compact mode. A customization layer can 
+	//! match it to style the tables, e.g. the header and the rows with 
+	//! role COMPACT_ROW_ROLE_ALT.
+	char const *COMPACT_TABLE_STYLE = "protoc-gen-docbook";
+
+	//! @details
+	//! role of every other body row in compact mode. These are the rows
+	//! written with OPTION_NAME_ROW_COLOR_ALT otherwise.
+	char const *COMPACT_ROW_ROLE_ALT = "alt";
+
+	//! @details
+	//! Prefix of the ids made by OPTION_NAME_SHORT_IDS. An id must not 
+	//! start with a digit.
+	char const SHORT_ID_PREFIX = 't';
+
+	//! @details
+	//! Number of hex digits of a short id. 48 bits keep collisions 
+	//! unlikely for any schema, and IdRegistry reports the ones that
+	//! happen anyway.
+	int const SHORT_ID_DIGITS = 12;
+
+	//! @details
+	//! Column width measurement
+	//!
+	//! From DocBook official documentation:
+	//! ColWidth specifies the desired width of the relevant column. 
+	//! It can be either a fixed measure using one of the CALS units 
+	//! (36pt, 10pc, etc.) or a proportional measure. Proportional measures 
+	//! have the form number*, meaning this column should be number times 
+	//! wider than a column with the measure 1* (or just *). These two forms 
+	//! can be mixed, as in 3*+1pc. 
+	//! See http://www.docbook.org/tdg/en/html/colspec.html
+	char const *DEFAULT_FIELD_NAME_COLUMN_WIDTH = "3";
+	char const *DEFAULT_FIELD_TYPE_COLUMN_WIDTH = "2";
+	char const *DEFAULT_FIELD_RULES_COLUMN_WIDTH = "2";
+	char const *DEFAULT_FIELD_DESC_COLUMN_WIDTH = "6";
+	char const *DEFAULT_FIELD_WIRE_COLUMN_WIDTH = "2";
+	char const *DEFAULT_FIELD_CPP_COLUMN_WIDTH = "2";
+
+	//! @details
+	//! Size of a string or bytes value in the typical size of a message.
+	//! See OPTION_NAME_INCLUDE_WIRE_SIZE.
+	int const TYPICAL_LENGTH_DELIMITED_SIZE = 16;
+
+	//! @details
+	//! The insertion points syntax is defined by protobuf library.
+	//! See https://developers.google.com/protocol-buffers/docs/reference/cpp/google.protobuf.compiler.plugin.pb
+	char const *INSERTION_POINT_START_TAG = "<!-- @@protoc_insertion_point(";
+	char const *INSERTION_POINT_END_TAG = ") -->";
+	
+	//! @details
+	//! Highest <section> level, defined by DocBook
+	//! see http://oreilly.com/openbook/docbook/book/sect1.html
+	int const MAX_SECTION_LEVEL = 5;
+
+	//! @details
+	//! Highest <section> level allowed by the user.
+	//! protoc-gen-doc needs at least 2 levels to operate correctly
+	//! Worst case, we may use sect4 and sect5.
+	int const MAX_ALLOWED_SECTION_LEVEL_OPTION = 4;
+
+	//! @details
+	//! Index from a descriptor to its location within the SourceCodeInfo of
+	//! its file. The SourceCodeInfo of each file is copied once when the 
+	//! file is added, and the comments are then handed out as borrowed 
+	//! pointers into it. 
+	//!
+	//! FileDescriptor::GetSourceLocation does a linear scan over every 
+	//! location of the file and copies the comments out on each call, which 
+	//! makes documenting a large file quadratic.
+	class CommentIndex
+	{
+	public:
+		CommentIndex()
+		{
+		}
+
+		~CommentIndex()
+		{
+			Clear();
+		}
+
+		//! @details
+		//! Forget every file added so far.
+		void Clear()
+		{
+			for(size_t i = 0; i < m_sourceInfos.size(); ++i)
+			{
+				delete m_sourceInfos[i];
+			}
+			m_sourceInfos.clear();
+			m_locations.clear();
+		}
+
+		//! @details
+		//! Index every message, field, enum and enum value location of the
+		//! file. The first location of a path wins, the same way 
+		//! FileDescriptor::GetSourceLocation resolves it.
+		void AddFile(FileDescriptor const *file)
+		{
+			FileDescriptorProto *sourceInfo = new FileDescriptorProto;
+			m_sourceInfos.push_back(sourceInfo);
+			file->CopySourceCodeInfoTo(sourceInfo);
+
+			SourceCodeInfo const &info = sourceInfo->source_code_info();
+			for(int i = 0; i < info.location_size(); ++i)
+			{
+				SourceCodeInfo_Location const &location = info.location(i);
+				if(location.span_size() != 3 && location.span_size() != 4)
+					continue;
+
+				void const *descriptor = ResolvePath(file, location.path());
+				if(descriptor != NULL)
+				{
+					m_locations.insert(std::make_pair(descriptor, &location));
+				}
+			}
+		}
+
+		//! @details
+		//! @return
+		//! The location of the descriptor, NULL if it has no source info.
+		SourceCodeInfo_Location const *Find(void const *descriptor) const
+		{
+			LocationMap::const_iterator itr = m_locations.find(descriptor);
+			if(itr == m_locations.end())
+				return NULL;
+			return itr->second;
+		}
+
+	private:
+		typedef hash_map<void const *, SourceCodeInfo_Location const *> LocationMap;
+
+		//! @details
+		//! Walk a SourceCodeInfo path (e.g. [4, 0, 2, 1] is the second field
+		//! of the first message) down to the descriptor it describes.
+		//!
+		//! @return
+		//! The descriptor, NULL if the path does not point to a message, 
+		//! field, enum or enum value.
+		static void const *ResolvePath(
+			FileDescriptor const *file, 
+			RepeatedField<int32> const &path)
+		{
+			if(path.size() < 2 || path.size() % 2 != 0)
+				return NULL;
+
+			Descriptor const *message = NULL;
+			EnumDescriptor const *enumType = NULL;
+
+			int index = path.Get(1);
+			switch(path.Get(0))
+			{
+			case FileDescriptorProto::kMessageTypeFieldNumber:
+				if(index < 0 || index >= file->message_type_count())
+					return NULL;
+				message = file->message_type(index);
+				break;
+			case FileDescriptorProto::kEnumTypeFieldNumber:
+				if(index < 0 || index >= file->enum_type_count())
+					return NULL;
+				enumType = file->enum_type(index);
+				break;
+			default:
+				return NULL;
+			}
+
+			for(int i = 2; i < path.size(); i += 2)
+			{
+				int tag = path.Get(i);
+				index = path.Get(i+1);
+				bool last = (i + 2 == path.size());
+
+				if(message != NULL)
+				{
+					switch(tag)
+					{
+					case DescriptorProto::kFieldFieldNumber:
+						if(!last || index < 0 || index >= message->field_count())
+							return NULL;
+						return message->field(index);
+					case DescriptorProto::kNestedTypeFieldNumber:
+						if(index < 0 || index >= message->nested_type_count())
+							return NULL;
+						message = message->nested_type(index);
+						break;
+					case DescriptorProto::kEnumTypeFieldNumber:
+						if(index < 0 || index >= message->enum_type_count())
+							return NULL;
+						enumType = message->enum_type(index);
+						message = NULL;
+						break;
+					default:
+						return NULL;
+					}
+				}
+				else
+				{
+					if(tag != EnumDescriptorProto::kValueFieldNumber || !last ||
+						index < 0 || index >= enumType->value_count())
+						return NULL;
+					return enumType->value(index);
+				}
+			}
+
+			if(message != NULL)
+				return message;
+			return enumType;
+		}
+
+		std::vector<FileDescriptorProto *> m_sourceInfos;
+		LocationMap m_locations;
+
+		GOOGLE_DISALLOW_EVIL_CONSTRUCTORS(CommentIndex);
+	};
+
+	//! @details
+	//! XML ID is an unique ID that is used in XLink. Since "." is not 
+	//! allowed, some sanitization is needed by replacing "." with "_".
+	//!
+	//! With short ids, the id is the 64-bit FNV-1a hash of the full name
+	//! folded down to SHORT_ID_DIGITS hex digits instead.
+	string MakeXmlId(string const &fullName, bool shortIds)
+	{
+		if(shortIds == false)
+		{
+			string xmlID = fullName;
+			std::replace(xmlID.begin(), xmlID.end(), '.', '_');
+			return xmlID;
+		}
+
+		uint64 hash = GOOGLE_ULONGLONG(14695981039346656037);
+		for(size_t i = 0; i < fullName.size(); ++i)
+		{
+			hash ^= static_cast<unsigned char>(fullName[i]);
+			hash *= GOOGLE_ULONGLONG(1099511628211);
+		}
+		hash = (hash >> (SHORT_ID_DIGITS * 4)) ^ hash;
+
+		static char const HEX_DIGITS[] = "0123456789abcdef";
+		string xmlID(SHORT_ID_DIGITS + 1, SHORT_ID_PREFIX);
+		for(int i = SHORT_ID_DIGITS; i > 0; --i)
+		{
+			xmlID[i] = HEX_DIGITS[hash & 0xf];
+			hash >>= 4;
+		}
+		return xmlID;
+	}
+
+	//! @details
+	//! Every id the run writes, and the types that links point to. Built 
+	//! before rendering starts, so that checking a link while rendering is
+	//! a single hash lookup and the registry is read-only for the writers.
+	class IdRegistry
+	{
+	public:
+		IdRegistry()
+			: m_shortIds(false)
+		{
+		}
+
+		//! @details
+		//! See OPTION_NAME_SHORT_IDS.
+		void UseShortIds(bool shortIds)
+		{
+			m_shortIds = shortIds;
+		}
+
+		//! @details
+		//! @return
+		//! The id of the table of a message or enum.
+		string MakeId(string const &fullName) const
+		{
+			return MakeXmlId(fullName, m_shortIds);
+		}
+
+		//! @details
+		//! Register the id of every table the file will have: the messages
+		//! with fields and all enums, nested or not.
+		void AddFile(FileDescriptor const *file)
+		{
+			for(int i = 0; i < file->message_type_count(); ++i)
+			{
+				AddMessage(file->message_type(i));
+			}
+			for(int i = 0; i < file->enum_type_count(); ++i)
+			{
+				AddEnum(file->enum_type(i));
+			}
+		}
+
+		//! @details
+		//! Check the target of every link the files will have. Must be 
+		//! called once every file of the run has been added.
+		//!
+		//! @param[out] problems
+		//! One line per broken link or id collision.
+		void Verify(
+			vector<FileDescriptor const *> const &files, 
+			vector<string> *problems)
+		{
+			problems->insert(problems->end(), m_collisions.begin(), m_collisions.end());
+			for(size_t i = 0; i < files.size(); ++i)
+			{
+				for(int j = 0; j < files[i]->message_type_count(); ++j)
+				{
+					VerifyMessage(files[i]->message_type(j), problems);
+				}
+			}
+		}
+
+		//! @details
+		//! @return
+		//! true if a link to the descriptor would not resolve to its table.
+		bool IsBroken(void const *descriptor) const
+		{
+			return m_broken.count(descriptor) != 0;
+		}
+
+		//! @details
+		//! Register the ids of the olink target database of another 
+		//! document. Kept across runs, unlike the ids of the run.
+		//!
+		//! @return
+		//! The number of ids read from the database.
+		int AddOlinkDatabase(string const &targetdoc, string const &database)
+		{
+			static char const ATTRIBUTE[] = "targetptr=\"";
+			int const attributeLength = sizeof(ATTRIBUTE) - 1;
+
+			int count = 0;
+			string::size_type start = database.find(ATTRIBUTE);
+			while(start != string::npos)
+			{
+				start += attributeLength;
+				string::size_type end = database.find('"', start);
+				if(end == string::npos)
+				{
+					break;
+				}
+
+				if(end > start)
+				{
+					// The first database listing an id wins.
+					m_external.insert(
+						std::make_pair(database.substr(start, end - start), targetdoc));
+					++count;
+				}
+				start = database.find(ATTRIBUTE, end);
+			}
+			return count;
+		}
+
+		//! @details
+		//! @return
+		//! The document to olink to for a type that has no table in the 
+		//! run, or NULL if the link is local (or broken).
+		string const *FindOlink(void const *descriptor) const
+		{
+			OlinkMap::const_iterator itr = m_olinks.find(descriptor);
+			return itr == m_olinks.end() ? NULL : itr->second;
+		}
+
+		//! @details
+		//! @return
+		//! The (id, full name) of every table of the run, in the order they
+		//! were registered.
+		vector<pair<string, string> > const &Tables() const
+		{
+			return m_tables;
+		}
+
+		void Clear()
+		{
+			m_ids.clear();
+			m_tables.clear();
+			m_registered.clear();
+			m_broken.clear();
+			m_olinks.clear();
+			m_collisions.clear();
+		}
+
+	private:
+		struct Target
+		{
+			void const *descriptor;
+			string const *fullName;
+		};
+
+		typedef hash_map<string, Target> IdMap;
+		typedef hash_map<void const *, string const *> OlinkMap;
+
+		void Add(void const *descriptor, string const &fullName)
+		{
+			m_registered.insert(descriptor);
+
+			Target target = { descriptor, &fullName };
+			std::pair<IdMap::iterator, bool> result = 
+				m_ids.insert(std::make_pair(MakeId(fullName), target));
+			if(result.second)
+			{
+				m_tables.push_back(std::make_pair(result.first->first, fullName));
+			}
+			else
+			{
+				Target const &existing = result.first->second;
+				m_broken.insert(existing.descriptor);
+				m_broken.insert(descriptor);
+				m_collisions.push_back(
+					"id \"" + result.first->first + "\" is used by both " + 
+					*existing.fullName + " and " + fullName);
+			}
+		}
+
+		void AddMessage(Descriptor const *descriptor)
+		{
+			// Messages without fields have no table, so nothing to link to.
+			if(descriptor->field_count() > 0)
+			{
+				Add(descriptor, descriptor->full_name());
+			}
+
+			for(int i = 0; i < descriptor->nested_type_count(); ++i)
+			{
+				AddMessage(descriptor->nested_type(i));
+			}
+			for(int i = 0; i < descriptor->enum_type_count(); ++i)
+			{
+				AddEnum(descriptor->enum_type(i));
+			}
+		}
+
+		void AddEnum(EnumDescriptor const *descriptor)
+		{
+			Add(descriptor, descriptor->full_name());
+		}
+
+		void VerifyMessage(Descriptor const *descriptor, vector<string> *problems)
+		{
+			for(int i = 0; i < descriptor->field_count(); ++i)
+			{
+				FieldDescriptor const *fd = descriptor->field(i);
+
+				void const *target = NULL;
+				string const *targetName = NULL;
+				switch(fd->type())
+				{
+				case FieldDescriptor::TYPE_MESSAGE:
+					target = fd->message_type();
+					targetName = &fd->message_type()->full_name();
+					break;
+				case FieldDescriptor::TYPE_ENUM:
+					target = fd->enum_type();
+					targetName = &fd->enum_type()->full_name();
+					break;
+				default:
+					continue;
+				}
+
+				if(m_registered.count(target) == 0)
+				{
+					hash_map<string, string>::const_iterator external = 
+						m_external.find(MakeId(*targetName));
+					if(external != m_external.end())
+					{
+						m_olinks[target] = &external->second;
+						continue;
+					}
+
+					m_broken.insert(target);
+					problems->push_back(
+						fd->file()->name() + ": " + fd->full_name() + 
+						" links to " + *targetName + ", which has no table in this document");
+				}
+				else if(m_broken.count(target) != 0)
+				{
+					problems->push_back(
+						fd->file()->name() + ": " + fd->full_name() + 
+						" links to " + *targetName + ", whose id is not unique");
+				}
+			}
+
+			for(int i = 0; i < descriptor->nested_type_count(); ++i)
+			{
+				VerifyMessage(descriptor->nested_type(i), problems);
+			}
+		}
+
+		bool m_shortIds;
+		IdMap m_ids;
+
+		//! (id, full name) of m_ids, in the order they were added. Copied,
+		//! since the database may be written once the descriptors are gone.
+		vector<pair<string, string> > m_tables;
+
+		hash_set<void const *> m_registered;
+		hash_set<void const *> m_broken;
+		vector<string> m_collisions;
+
+		//! Ids of the other documents, and the targetdoc of each.
+		hash_map<string, string> m_external;
+
+		//! Types of the run linked to with an olink.
+		OlinkMap m_olinks;
+
+		GOOGLE_DISALLOW_EVIL_CONSTRUCTORS(IdRegistry);
+	};
+
+	//! @details
+	//! Descriptor options that custom options are documented for. See
+	//! CustomOptionIndex.
+	enum OptionsKind
+	{
+		FIELD_OPTIONS,
+		MESSAGE_OPTIONS,
+		ENUM_OPTIONS,
+		ENUM_VALUE_OPTIONS,
+		OPTIONS_KIND_COUNT
+	};
+
+	//! @details
+	//! Full name of the options message of each OptionsKind.
+	char const *OPTIONS_MESSAGE_NAMES[OPTIONS_KIND_COUNT] = 
+	{
+		"google.protobuf.FieldOptions",
+		"google.protobuf.MessageOptions",
+		"google.protobuf.EnumOptions",
+		"google.protobuf.EnumValueOptions"
+	};
+
+	//! @details
+	//! Formats the value of one custom option. The generator does not link
+	//! the extensions, so their values are left in the unknown fields of 
+	//! the options. Everything that only depends on the extension (its 
+	//! name, how to decode it, the prototype of a message value) is 
+	//! resolved once, when the formatter is made.
+	class OptionFormatter
+	{
+	public:
+		//! @param[in] prototype
+		//! Prototype of the value of a message or group option, NULL for
+		//! other types.
+		OptionFormatter(FieldDescriptor const *extension, Message const *prototype)
+			: m_extension(extension)
+			, m_prefix("(" + extension->full_name() + ") = ")
+			, m_prototype(prototype)
+		{
+		}
+
+		//! @details
+		//! Append "(name) = value" to out, unescaped. The value is written
+		//! the way it would be in a .proto file.
+		void Format(UnknownField const &field, string *out) const
+		{
+			*out += m_prefix;
+
+			switch(field.type())
+			{
+			case UnknownField::TYPE_VARINT:
+				FormatVarint(field.varint(), out);
+				break;
+			case UnknownField::TYPE_FIXED32:
+				if(m_extension->type() == FieldDescriptor::TYPE_FLOAT)
+					Append(FormattedNumber(internal::WireFormatLite::DecodeFloat(field.fixed32())), out);
+				else if(m_extension->type() == FieldDescriptor::TYPE_SFIXED32)
+					Append(FormattedNumber(static_cast<int32>(field.fixed32())), out);
+				else
+					Append(FormattedNumber(field.fixed32()), out);
+				break;
+			case UnknownField::TYPE_FIXED64:
+				if(m_extension->type() == FieldDescriptor::TYPE_DOUBLE)
+					Append(FormattedNumber(internal::WireFormatLite::DecodeDouble(field.fixed64())), out);
+				else if(m_extension->type() == FieldDescriptor::TYPE_SFIXED64)
+					Append(FormattedNumber(static_cast<int64>(field.fixed64())), out);
+				else
+					Append(FormattedNumber(field.fixed64()), out);
+				break;
+			case UnknownField::TYPE_LENGTH_DELIMITED:
+				if(m_prototype != NULL)
+					FormatMessage(field.length_delimited(), out);
+				else
+					*out += "\"" + CEscape(field.length_delimited()) + "\"";
+				break;
+			case UnknownField::TYPE_GROUP:
+				if(m_prototype != NULL)
+				{
+					string group;
+					io::StringOutputStream stream(&group);
+					{
+						io::CodedOutputStream output(&stream);
+						internal::WireFormat::SerializeUnknownFields(field.group(), &output);
+					}
+					FormatMessage(group, out);
+				}
+				break;
+			}
+		}
+
+	private:
+		static void Append(FormattedNumber const &number, string *out)
+		{
+			out->append(number.data(), number.size());
+		}
+
+		void FormatVarint(uint64 value, string *out) const
+		{
+			switch(m_extension->type())
+			{
+			case FieldDescriptor::TYPE_BOOL:
+				*out += (value != 0) ? "true" : "false";
+				break;
+			case FieldDescriptor::TYPE_ENUM:
+				{
+					EnumValueDescriptor const *enumValue = 
+						m_extension->enum_type()->FindValueByNumber(static_cast<int32>(value));
+					if(enumValue != NULL)
+						*out += enumValue->name();
+					else
+						Append(FormattedNumber(static_cast<int32>(value)), out);
+				}
+				break;
+			case FieldDescriptor::TYPE_INT32:
+				Append(FormattedNumber(static_cast<int32>(value)), out);
+				break;
+			case FieldDescriptor::TYPE_SINT32:
+				Append(FormattedNumber(
+					internal::WireFormatLite::ZigZagDecode32(static_cast<uint32>(value))), out);
+				break;
+			case FieldDescriptor::TYPE_SINT64:
+				Append(FormattedNumber(internal::WireFormatLite::ZigZagDecode64(value)), out);
+				break;
+			case FieldDescriptor::TYPE_INT64:
+				Append(FormattedNumber(static_cast<int64>(value)), out);
+				break;
+			case FieldDescriptor::TYPE_UINT32:
+				Append(FormattedNumber(static_cast<uint32>(value)), out);
+				break;
+			default:
+				Append(FormattedNumber(value), out);
+				break;
+			}
+		}
+
+		void FormatMessage(string const &bytes, string *out) const
+		{
+			scoped_ptr<Message> value(m_prototype->New());
+			if(value->ParseFromString(bytes))
+			{
+				*out += "{ " + value->ShortDebugString() + " }";
+			}
+		}
+
+		FieldDescriptor const *m_extension;
+		string m_prefix;
+		Message const *m_prototype;
+	};
+
+	//! @details
+	//! The custom options declared by the files of a run and the files 
+	//! they import, by the options they extend and their field number. 
+	//! Filled before rendering starts and read-only afterwards, so writing
+	//! the options of a descriptor costs a lookup and a format per option.
+	class CustomOptionIndex
+	{
+	public:
+		CustomOptionIndex()
+			: m_factory(new DynamicMessageFactory())
+		{
+		}
+
+		//! @details
+		//! Forget every file added so far. The prototypes go too, since 
+		//! the factory keys them by descriptor address and the pool of the
+		//! next run (e.g. in --watch) may reuse those addresses.
+		void Clear()
+		{
+			for(int i = 0; i < OPTIONS_KIND_COUNT; ++i)
+			{
+				m_formatters[i].clear();
+			}
+			m_files.clear();
+			m_factory.reset(new DynamicMessageFactory());
+		}
+
+		//! @details
+		//! Make a formatter for every custom option declared by the file or
+		//! one of its imports.
+		void AddFile(FileDescriptor const *file)
+		{
+			if(m_files.insert(file).second == false)
+				return;
+
+			for(int i = 0; i < file->dependency_count(); ++i)
+			{
+				AddFile(file->dependency(i));
+			}
+			for(int i = 0; i < file->extension_count(); ++i)
+			{
+				AddExtension(file->extension(i));
+			}
+			for(int i = 0; i < file->message_type_count(); ++i)
+			{
+				AddMessage(file->message_type(i));
+			}
+		}
+
+		//! @details
+		//! @return
+		//! "(name) = value" for each custom option set in options, 
+		//! separated by commas and unescaped. Empty if there are none.
+		template <typename OptionsType>
+		string Format(OptionsKind kind, OptionsType const &options) const
+		{
+			string text;
+			UnknownFieldSet const &fields = options.unknown_fields();
+			for(int i = 0; i < fields.field_count(); ++i)
+			{
+				FormatterMap::const_iterator itr = 
+					m_formatters[kind].find(fields.field(i).number());
+				if(itr == m_formatters[kind].end())
+					continue;
+
+				if(text.empty() == false)
+				{
+					text += ", ";
+				}
+				itr->second.Format(fields.field(i), &text);
+			}
+			return text;
+		}
+
+	private:
+		typedef hash_map<int, OptionFormatter> FormatterMap;
+
+		void AddMessage(Descriptor const *message)
+		{
+			for(int i = 0; i < message->extension_count(); ++i)
+			{
+				AddExtension(message->extension(i));
+			}
+			for(int i = 0; i < message->nested_type_count(); ++i)
+			{
+				AddMessage(message->nested_type(i));
+			}
+		}
+
+		void AddExtension(FieldDescriptor const *extension)
+		{
+			string const &extendee = extension->containing_type()->full_name();
+			for(int kind = 0; kind < OPTIONS_KIND_COUNT; ++kind)
+			{
+				if(extendee != OPTIONS_MESSAGE_NAMES[kind])
+					continue;
+
+				Message const *prototype = NULL;
+				if(extension->cpp_type() == FieldDescriptor::CPPTYPE_MESSAGE)
+				{
+					prototype = m_factory->GetPrototype(extension->message_type());
+				}
+				m_formatters[kind].insert(std::make_pair(
+					extension->number(), OptionFormatter(extension, prototype)));
+			}
+		}
+
+		FormatterMap m_formatters[OPTIONS_KIND_COUNT];
+		hash_set<void const *> m_files;
+		scoped_ptr<DynamicMessageFactory> m_factory;
+
+		GOOGLE_DISALLOW_EVIL_CONSTRUCTORS(CustomOptionIndex);
+	};
+
+	//! @details
+	//! The messages that refer to each message and enum of the run through
+	//! one of their fields. Built in a single pass over the fields of every
+	//! file, so that the list of a type is a single hash lookup.
+	class ReferenceIndex
+	{
+	public:
+		ReferenceIndex()
+		{
+		}
+
+		void AddFile(FileDescriptor const *file)
+		{
+			for(int i = 0; i < file->message_type_count(); ++i)
+			{
+				AddMessage(file->message_type(i));
+			}
+		}
+
+		//! @details
+		//! @return
+		//! The messages with a field of the type of the descriptor, in 
+		//! document order, or NULL if there are none.
+		vector<Descriptor const *> const *Find(void const *descriptor) const
+		{
+			ReferrerMap::const_iterator itr = m_referrers.find(descriptor);
+			return itr == m_referrers.end() ? NULL : &itr->second;
+		}
+
+		void Clear()
+		{
+			m_referrers.clear();
+		}
+
+	private:
+		typedef hash_map<void const *, vector<Descriptor const *> > ReferrerMap;
+
+		void AddMessage(Descriptor const *descriptor)
+		{
+			for(int i = 0; i < descriptor->field_count(); ++i)
+			{
+				FieldDescriptor const *fd = descriptor->field(i);
+
+				void const *target = NULL;
+				switch(fd->type())
+				{
+				case FieldDescriptor::TYPE_MESSAGE:
+				case FieldDescriptor::TYPE_GROUP:
+					target = fd->message_type();
+					break;
+				case FieldDescriptor::TYPE_ENUM:
+					target = fd->enum_type();
+					break;
+				default:
+					continue;
+				}
+
+				// The fields of a message are added one after the other, so
+				// a message is listed once however many fields it has.
+				vector<Descriptor const *> &referrers = m_referrers[target];
+				if(referrers.empty() || referrers.back() != descriptor)
+				{
+					referrers.push_back(descriptor);
+				}
+			}
+
+			for(int i = 0; i < descriptor->nested_type_count(); ++i)
+			{
+				AddMessage(descriptor->nested_type(i));
+			}
+		}
+
+		ReferrerMap m_referrers;
+
+		GOOGLE_DISALLOW_EVIL_CONSTRUCTORS(ReferenceIndex);
+	};
+
+	//! @details
+	//! @return
+	//! Size of the tag of the field, in bytes.
+	int TagSize(FieldDescriptor const *fd)
+	{
+		return io::CodedOutputStream::VarintSize32(
+			static_cast<uint32>(fd->number()) << 3);
+	}
+
+	//! @details
+	//! Size of a single value of a scalar or enum field, in bytes: the 
+	//! fixed size, or the range of its varint encoding.
+	//!
+	//! @param[out] typical
+	//! Size of the value in the typical size of a message. See 
+	//! OPTION_NAME_INCLUDE_WIRE_SIZE.
+	//!
+	//! @return
+	//! false for strings, bytes, messages and groups, whose size depends
+	//! on the data.
+	bool GetScalarValueSize(FieldDescriptor const *fd, int *min, int *max, int *typical)
+	{
+		switch(fd->type())
+		{
+		case FieldDescriptor::TYPE_DOUBLE:
+		case FieldDescriptor::TYPE_FIXED64:
+		case FieldDescriptor::TYPE_SFIXED64:
+			*min = *max = *typical = 8;
+			return true;
+		case FieldDescriptor::TYPE_FLOAT:
+		case FieldDescriptor::TYPE_FIXED32:
+		case FieldDescriptor::TYPE_SFIXED32:
+			*min = *max = *typical = 4;
+			return true;
+		case FieldDescriptor::TYPE_BOOL:
+			*min = *max = *typical = 1;
+			return true;
+		case FieldDescriptor::TYPE_UINT32:
+		case FieldDescriptor::TYPE_SINT32:
+			*min = *typical = 1;
+			*max = 5;
+			return true;
+		case FieldDescriptor::TYPE_INT32:
+		case FieldDescriptor::TYPE_INT64:
+		case FieldDescriptor::TYPE_UINT64:
+		case FieldDescriptor::TYPE_SINT64:
+			// Negative int32 are sign extended to 64 bits.
+			*min = *typical = 1;
+			*max = 10;
+			return true;
+		case FieldDescriptor::TYPE_ENUM:
+			{
+				EnumDescriptor const *enumDescriptor = fd->enum_type();
+				*min = 10;
+				*max = 1;
+				for(int i = 0; i < enumDescriptor->value_count(); ++i)
+				{
+					int size = io::CodedOutputStream::VarintSize32SignExtended(
+						enumDescriptor->value(i)->number());
+					*min = std::min(*min, size);
+					*max = std::max(*max, size);
+				}
+				*typical = io::CodedOutputStream::VarintSize32SignExtended(
+					fd->default_value_enum()->number());
+			}
+			return true;
+		default:
+			return false;
+		}
+	}
+
+	//! @details
+	//! The smallest and typical encoded size of every message of the run,
+	//! and of the messages they contain. See OPTION_NAME_INCLUDE_WIRE_SIZE.
+	//! Each message is sized once, so that nested messages shared by 
+	//! several others are not walked again.
+	//!
+	//! A field is recursive if its message contains, directly or not, the
+	//! message the field belongs to, i.e. both are in the same strongly 
+	//! connected component of the message graph. Recursive fields are left
+	//! out of the typical size, and count as an empty message in the 
+	//! smallest one, so the size of a message never depends on which 
+	//! message of a cycle happens to be sized first.
+	class WireSizeIndex
+	{
+	public:
+		struct MessageSize
+		{
+			int64 min;
+			int64 typical;
+
+			//! Some fields were left out of typical.
+			bool hasRecursiveFields;
+		};
+
+		WireSizeIndex()
+		{
+		}
+
+		void AddFile(FileDescriptor const *file)
+		{
+			for(int i = 0; i < file->message_type_count(); ++i)
+			{
+				AddMessage(file->message_type(i));
+			}
+		}
+
+		//! @details
+		//! @return
+		//! The size of a message added to the index, NULL otherwise.
+		MessageSize const *Find(Descriptor const *descriptor) const
+		{
+			SizeMap::const_iterator itr = m_sizes.find(descriptor);
+			return itr == m_sizes.end() ? NULL : &itr->second;
+		}
+
+		void Clear()
+		{
+			m_sizes.clear();
+			m_visitOrder.clear();
+			m_lowLinks.clear();
+			m_components.clear();
+			m_stack.clear();
+		}
+
+	private:
+		typedef hash_map<void const *, MessageSize> SizeMap;
+		typedef hash_map<void const *, int> OrderMap;
+
+		//! @details
+		//! Tarjan's algorithm: give every message reachable from the 
+		//! descriptor the id of its strongly connected component.
+		void AddComponents(Descriptor const *descriptor)
+		{
+			int order = static_cast<int>(m_visitOrder.size());
+			m_visitOrder[descriptor] = order;
+			int lowLink = order;
+			m_stack.push_back(descriptor);
+
+			for(int i = 0; i < descriptor->field_count(); ++i)
+			{
+				Descriptor const *target = descriptor->field(i)->message_type();
+				if(target == NULL)
+					continue;
+
+				OrderMap::const_iterator visited = m_visitOrder.find(target);
+				if(visited == m_visitOrder.end())
+				{
+					AddComponents(target);
+					lowLink = std::min(lowLink, m_lowLinks[target]);
+				}
+				else if(m_components.find(target) == m_components.end())
+				{
+					// Still on the stack, so part of the current component.
+					lowLink = std::min(lowLink, visited->second);
+				}
+			}
+			m_lowLinks[descriptor] = lowLink;
+
+			if(lowLink == order)
+			{
+				Descriptor const *member = NULL;
+				do
+				{
+					member = m_stack.back();
+					m_stack.pop_back();
+					m_components[member] = order;
+				}
+				while(member != descriptor);
+			}
+		}
+
+		bool IsRecursive(Descriptor const *descriptor, FieldDescriptor const *fd)
+		{
+			return m_components[fd->message_type()] == m_components[descriptor];
+		}
+
+		void AddMessage(Descriptor const *descriptor)
+		{
+			Compute(descriptor);
+			for(int i = 0; i < descriptor->nested_type_count(); ++i)
+			{
+				AddMessage(descriptor->nested_type(i));
+			}
+		}
+
+		MessageSize Compute(Descriptor const *descriptor)
+		{
+			SizeMap::const_iterator itr = m_sizes.find(descriptor);
+			if(itr != m_sizes.end())
+			{
+				return itr->second;
+			}
+
+			if(m_components.find(descriptor) == m_components.end())
+			{
+				AddComponents(descriptor);
+			}
+
+			MessageSize size = { 0, 0, false };
+			for(int i = 0; i < descriptor->field_count(); ++i)
+			{
+				FieldDescriptor const *fd = descriptor->field(i);
+				int64 tag = TagSize(fd);
+
+				int64 min = 0;
+				int64 typical = 0;
+				int scalarMin = 0;
+				int scalarMax = 0;
+				int scalarTypical = 0;
+				if(GetScalarValueSize(fd, &scalarMin, &scalarMax, &scalarTypical))
+				{
+					min = scalarMin;
+					typical = scalarTypical;
+				}
+				else if(fd->type() == FieldDescriptor::TYPE_STRING || 
+					fd->type() == FieldDescriptor::TYPE_BYTES)
+				{
+					min = 1;
+					typical = 1 + TYPICAL_LENGTH_DELIMITED_SIZE;
+				}
+				else if(IsRecursive(descriptor, fd))
+				{
+					// Only the fields of messages outside the cycle are 
+					// sized, so nothing below can come back here.
+					size.hasRecursiveFields = true;
+					if(fd->is_required())
+					{
+						size.min += tag + (fd->type() == FieldDescriptor::TYPE_GROUP ? tag : 1);
+					}
+					continue;
+				}
+				else
+				{
+					MessageSize nested = Compute(fd->message_type());
+					if(fd->type() == FieldDescriptor::TYPE_GROUP)
+					{
+						// Closed by an end group tag instead of a length.
+						min = nested.min + tag;
+						typical = nested.typical + tag;
+					}
+					else
+					{
+						min = LengthDelimitedSize(nested.min);
+						typical = LengthDelimitedSize(nested.typical);
+					}
+				}
+
+				if(fd->is_packed())
+				{
+					typical = LengthDelimitedSize(typical);
+				}
+
+				if(fd->is_required())
+				{
+					size.min += tag + min;
+				}
+				size.typical += tag + typical;
+			}
+
+			m_sizes[descriptor] = size;
+			return size;
+		}
+
+		static int64 LengthDelimitedSize(int64 size)
+		{
+			return io::CodedOutputStream::VarintSize64(static_cast<uint64>(size)) + size;
+		}
+
+		SizeMap m_sizes;
+
+		//! Order in which AddComponents found each message.
+		OrderMap m_visitOrder;
+
+		//! Smallest visit order reachable from each message.
+		OrderMap m_lowLinks;
+
+		//! Component of each message, by the visit order of its root.
+		OrderMap m_components;
+
+		vector<Descriptor const *> m_stack;
+
+		GOOGLE_DISALLOW_EVIL_CONSTRUCTORS(WireSizeIndex);
+	};
+
+	//! @details
+	//! The encoding pitfalls found in the fields of the run, in document 
+	//! order. See OPTION_NAME_LINT.
+	class LintIndex
+	{
+	public:
+		struct Finding
+		{
+			FieldDescriptor const *field;
+			char const *rule;
+			string message;
+		};
+
+		LintIndex()
+		{
+		}
+
+		//! @details
+		//! Check every field of the files. Chains of required messages 
+		//! may cross files, so they are all given at once.
+		void AddFiles(vector<FileDescriptor const *> const &files)
+		{
+			for(size_t i = 0; i < files.size(); ++i)
+			{
+				for(int j = 0; j < files[i]->message_type_count(); ++j)
+				{
+					AddRequiredTargets(files[i]->message_type(j));
+				}
+			}
+
+			for(size_t i = 0; i < files.size(); ++i)
+			{
+				for(int j = 0; j < files[i]->message_type_count(); ++j)
+				{
+					CheckMessage(files[i]->message_type(j));
+				}
+			}
+		}
+
+		vector<Finding> const &Findings() const
+		{
+			return m_findings;
+		}
+
+		void Clear()
+		{
+			m_requiredTargets.clear();
+			m_depths.clear();
+			m_findings.clear();
+		}
+
+	private:
+		static bool IsRequiredMessage(FieldDescriptor const *fd)
+		{
+			return fd->is_required() && 
+				fd->cpp_type() == FieldDescriptor::CPPTYPE_MESSAGE;
+		}
+
+		void AddRequiredTargets(Descriptor const *descriptor)
+		{
+			for(int i = 0; i < descriptor->field_count(); ++i)
+			{
+				if(IsRequiredMessage(descriptor->field(i)))
+				{
+					m_requiredTargets.insert(descriptor->field(i)->message_type());
+				}
+			}
+			for(int i = 0; i < descriptor->nested_type_count(); ++i)
+			{
+				AddRequiredTargets(descriptor->nested_type(i));
+			}
+		}
+
+		//! @details
+		//! @return
+		//! The longest chain of nested required messages below the 
+		//! message. A message found again within itself ends the chain.
+		int RequiredDepth(Descriptor const *descriptor)
+		{
+			std::pair<hash_map<void const *, int>::iterator, bool> result = 
+				m_depths.insert(std::make_pair(descriptor, 0));
+			if(result.second == false)
+			{
+				return result.first->second;
+			}
+
+			int depth = 0;
+			for(int i = 0; i < descriptor->field_count(); ++i)
+			{
+				FieldDescriptor const *fd = descriptor->field(i);
+				if(IsRequiredMessage(fd))
+				{
+					depth = std::max(depth, 1 + RequiredDepth(fd->message_type()));
+				}
+			}
+
+			m_depths[descriptor] = depth;
+			return depth;
+		}
+
+		void Add(FieldDescriptor const *fd, char const *rule, string const &message)
+		{
+			Finding finding = { fd, rule, message };
+			m_findings.push_back(finding);
+		}
+
+		void CheckMessage(Descriptor const *descriptor)
+		{
+			bool smallNumberFree = false;
+			for(int number = 1; number <= 15; ++number)
+			{
+				if(descriptor->FindFieldByNumber(number) == NULL && 
+					descriptor->IsExtensionNumber(number) == false)
+				{
+					smallNumberFree = true;
+					break;
+				}
+			}
+
+			for(int i = 0; i < descriptor->field_count(); ++i)
+			{
+				CheckField(descriptor->field(i), smallNumberFree);
+			}
+
+			for(int i = 0; i < descriptor->nested_type_count(); ++i)
+			{
+				CheckMessage(descriptor->nested_type(i));
+			}
+		}
+
+		void CheckField(FieldDescriptor const *fd, bool smallNumberFree)
+		{
+			if(fd->is_repeated() && fd->is_packed() == false &&
+				fd->cpp_type() != FieldDescriptor::CPPTYPE_STRING &&
+				fd->cpp_type() != FieldDescriptor::CPPTYPE_MESSAGE)
+			{
+				Add(fd, "unpacked_repeated", 
+					string("repeated ") + fd->type_name() + 
+					" is not [packed = true], every element has a tag of its own.");
+			}
+
+			if(fd->has_default_value())
+			{
+				CheckDefault(fd);
+			}
+
+			if((fd->is_required() || fd->is_repeated()) && smallNumberFree && 
+				fd->number() > 15)
+			{
+				Add(fd, "high_field_number", 
+					"field number " + SimpleItoa(fd->number()) + " takes a tag of " + 
+					SimpleItoa(TagSize(fd)) + " bytes, while numbers 1..15 " 
+					"are free and take one byte.");
+			}
+
+			if(IsRequiredMessage(fd) && 
+				m_requiredTargets.count(fd->containing_type()) == 0)
+			{
+				int depth = 1 + RequiredDepth(fd->message_type());
+				if(depth > LINT_MAX_REQUIRED_DEPTH)
+				{
+					Add(fd, "deep_required_chain", 
+						"starts a chain of " + SimpleItoa(depth) + 
+						" nested required messages.");
+				}
+			}
+		}
+
+		void CheckDefault(FieldDescriptor const *fd)
+		{
+			int size = 0;
+			int varintSize = 0;
+			char const *varintType = NULL;
+			switch(fd->type())
+			{
+			case FieldDescriptor::TYPE_INT32:
+			case FieldDescriptor::TYPE_INT64:
+				{
+					int64 value = fd->type() == FieldDescriptor::TYPE_INT32 ? 
+						fd->default_value_int32() : fd->default_value_int64();
+					if(value < 0)
+					{
+						Add(fd, "negative_default", 
+							"negative default " + SimpleItoa(value) + " takes 10 bytes, " + 
+							SimpleItoa(io::CodedOutputStream::VarintSize64(
+								internal::WireFormatLite::ZigZagEncode64(value))) +
+							" as " + (fd->type() == FieldDescriptor::TYPE_INT32 ? "sint32" : "sint64") + 
+							".");
+					}
+				}
+				return;
+			case FieldDescriptor::TYPE_FIXED32:
+				size = 4;
+				varintSize = io::CodedOutputStream::VarintSize32(fd->default_value_uint32());
+				varintType = "uint32";
+				break;
+			case FieldDescriptor::TYPE_FIXED64:
+				size = 8;
+				varintSize = io::CodedOutputStream::VarintSize64(fd->default_value_uint64());
+				varintType = "uint64";
+				break;
+			case FieldDescriptor::TYPE_SFIXED32:
+				size = 4;
+				varintSize = io::CodedOutputStream::VarintSize32(
+					internal::WireFormatLite::ZigZagEncode32(fd->default_value_int32()));
+				varintType = "sint32";
+				break;
+			case FieldDescriptor::TYPE_SFIXED64:
+				size = 8;
+				varintSize = io::CodedOutputStream::VarintSize64(
+					internal::WireFormatLite::ZigZagEncode64(fd->default_value_int64()));
+				varintType = "sint64";
+				break;
+			default:
+				return;
+			}
+
+			if(varintSize < size)
+			{
+				Add(fd, "fixed_small_value", 
+					string("default takes ") + SimpleItoa(size) + " bytes as " + 
+					fd->type_name() + ", " + SimpleItoa(varintSize) + " as " + 
+					varintType + ".");
+			}
+		}
+
+		//! Messages that are the type of a required field.
+		hash_set<void const *> m_requiredTargets;
+
+		//! See RequiredDepth.
+		hash_map<void const *, int> m_depths;
+
+		vector<Finding> m_findings;
+
+		GOOGLE_DISALLOW_EVIL_CONSTRUCTORS(LintIndex);
+	};
+
+	//! @details
+	//! @return
+	//! Size of a single value of the field in C++, a pointer for strings
+	//! and messages.
+	int CppScalarSize(FieldDescriptor const *fd)
+	{
+		switch(fd->cpp_type())
+		{
+		case FieldDescriptor::CPPTYPE_INT64:
+		case FieldDescriptor::CPPTYPE_UINT64:
+		case FieldDescriptor::CPPTYPE_DOUBLE:
+		case FieldDescriptor::CPPTYPE_STRING:
+		case FieldDescriptor::CPPTYPE_MESSAGE:
+			return 8;
+		case FieldDescriptor::CPPTYPE_BOOL:
+			return 1;
+		default:
+			return 4;
+		}
+	}
+
+	//! @details
+	//! Size and alignment of the member of a field in the C++ class 
+	//! protoc 2.5 generates, on a 64-bit target. Strings and messages are
+	//! pointers, repeated fields a RepeatedField or RepeatedPtrField whose
+	//! elements are on the heap.
+	void GetCppMemberSize(FieldDescriptor const *fd, int *size, int *alignment)
+	{
+		if(fd->is_repeated())
+		{
+			// elements_, current_size_, total_size_, and allocated_size_ 
+			// for the pointers. A packed field is followed by its cached 
+			// byte size.
+			bool pointers = 
+				fd->cpp_type() == FieldDescriptor::CPPTYPE_STRING ||
+				fd->cpp_type() == FieldDescriptor::CPPTYPE_MESSAGE;
+			*size = pointers ? 24 : (fd->is_packed() ? 20 : 16);
+			*alignment = 8;
+			return;
+		}
+
+		*size = *alignment = CppScalarSize(fd);
+	}
+
+	//! @details
+	//! Estimated size of the objects of the C++ classes protoc 2.5 
+	//! generates for the messages of the run, on a 64-bit target, not 
+	//! counting what they point to. An object holds:
+	//!
+	//!	the vtable pointer and _unknown_fields_ (a pointer)
+	//!	_extensions_ (a std::map) if the message has extension ranges
+	//!	the members of the fields, from the widest alignment down like the
+	//!	generated code does to save padding
+	//!	_cached_size_ and the _has_bits_ words, one bit per field
+	class CppSizeIndex
+	{
+	public:
+		struct MessageSize
+		{
+			Descriptor const *descriptor;
+			int64 objectSize;
+			int hasBitsWords;
+		};
+
+		CppSizeIndex()
+		{
+		}
+
+		void AddFile(FileDescriptor const *file)
+		{
+			for(int i = 0; i < file->message_type_count(); ++i)
+			{
+				AddMessage(file->message_type(i));
+			}
+		}
+
+		//! @details
+		//! @return
+		//! The size of a message added to the index, NULL otherwise.
+		MessageSize const *Find(Descriptor const *descriptor) const
+		{
+			hash_map<void const *, size_t>::const_iterator itr = m_index.find(descriptor);
+			return itr == m_index.end() ? NULL : &m_sizes[itr->second];
+		}
+
+		//! @details
+		//! @return
+		//! Every message added, in document order.
+		vector<MessageSize> const &Sizes() const
+		{
+			return m_sizes;
+		}
+
+		void Clear()
+		{
+			m_index.clear();
+			m_sizes.clear();
+		}
+
+	private:
+		static int64 Align(int64 offset, int alignment)
+		{
+			return (offset + alignment - 1) / alignment * alignment;
+		}
+
+		void AddMessage(Descriptor const *descriptor)
+		{
+			// Members by decreasing alignment: 8, 4, then 1 byte.
+			vector<int> members[3];
+			for(int i = 0; i < descriptor->field_count(); ++i)
+			{
+				FieldDescriptor const *fd = descriptor->field(i);
+				int size = 0;
+				int alignment = 0;
+				GetCppMemberSize(fd, &size, &alignment);
+				members[alignment == 8 ? 0 : (alignment == 4 ? 1 : 2)].push_back(size);
+			}
+
+			int64 offset = 16;
+			if(descriptor->extension_range_count() > 0)
+			{
+				offset += 48;
+			}
+
+			static int const ALIGNMENTS[3] = { 8, 4, 1 };
+			for(int i = 0; i < 3; ++i)
+			{
+				for(size_t j = 0; j < members[i].size(); ++j)
+				{
+					offset = Align(offset, ALIGNMENTS[i]) + members[i][j];
+				}
+			}
+
+			MessageSize size;
+			size.descriptor = descriptor;
+			size.hasBitsWords = (descriptor->field_count() + 31) / 32;
+			size.objectSize = Align(Align(offset, 4) + 4 + 4 * size.hasBitsWords, 8);
+
+			m_index[descriptor] = m_sizes.size();
+			m_sizes.push_back(size);
+
+			for(int i = 0; i < descriptor->nested_type_count(); ++i)
+			{
+				AddMessage(descriptor->nested_type(i));
+			}
+		}
+
+		hash_map<void const *, size_t> m_index;
+		vector<MessageSize> m_sizes;
+
+		GOOGLE_DISALLOW_EVIL_CONSTRUCTORS(CppSizeIndex);
+	};
+
+	//! @details
+	//! See OPTION_NAME_BROKEN_LINKS
+	enum BrokenLinkPolicy
+	{
+		BROKEN_LINKS_KEEP,
+		BROKEN_LINKS_PLAIN,
+		BROKEN_LINKS_ERROR
+	};
+
+	//! @details
+	//! Per-run generation context. It is created from the user options at 
+	//! the start of a run and handed down to every writer. Nothing about a 
+	//! run lives in file scope, so independent runs may happen concurrently
+	//! within the same process.
+	struct DocbookContext
+	{
+		//! @details
+		//! Resolve the look-and-feel and behavior of a run from its options.
+		//!
+		//! @param[in] options
+		//! K/V pairs from docbook.properties and the plugin parameter.
+		explicit DocbookContext(std::map<string, string> const &options);
+
+		//! @details
+		//! K/V pair that holds the options name and the options value.
+		std::map<string, string> docbookOptions;
+
+		//! @details
+		//! Controls the row color. May be overridden through
+		//! OPTION_NAME_ROW_COLOR.
+		string rowColor;
+
+		//! @details
+		//! Controls the alternate row color. May be overridden through 
+		//! OPTION_NAME_ROW_COLOR_ALT.
+		string rowColorAlt;
+
+		//! @details
+		//! Controls the header color. May be overridden through
+		//! OPTION_NAME_COLUMN_HEADER_COLOR.
+		string columnHeaderColor;
+
+		//! @details
+		//! The name of the custom template file.
+		//! see customTemplateFile
+		string customTemplateFileName;
+
+		//! @details
+		//! Merge the output table into the template file. This is optional.
+		//! If template file is not specified, we should run in stand-alone
+		//! mode to generate a complete document.
+		string customTemplateFile;
+
+		//! @details
+		//! To include or exclude the scalar value table.
+		//! See OPTION_NAME_INCLUDE_SCALAR_VALUE_TABLE
+		bool includeScalarValueTable;
+
+		//! @details
+		//! To include or exclude the custom options.
+		//! See OPTION_NAME_INCLUDE_CUSTOM_OPTIONS
+		bool includeCustomOptions;
+
+		//! @details
+		//! See OPTION_NAME_INCLUDE_REFERENCED_BY
+		bool includeReferencedBy;
+
+		//! @details
+		//! See OPTION_NAME_INCLUDE_WIRE_SIZE
+		bool includeWireSize;
+
+		//! @details
+		//! See OPTION_NAME_INCLUDE_CPP_SIZE
+		bool includeCppSize;
+
+		//! @details
+		//! To include or exclude the timestamp in the generated document.
+		//! See OPTION_NAME_INCLUDE_TIMESTAMP
+		bool includeTimestamp;
+
+		//! @details
+		//! To preserve line breaks from comment field in the generated document.
+		//! See OPTION_NAME_PRESERVE_COMMENT_LINE_BREAKS
+		bool preserveCommentLineBreaks;
+
+		//! @details
+		//! Name of the DocBook output file.
+		string docbookOutputFileName;
+
+		//! @details
+		//! The starting <sect> used for the generated table.
+		int startingSectionLevel;
+
+		//! @details
+		//! Number of threads rendering messages. See OPTION_NAME_THREADS.
+		int threadCount;
+
+		//! @details
+		//! See OPTION_NAME_MAX_ROWS_PER_TABLE. 0 for no limit.
+		int maxRowsPerTable;
+
+		//! @details
+		//! This shard, and the number of shards. See OPTION_NAME_SHARD.
+		int shardIndex;
+		int shardCount;
+
+		//! @details
+		//! See OPTION_NAME_BROKEN_LINKS.
+		BrokenLinkPolicy brokenLinks;
+
+		//! @details
+		//! See OPTION_NAME_OLINK_TARGETS. Empty to write no database.
+		string olinkTargetsFileName;
+
+		//! @details
+		//! See OPTION_NAME_COMPACT.
+		bool compact;
+
+		//! @details
+		//! See OPTION_NAME_LINT.
+		bool lint;
+
+		//! @details
+		//! See OPTION_NAME_COMPACT_ENUM_RANGES.
+		bool compactEnumRanges;
+
+		//! @details
+		//! Written between the elements of a table: a line break, or 
+		//! nothing in compact mode.
+		char const *eol;
+
+		//! @details
+		//! Written before each entry of a row: a tab, or nothing in compact
+		//! mode.
+		char const *indent;
+
+		//! @details
+		//! Comments of every file in the run. Filled before rendering starts
+		//! and read-only afterwards.
+		CommentIndex comments;
+
+		//! @details
+		//! Ids of every table in the run. Filled before rendering starts
+		//! and read-only afterwards.
+		IdRegistry ids;
+
+		//! @details
+		//! Custom options of every file in the run. Filled before rendering
+		//! starts and read-only afterwards.
+		CustomOptionIndex customOptions;
+
+		//! @details
+		//! Messages referring to each type of the run, if 
+		//! includeReferencedBy. Filled along with ids.
+		ReferenceIndex references;
+
+		//! @details
+		//! Encoded size of each message of the run, if includeWireSize. 
+		//! Filled along with ids.
+		WireSizeIndex wireSizes;
+
+		//! @details
+		//! Findings of the lint, if lint. Filled along with ids.
+		LintIndex lintFindings;
+
+		//! @details
+		//! C++ object size of each message of the run, if includeCppSize.
+		//! Filled along with ids.
+		CppSizeIndex cppSizes;
+	};
+
+	int const NUM_SCALAR_TABLE_TYPE = 15;
+	int const NUM_SCALAR_TABLE_COLUMN = 4;
+
+	//! @details
+	//! Giant table used for the Scalar Type Table. This information is
+	//! copied directly from protobuf guide.
+	char const * s_scalarTable[NUM_SCALAR_TABLE_TYPE][NUM_SCALAR_TABLE_COLUMN] = {
+		{
+			"double", 
+				"", 
+				"double", 
+				"double"
+		} 
+		, 
+		{
+			"float", 
+				"", 
+				"float", 
+				"float"
+		} 
+		, 	
+		{
+			"int32", 
+				"Uses variable-length encoding. Inefficient for encoding \
+				negative numbers - if your field is likely to have negative \
+				values, use sint32 instead.", 
+				"int32", 
+				"int"
+		} 
+		, 	
+		{
+			"int64", 
+				"Uses variable-length encoding. Inefficient for encoding \
+				negative numbers - if your field is likely to have negative \
+				values, use sint64 instead.", 
+				"int64", 
+				"long"
+		} 
+		, 	
+		{
+			"uint32", 
+				"Uses variable-length encoding.", 
+				"uint32", 
+				"int"
+		} 
+		, 	
+		{
+			"uint64", 
+				"	Uses variable-length encoding.", 
+				"uint64", 
+				"long"
+		} 
+		, 	
+		{
+			"sint32", 
+				"Uses variable-length encoding. Signed int value. These \
+				more efficiently encode negative numbers than regular int32s.", 
+				"int32", 
+				"int"
+		} 
+		, 	
+		{
+			"sint64", 
+				"Uses variable-length encoding. Signed int value. These more\
+				efficiently encode negative numbers than regular int64s.", 
+				"int64", 
+				"long"
+		} 
+		, 	
+		{
+			"fixed32", 
+				"Always four bytes. More efficient than uint32 if values are \
+				often greater than 2^28.", 
+				"uint32", 
+				"int"
+		} 
+		, 	
+		{
+			"fixed64", 
+				"Always eight bytes. More efficient than uint64 if values \
+				are often greater than 2^56.", 
+				"uint64", 
+				"long"
+		} 
+		, 	
+		{
+			"sfixed32", 
+				"Always four bytes..", 
+				"int32", 
+				"int"
+		} 
+		, 	
+		{
+			"sfixed64", 
+				"Always eight bytes.", 
+				"int64", 
+				"long"
+		} 
+		, 	
+		{
+			"bool", 
+				"", 
+				"bool", 
+				"boolean"
+		} 
+		, 	
+		{
+			"string", 
+				"	A string must always contain UTF-8 encoded or 7-bit ASCII text.", 
+				"string", 
+				"String"
+		} 
+		, 	
+		{
+			"bytes", 
+				"May contain any arbitrary sequence of bytes.", 
+				"string", 
+				"ByteString"
+		} 
+	};
+
+	//! @details
+	//! Clean up the comment string for any special characters
+	//! to ensure it is acceptable in XML format. The result is written
+	//! straight into the stream, and runs of plain characters are copied
+	//! directly from the comment.
+	//!
+	//! @warning
+	//! Currently this method does not handle UTF-8 correctly, and this
+	//! should be revisited if unicode comments become a concern.
+	//!
+	void SanitizeCommentForXML(
+		DocbookContext const &ctx, 
+		std::ostream &os,
+		string const &comment)
+	{
+		char const *run = comment.data();
+		char const *end = run + comment.size();
+		for(char const *pos = run; pos != end; ++pos) 
+		{
+			char const *replacement = NULL;
+			switch(*pos) 
+			{
+			case '&':  
+				replacement = "&amp;";
+				break;
+			case '\"': 
+				replacement = "&quot;";
+				break;
+			case '\'': 
+				replacement = "&apos;";
+				break;
+			case '<':  
+				replacement = "&lt;";
+				break;
+			case '>':  
+				replacement = "&gt;";
+				break;
+			case '\n':
+				replacement = ctx.preserveCommentLineBreaks ? "<sbr/>" : "";
+				break;
+			case '\r':
+				replacement = " ";
+				break;
+			case 0:
+				// Space out all null character because stream can't handle it.
+				replacement = " ";
+				break;
+			default:
+				continue;
+			}
+			os.write(run, pos - run);
+			os << replacement;
+			run = pos + 1;
+		}
+		os.write(run, end - run);
+	}
+
+	//! @details
+	//! Occasionally there are some comments that has nothing but white
+	//! spaces. A comment is blank if nothing would be left of it once it
+	//! is sanitized and trimmed.
+	bool IsBlankComment(DocbookContext const &ctx, string const &comment)
+	{
+		for(size_t pos = 0; pos != comment.size(); ++pos) 
+		{
+			unsigned char c = comment[pos];
+			if(c > ' ' || (c == '\n' && ctx.preserveCommentLineBreaks))
+				return false;
+		}
+		return true;
+	}
+
+
+	//! @details
+	//! Turn the comment of a descriptor into docbook paragraph form, written
+	//! straight into the stream. The comment is the leading comment and the
+	//! trailing comment separated by a space.
+	//!
+	//! Since line breaks never survive SanitizeCommentForXML, the whole 
+	//! comment always ends up in a single paragraph.
+	//!
+	//! @return
+	//! true if a paragraph was written, false if the comment was blank.
+	bool ParagraphFormatComment(
+		DocbookContext const &ctx, 
+		std::ostream &os,
+		SourceCodeInfo_Location const *comment)
+	{
+		DBK_HEAP_PHASE_SCOPE(HEAP_PHASE_COMMENTS);
+
+		if(comment == NULL ||
+			(IsBlankComment(ctx, comment->leading_comments()) &&
+			IsBlankComment(ctx, comment->trailing_comments())))
+		{
+			return false;
+		}
+
+		os << "<para>";
+		SanitizeCommentForXML(ctx, os, comment->leading_comments());
+		os << " ";
+		SanitizeCommentForXML(ctx, os, comment->trailing_comments());
+		os << "</para>";
+		return true;
+	}
+
+	//! @details
+	//! Helper method that guards the section level field.
+	//!
+	//! @param[in] sectionLevel
+	//! level to guard
+	//!
+	//! @return
+	//! MAX_SECTION_LEVEL if too large, 1 if <= 0
+	int SectionLevel(int sectionLevel)
+	{
+		if(sectionLevel > MAX_SECTION_LEVEL)
+			return MAX_SECTION_LEVEL;
+
+		if(sectionLevel <= 0)
+			return 1;
+
+		return sectionLevel;
+	}
+
+	//! @details
+	//! Generate a Xlink for a message. This Xlink allows user to click
+	//! and navigate to different messages and enums.
+	//!
+	//! @param[in] DocbookContext const & ctx
+	//! The context of the current run
+	//!
+	//! @param[in] void const * target
+	//! Descriptor of the message or enum, to look up in ctx.ids.
+	//!
+	//! @param[in,out] string const & messageName
+	//! The full globally uniquue message name used to generate the link.
+	//!
+	//! @param[in,out] string const & displayName
+	//! The name of the link to display to user
+	//!
+	//! @return std::string
+	//! The generated Xlink, an olink if the type is documented in another
+	//! document (see OPTION_NAME_OLINK_DATABASE), or only the display name
+	//! if the link is broken and OPTION_NAME_BROKEN_LINKS is "plain".
+	//!
+	string MakeXLink(
+		DocbookContext const &ctx,
+		void const *target,
+		string const &messageName, 
+		string const &displayName)
+	{
+		string const *targetdoc = ctx.ids.FindOlink(target);
+		if(targetdoc != NULL)
+		{
+			return 
+				"<olink targetdoc=\"" + *targetdoc + 
+				"\" targetptr=\"" + ctx.ids.MakeId(messageName) + "\">" + 
+				displayName + "</olink>";
+		}
+
+		if(ctx.brokenLinks == BROKEN_LINKS_PLAIN && ctx.ids.IsBroken(target))
+		{
+			return displayName;
+		}
+
+		std::ostringstream os;
+
+		os 
+			<< "<emphasis role=\"underline\""
+			<< " xlink:href=\"" << "#" << ctx.ids.MakeId(messageName) << "\">"
+			<< displayName<< "</emphasis>";
+
+		return os.str();
+	}
+
+	//! @details
+	//! Generate a Xlink to the Scalar Table. 
+	//! See OPTION_NAME_INCLUDE_SCALAR_VALUE_TABLE
+	//!
+	//! @param[in,out] string const & displayName
+	//! The name of the link to display to user
+	//!
+	//! @return std::string
+	//! The generated Xlink
+	//!
+	string MakeXLinkScalarTable(DocbookContext const &ctx, string const &displayName)
+	{
+		std::ostringstream os;
+
+		os 
+			<< "<emphasis role=\"underline\""
+			<< " xlink:href=\"" << "#" << ctx.ids.MakeId(SCALAR_VALUE_TYPES_TABLE_XML_ID) << "\">"
+			<< displayName<< "</emphasis>";
+
+		return os.str();
+	}
+
+	//! @details
+	//! @return
+	//! Links to the messages that have a field of the type of the 
+	//! descriptor, empty if there are none or they are excluded. See 
+	//! OPTION_NAME_INCLUDE_REFERENCED_BY.
+	string ReferencesText(DocbookContext const &ctx, void const *descriptor)
+	{
+		vector<Descriptor const *> const *referrers = ctx.references.Find(descriptor);
+		if(referrers == NULL)
+		{
+			return string();
+		}
+
+		string text;
+		for(size_t i = 0; i < referrers->size(); ++i)
+		{
+			Descriptor const *referrer = (*referrers)[i];
+			if(i > 0)
+			{
+				text += ", ";
+			}
+			text += MakeXLink(ctx, referrer, referrer->full_name(), referrer->full_name());
+		}
+		return text;
+	}
+
+	//! @details
+	//! @return
+	//! The paragraph of ReferencesText, empty if there are no references.
+	string ReferencesParagraph(DocbookContext const &ctx, void const *descriptor)
+	{
+		string references = ReferencesText(ctx, descriptor);
+		if(references.empty())
+		{
+			return string();
+		}
+		return "<para>Referenced by: " + references + "</para>" + ctx.eol;
+	}
+
+	//! @details
+	//! Append the ReferencesText of the message, and of every message and
+	//! enum within it, one per line.
+	void AppendReferences(
+		DocbookContext const &ctx, 
+		Descriptor const *descriptor, 
+		string *references)
+	{
+		*references += ReferencesText(ctx, descriptor) + "\n";
+		for(int i = 0; i < descriptor->nested_type_count(); ++i)
+		{
+			AppendReferences(ctx, descriptor->nested_type(i), references);
+		}
+		for(int i = 0; i < descriptor->enum_type_count(); ++i)
+		{
+			*references += ReferencesText(ctx, descriptor->enum_type(i)) + "\n";
+		}
+	}
+
+	//! @details
+	//! @return
+	//! The encoded size of a single value of the field, e.g. "1 + 1..10 B"
+	//! for the tag and an int32. See OPTION_NAME_INCLUDE_WIRE_SIZE.
+	string WireSizeText(FieldDescriptor const *fd)
+	{
+		int tag = TagSize(fd);
+
+		std::ostringstream value;
+		int min = 0;
+		int max = 0;
+		int typical = 0;
+		if(GetScalarValueSize(fd, &min, &max, &typical))
+		{
+			value << min;
+			if(max > min)
+			{
+				value << ".." << max;
+			}
+		}
+		else if(fd->type() == FieldDescriptor::TYPE_GROUP)
+		{
+			value << "len + " << tag;
+		}
+		else
+		{
+			value << "1..5 + len";
+		}
+
+		std::ostringstream os;
+		if(fd->is_packed())
+		{
+			os << tag << " + 1..5 + n &#215; " << value.str();
+		}
+		else if(fd->is_repeated())
+		{
+			os << "n &#215; (" << tag << " + " << value.str() << ")";
+		}
+		else
+		{
+			os << tag << " + " << value.str();
+		}
+		os << " B";
+		return os.str();
+	}
+
+	//! @details
+	//! @return
+	//! The size of the member of the field in the generated C++ class, and
+	//! what it points to, e.g. "24 B + n &#215; (8 B + string)". See 
+	//! OPTION_NAME_INCLUDE_CPP_SIZE.
+	string CppSizeText(FieldDescriptor const *fd)
+	{
+		int size = 0;
+		int alignment = 0;
+		GetCppMemberSize(fd, &size, &alignment);
+
+		char const *pointee = NULL;
+		switch(fd->cpp_type())
+		{
+		case FieldDescriptor::CPPTYPE_STRING:
+			pointee = "string";
+			break;
+		case FieldDescriptor::CPPTYPE_MESSAGE:
+			pointee = "message";
+			break;
+		default:
+			break;
+		}
+
+		std::ostringstream os;
+		os << size << " B";
+		if(fd->is_repeated())
+		{
+			if(pointee != NULL)
+			{
+				os << " + n &#215; (8 B + " << pointee << ")";
+			}
+			else
+			{
+				os << " + n &#215; " << CppScalarSize(fd) << " B";
+			}
+		}
+		else if(pointee != NULL)
+		{
+			os << " + " << pointee;
+		}
+		return os.str();
+	}
+
+	//! @details
+	//! @return
+	//! The paragraph with the C++ object size of the message, empty if it
+	//! is excluded. See OPTION_NAME_INCLUDE_CPP_SIZE.
+	string CppSizeParagraph(DocbookContext const &ctx, Descriptor const *descriptor)
+	{
+		CppSizeIndex::MessageSize const *size = ctx.cppSizes.Find(descriptor);
+		if(size == NULL)
+		{
+			return string();
+		}
+
+		std::ostringstream os;
+		os 
+			<< "<para>C++ object size: " << FormattedNumber(size->objectSize) 
+			<< " B on 64-bit targets, without what its fields point to.</para>" 
+			<< ctx.eol;
+		return os.str();
+	}
+
+	//! @details
+	//! @return
+	//! The paragraph with the encoded size of the message, empty if it is
+	//! excluded. See OPTION_NAME_INCLUDE_WIRE_SIZE.
+	string WireSizeParagraph(DocbookContext const &ctx, Descriptor const *descriptor)
+	{
+		WireSizeIndex::MessageSize const *size = ctx.wireSizes.Find(descriptor);
+		if(size == NULL)
+		{
+			return string();
+		}
+
+		std::ostringstream os;
+		os 
+			<< "<para>Encoded size: at least " << FormattedNumber(size->min) 
+			<< " B, typically " << FormattedNumber(size->typical) << " B"
+			<< (size->hasRecursiveFields ? " without its recursive fields" : "")
+			<< ".</para>" << ctx.eol;
+		return os.str();
+	}
+
+	//! @details
+	//! Helper method to return an informative string if "packed" option
+	//! is enabled.
+	//! See https://developers.google.com/protocol-buffers/docs/proto
+	string MakePackedString(FieldDescriptor const *fd)
+	{
+		if(fd->is_packed())
+		{
+			return "[packed = true]";
+		}
+		return "";
+	}
+
+
+	//! @details
+	//! Check if the field has anything for WriteDefaultValueString to write.
+	bool HasDefaultValueString(FieldDescriptor const *fd)
+	{
+		return fd->has_default_value() || fd->is_packed();
+	}
+
+	//! @details
+	//! Writes the default value of the field. Strings are sanitized for 
+	//! XML, bytes are written in hex.
+	void WriteDefaultValue(
+		DocbookContext const &ctx, 
+		std::ostream &os,
+		FieldDescriptor const *fd)
+	{
+		switch(fd->type())
+		{
+		case FieldDescriptor::TYPE_BOOL:
+			{
+				if(fd->default_value_bool())
+					os << "true";
+				else 
+					os << "false";
+			}
+			break;
+		case FieldDescriptor::TYPE_BYTES:
+			WriteHexBytes(os, fd->default_value_string());
+			break;
+		case FieldDescriptor::TYPE_STRING:
+			SanitizeCommentForXML(ctx, os, fd->default_value_string());
+			break;
+		case FieldDescriptor::TYPE_DOUBLE:
+			os << FormattedNumber(fd->default_value_double());
+			break;
+		case FieldDescriptor::TYPE_ENUM:
+			os << fd->default_value_enum()->name();
+			break;
+		case FieldDescriptor::TYPE_FIXED32:
+			os << FormattedNumber(fd->default_value_uint32());
+			break;
+		case FieldDescriptor::TYPE_FIXED64:
+			os << FormattedNumber(fd->default_value_uint64());
+			break;
+		case FieldDescriptor::TYPE_FLOAT:
+			os << FormattedNumber(fd->default_value_float());
+			break;
+		case FieldDescriptor::TYPE_GROUP:
+			break;
+		case FieldDescriptor::TYPE_INT32:
+		case FieldDescriptor::TYPE_SFIXED32:
+		case FieldDescriptor::TYPE_SINT32:
+			os << FormattedNumber(fd->default_value_int32());
+			break;
+		case FieldDescriptor::TYPE_INT64:
+		case FieldDescriptor::TYPE_SFIXED64:
+		case FieldDescriptor::TYPE_SINT64:
+			os << FormattedNumber(fd->default_value_int64());
+			break;
+		case FieldDescriptor::TYPE_UINT32:
+			os << FormattedNumber(fd->default_value_uint32());
+			break;
+		case FieldDescriptor::TYPE_UINT64:
+			os << FormattedNumber(fd->default_value_uint64());
+			break;
+		default:
+			break;
+		}
+	}
+
+	//! @details
+	//! @return
+	//! The custom options set in options, empty if there are none or they 
+	//! are excluded. See OPTION_NAME_INCLUDE_CUSTOM_OPTIONS.
+	template <typename OptionsType>
+	string CustomOptionsText(
+		DocbookContext const &ctx, 
+		OptionsKind kind, 
+		OptionsType const &options)
+	{
+		if(ctx.includeCustomOptions == false)
+		{
+			return string();
+		}
+		return ctx.customOptions.Format(kind, options);
+	}
+
+	//! @details
+	//! Write the custom options the same way as the default value, e.g.
+	//! [(package.option) = 1, (package.other_option) = ENUM_VALUE ]
+	void WriteCustomOptions(
+		DocbookContext const &ctx, 
+		std::ostream &os,
+		string const &options)
+	{
+		os << "[";
+		SanitizeCommentForXML(ctx, os, options);
+		os << " ]";
+	}
+
+	//! @details
+	//! This method writes an informative default string if the field
+	//! has a default value, followed by the packed string if the field
+	//! is packed. Numbers are written with FormattedNumber, so floating
+	//! point defaults keep every significant digit.
+	//!
+	//! @param[in,out] std::ostream & os
+	//! The accumulated stream.
+	//!
+	//! @param[in,out] FieldDescriptor const * fd
+	//! The descriptor of the field that may have the default value.
+	//!
+	void WriteDefaultValueString(
+		DocbookContext const &ctx, 
+		std::ostream &os,
+		FieldDescriptor const *fd)
+	{
+		if(fd->has_default_value())
+		{
+			os << "\n[default = ";
+			WriteDefaultValue(ctx, os, fd);
+			os << " ]";
+		}
+
+		if(fd->is_packed()) 
+		{
+			os << " " << MakePackedString(fd);
+		}
+	}
+
+	//! @details
+	//! Look up the comment of a descriptor. 
+	//!
+	//! @return
+	//! Borrowed location that holds the leading and trailing comments, NULL
+	//! if the descriptor has no source info.
+	template <typename DescriptorType>
+	SourceCodeInfo_Location const *GetDescriptorComment(
+		DocbookContext const &ctx,
+		DescriptorType const *descriptor) 
+	{
+		DBK_HEAP_PHASE_SCOPE(HEAP_PHASE_COMMENTS);
+
+		return ctx.comments.Find(descriptor);
+	}
+
+	//! @details
+	//! Docbook header that wraps the document under the Article tag.
+	//!
+	//! @param[in,out] std::ostringstream & os
+	//! The accumulated stream.
+	void WriteDocbookHeader(std::ostringstream &os)
+	{
+		os 
+			<< "<?xml version=\"1.0\""
+			<< " encoding=\"utf-8\""
+			<< " standalone=\"no\"?>"
+			<< "<article xmlns=\"http://docbook.org/ns/docbook\""
+			<< " xmlns:xlink=\"http://www.w3.org/1999/xlink\""
+			<< " version=\"5.0\">" 
+			<< std::endl;		
+	}
+
+	//! @details
+	//! Docbook footer that closes the article tag
+	//!
+	//! @param[in,out] std::ostringstream & os
+	//! The accumulated stream.
+	void WriteDocbookFooter(DocbookContext const &ctx, std::ostringstream &os)
+	{
+		if(ctx.includeTimestamp)
+		{
+			// Use "Complete ISO date and time, including offset from UTC."
+			// See http://www.sagehill.net/docbookxsl/Datetime.html for 
+			// formatting options.
+			os << "<para>This document was generated <?dbtimestamp \
+				  format=\"c\"?>.</para>" << std::endl;
+		}
+		os << "</article>" << std::endl;		
+	}
+
+	//! @details
+	//! In compact mode, the style of a table is named once on the table 
+	//! instead of being repeated on every row.
+	void WriteCompactTableStyle(DocbookContext const &ctx, std::ostringstream &os)
+	{
+		if(ctx.compact)
+		{
+			os << " tabstyle=\"" << COMPACT_TABLE_STYLE << "\"";
+		}
+	}
+
+	//! @details
+	//! Open a body row, with its color. 
+	//!
+	//! @param[in] bool alternateColor
+	//! Use the alternate row color.
+	//!
+	//! @param[in] bool breakAfterTag
+	//! Write a line break right after the row tag.
+	void WriteBodyRowStart(
+		DocbookContext const &ctx,
+		std::ostringstream &os,
+		bool alternateColor,
+		bool breakAfterTag)
+	{
+		if(ctx.compact)
+		{
+			if(alternateColor)
+			{
+				os << "<row role=\"" << COMPACT_ROW_ROLE_ALT << "\">";
+			}
+			else
+			{
+				os << "<row>";
+			}
+			return;
+		}
+
+		string const &cellcolor = alternateColor ? ctx.rowColorAlt : ctx.rowColor;
+		os << "<row>";
+		if(breakAfterTag)
+		{
+			os << ctx.eol;
+		}
+		os
+			<< "<?dbhtml bgcolor=\"#" << cellcolor << "\" ?>" << ctx.eol
+			<< "<?dbfo bgcolor=\"#" << cellcolor << "\" ?>" << ctx.eol;
+	}
+
+	void WriteProtoFileHeader(
+		DocbookContext const &ctx,
+		std::ostringstream &os, 
+		FileDescriptor const *fd, 
+		int sectionLevel)
+	{
+		os 
+			<< "<sect" << FormattedNumber(SectionLevel(sectionLevel)) << ">"
+			<< "<title> File: " << fd->name() << "</title>" << ctx.eol;
+	}
+
+	//! @details
+	//! Proto file footer that closes the file section scope.
+	//!
+	//! @param[in,out] std::ostringstream & os
+	//! The accumulated stream.
+	//!
+	//! @param[in] int sectionLevel
+	//!
+	//! @return void
+	
+	void WriteProtoFileFooter(
+		DocbookContext const &ctx, 
+		std::ostringstream &os, 
+		int sectionLevel)
+	{
+		os << "</sect" << FormattedNumber(SectionLevel(sectionLevel)) << ">" << ctx.eol;
+	}
+
+	void WriteMessageTableStart(
+		DocbookContext const &ctx,
+		std::ostringstream &os, 
+		string const &xmlID);
+
+	void WriteEnumTableStart(
+		DocbookContext const &ctx,
+		std::ostringstream &os, 
+		string const &xmlID);
+
+	void WriteTableId(std::ostringstream &os, string const &xmlID)
+	{
+		if(xmlID.empty() == false)
+		{
+			os << " xml:id=\"" << xmlID << "\"";
+		}
+	}
+
+	//! @details
+	//! Write the Informal Table Header for a Message type.
+	//! This will define the column header, width and style of the
+	//! field table.
+	void WriteMessageInformalTableHeader(
+		DocbookContext const &ctx,
+		std::ostringstream &os, 
+		string const &xmlID, 
+		string const &title,
+		SourceCodeInfo_Location const *comment,
+		string const &options,
+		string const &notes,
+		int sectionLevel)
+	{
+		os 
+			<< "<sect" << FormattedNumber(SectionLevel(sectionLevel)) << ">"
+			<< "<title> Message: " << title << "</title>" << ctx.eol;
+
+		ParagraphFormatComment(ctx, os, comment);
+
+		if(options.empty() == false)
+		{
+			os << "<para>";
+			WriteCustomOptions(ctx, os, options);
+			os << "</para>";
+		}
+
+		os << ctx.eol << notes;
+		WriteMessageTableStart(ctx, os, xmlID);
+	}
+
+	//! @details
+	//! @return
+	//! The number of columns of the field table of a message: field, type,
+	//! rule, description, and the optional size columns.
+	int MessageTableColumnCount(DocbookContext const &ctx)
+	{
+		return 4 + (ctx.includeWireSize ? 1 : 0) + (ctx.includeCppSize ? 1 : 0);
+	}
+
+	//! @details
+	//! Close the previous colspec, and open the one of an optional column
+	//! of a message table up to its width.
+	void WriteOptionalColspec(
+		DocbookContext const &ctx,
+		std::ostringstream &os, 
+		int column,
+		char const *widthOptionName,
+		char const *defaultWidth)
+	{
+		os
+			<< "*\" />" << ctx.eol
+			<< "<colspec colname=\"c" << column << "\" colnum=\"" << column << "\""
+			<< " colwidth=\"";
+
+		std::map<string,string>::const_iterator itr = 
+			ctx.docbookOptions.find(widthOptionName);
+		if(itr != ctx.docbookOptions.end())
+			os << itr->second;
+		else
+			os << defaultWidth;
+	}
+
+	//! @details
+	//! Open the field table of a message, up to its body.
+	//!
+	//! @param[in] string const & xmlID
+	//! Id of the table, or empty for a continuation table.
+	void WriteMessageTableStart(
+		DocbookContext const &ctx,
+		std::ostringstream &os, 
+		string const &xmlID)
+	{
+		std::map<string,string>::const_iterator itr;
+
+		os << "<informaltable frame=\"all\"";
+		WriteCompactTableStyle(ctx, os);
+		WriteTableId(os, xmlID);
+		os
+			<< ">" << ctx.eol
+			<< "<tgroup cols=\"" << MessageTableColumnCount(ctx) << "\">" << ctx.eol
+			<< " <colspec colname=\"c1\" colnum=\"1\" colwidth=\"";
+
+		itr = ctx.docbookOptions.find(OPTION_NAME_FIELD_NAME_COLUMN_WIDTH);
+		if(itr != ctx.docbookOptions.end())
+			os << itr->second;
+		else
+			os << DEFAULT_FIELD_NAME_COLUMN_WIDTH;
+
+		os
+			<< "*\" />"<< ctx.eol
+			<< "<colspec colname=\"c2\" colnum=\"2\""
+			<< " colwidth=\"";
+
+		itr = ctx.docbookOptions.find(OPTION_NAME_FIELD_TYPE_COLUMN_WIDTH);
+		if(itr != ctx.docbookOptions.end())
+			os << itr->second;
+		else
+			os << DEFAULT_FIELD_TYPE_COLUMN_WIDTH;
+
+		os
+			<< "*\" />" << ctx.eol
+			<< "<colspec colname=\"c3\" colnum=\"3\""
+			<< " colwidth=\"";
+
+		itr = ctx.docbookOptions.find(OPTION_NAME_FIELD_RULE_COLUMN_WIDTH);
+		if(itr != ctx.docbookOptions.end())
+			os << itr->second;
+		else
+			os << DEFAULT_FIELD_RULES_COLUMN_WIDTH;
+
+		int column = 3;
+		if(ctx.includeWireSize)
+		{
+			WriteOptionalColspec(
+				ctx, os, ++column, 
+				OPTION_NAME_FIELD_WIRE_COLUMN_WIDTH, DEFAULT_FIELD_WIRE_COLUMN_WIDTH);
+		}
+		if(ctx.includeCppSize)
+		{
+			WriteOptionalColspec(
+				ctx, os, ++column, 
+				OPTION_NAME_FIELD_CPP_COLUMN_WIDTH, DEFAULT_FIELD_CPP_COLUMN_WIDTH);
+		}
+		++column;
+
+		os
+			<< "*\" />" << ctx.eol
+			<< "<colspec colname=\"c" << column 
+			<< "\" colnum=\"" << column << "\""
+			<< " colwidth=\"";
+
+		itr = ctx.docbookOptions.find(OPTION_NAME_FIELD_DESC_COLUMN_WIDTH);
+		if(itr != ctx.docbookOptions.end())
+			os << itr->second;
+		else
+			os << DEFAULT_FIELD_DESC_COLUMN_WIDTH;
+
+		os
+			<<"*\" />" << ctx.eol
+			<< "<thead>" << ctx.eol
+			<< "<row>" << ctx.eol
+			<< "<?dbhtml bgcolor=\"#";
+
+		os << ctx.columnHeaderColor;
+
+		os
+			<<"\" ?>"<< ctx.eol
+			<< "<?dbfo bgcolor=\"#";
+
+		os << ctx.columnHeaderColor;
+		os
+			<<"\" ?>"<< ctx.eol
+			<< ctx.indent << "<entry>Field</entry>" << ctx.eol
+			<< ctx.indent << "<entry>Type</entry>"<< ctx.eol
+			<< ctx.indent << "<entry>Rule</entry>"<< ctx.eol;
+
+		if(ctx.includeWireSize)
+		{
+			os << ctx.indent << "<entry>Wire Size</entry>"<< ctx.eol;
+		}
+		if(ctx.includeCppSize)
+		{
+			os << ctx.indent << "<entry>C++ Size</entry>"<< ctx.eol;
+		}
+
+		os
+			<< ctx.indent << "<entry>Description</entry>"<< ctx.eol
+			<< "</row>"<< ctx.eol
+			<< "</thead>"<< ctx.eol
+			<< "<tbody>"<< ctx.eol;
+	}
+
+	void WriteEnumInformalTableHeader(
+		DocbookContext const &ctx,
+		std::ostringstream &os, 
+		string const &xmlID, 
+		string const &title,
+		SourceCodeInfo_Location const *description,
+		string const &options,
+		string const &notes,
+		int sectionLevel)
+	{
+		os 
+			<< "<sect" << FormattedNumber(SectionLevel(sectionLevel)) << ">"
+			<< "<title> Enum: " << title << "</title>" << ctx.eol;
+
+		if(description != NULL)
+		{
+			os 
+				<< "<para>"
+				<< description->leading_comments() << " "
+				<< description->trailing_comments()
+				<< "</para>" << ctx.eol;
+		}
+
+		if(options.empty() == false)
+		{
+			os << "<para>";
+			WriteCustomOptions(ctx, os, options);
+			os << "</para>" << ctx.eol;
+		}
+
+		os << notes;
+		WriteEnumTableStart(ctx, os, xmlID);
+	}
+
+	//! @details
+	//! Open the value table of an enum, up to its body.
+	//!
+	//! @param[in] string const & xmlID
+	//! Id of the table, or empty for a continuation table.
+	void WriteEnumTableStart(
+		DocbookContext const &ctx,
+		std::ostringstream &os, 
+		string const &xmlID)
+	{
+		std::map<string,string>::const_iterator itr;
+
+		os << "<informaltable frame=\"all\"";
+		WriteCompactTableStyle(ctx, os);
+		WriteTableId(os, xmlID);
+		os
+			<< ">" << ctx.eol
+			<< "<tgroup cols=\"3\">" << ctx.eol
+			<< " <colspec colname=\"c1\" colnum=\"1\" colwidth=\"";
+
+		itr = ctx.docbookOptions.find(OPTION_NAME_FIELD_NAME_COLUMN_WIDTH);
+		if(itr != ctx.docbookOptions.end())
+			os << itr->second;
+		else
+			os << DEFAULT_FIELD_NAME_COLUMN_WIDTH;
+
+		os
+			<< "*\" />"<< ctx.eol
+			<< "<colspec colname=\"c2\" colnum=\"2\""
+			<< " colwidth=\"";
+
+		itr = ctx.docbookOptions.find(OPTION_NAME_FIELD_TYPE_COLUMN_WIDTH);
+		if(itr != ctx.docbookOptions.end())
+			os << itr->second;
+		else
+			os << DEFAULT_FIELD_TYPE_COLUMN_WIDTH;
+
+		os
+			<< "*\" />" << ctx.eol
+			<< "<colspec colname=\"c3\" colnum=\"3\""
+			<< " colwidth=\"";
+
+		itr = ctx.docbookOptions.find(OPTION_NAME_FIELD_DESC_COLUMN_WIDTH);
+		if(itr != ctx.docbookOptions.end())
+			os << itr->second;
+		else
+			os << DEFAULT_FIELD_RULES_COLUMN_WIDTH;
+
+		os
+			<< "*\" />" << ctx.eol
+			<< "<thead>" << ctx.eol
+			<< "<row>" << ctx.eol
+			<< "<?dbhtml bgcolor=\"#";
+
+		os << ctx.columnHeaderColor;
+
+		os
+			<<"\" ?>"<< ctx.eol
+			<< "<?dbfo bgcolor=\"#";
+
+		os << ctx.columnHeaderColor;
+
+		os
+			<<"\" ?>"<< ctx.eol
+			<< ctx.indent << "<entry>Element</entry>" << ctx.eol
+			<< ctx.indent << "<entry>Value</entry>"<< ctx.eol
+			<< ctx.indent << "<entry>Description</entry>"<< ctx.eol
+			<< "</row>"<< ctx.eol
+			<< "</thead>"<< ctx.eol
+			<< "<tbody>"<< ctx.eol;
+	}
+
+	void WriteInformalTableFooter(DocbookContext const &ctx, std::ostringstream &os)
+	{
+		os 
+			<< "</tbody>"<< ctx.eol
+			<< "</tgroup>"<< ctx.eol
+			<< "</informaltable>"<< ctx.eol;
+	}
+
+	//! @details
+	//! Writes out the close section tag.
+	//! 
+	void WriteCloseSection(
+		DocbookContext const &ctx, 
+		std::ostringstream &os, 
+		int sectionLevel)
+	{
+		os << "</sect"<< FormattedNumber(SectionLevel(sectionLevel)) << ">" <<ctx.eol;
+	}
+
+	void WriteInformalTableFooter(
+		DocbookContext const &ctx, 
+		std::ostringstream &os, 
+		int sectionLevel)
+	{
+		os 
+			<< "</tbody>"<< ctx.eol
+			<< "</tgroup>"<< ctx.eol
+			<< "</informaltable>"<< ctx.eol
+			<< "</sect"<< FormattedNumber(SectionLevel(sectionLevel)) << ">" <<ctx.eol;
+	}
+
+	//! @details
+	//! Before the body row at position row, close the table and open a 
+	//! continuation table once it holds ctx.maxRowsPerTable rows. See 
+	//! OPTION_NAME_MAX_ROWS_PER_TABLE.
+	//!
+	//! @param[in] writeTableStart
+	//! WriteMessageTableStart or WriteEnumTableStart.
+	void SplitTableBeforeRow(
+		DocbookContext const &ctx,
+		std::ostringstream &os, 
+		int row,
+		void (*writeTableStart)(
+			DocbookContext const &, std::ostringstream &, string const &))
+	{
+		if(ctx.maxRowsPerTable > 0 && row > 0 && row % ctx.maxRowsPerTable == 0)
+		{
+			WriteInformalTableFooter(ctx, os);
+			writeTableStart(ctx, os, string());
+		}
+	}
+
+	//! @details
+	//! Write the custom options at the end of a description entry. Like the
+	//! default value, they are a paragraph of their own only if the entry 
+	//! already holds one.
+	void WriteEntryCustomOptions(
+		DocbookContext const &ctx,
+		std::ostringstream &os, 
+		string const &options,
+		bool paragraphWritten)
+	{
+		if(options.empty())
+			return;
+
+		if(paragraphWritten == false)
+		{
+			WriteCustomOptions(ctx, os, options);
+		}
+		else
+		{
+			os << "<para>";
+			WriteCustomOptions(ctx, os, options);
+			os << "</para>";
+		}
+		os << ctx.eol;
+	}
+
+	void WriteMessageInformalTableEntry(
+		DocbookContext const &ctx,
+		std::ostringstream &os, 
+		string const &fieldname,
+		string const &type,
+		string const &occurrence,
+		FieldDescriptor const *fd,
+		SourceCodeInfo_Location const *comment,
+		bool alternateColor)
+	{
+		WriteBodyRowStart(ctx, os, alternateColor, false);
+		os 
+			<< ctx.indent << "<entry>" << fieldname << "</entry>" << ctx.eol
+			<< ctx.indent << "<entry>" << type << "</entry>" << ctx.eol
+			<< ctx.indent << "<entry>" << occurrence << "</entry>" << ctx.eol;
+
+		if(ctx.includeWireSize)
+		{
+			os << ctx.indent << "<entry>" << WireSizeText(fd) << "</entry>" << ctx.eol;
+		}
+		if(ctx.includeCppSize)
+		{
+			os << ctx.indent << "<entry>" << CppSizeText(fd) << "</entry>" << ctx.eol;
+		}
+
+		os << ctx.indent << "<entry>";
+
+		bool paragraphWritten = ParagraphFormatComment(ctx, os, comment);
+
+		if(HasDefaultValueString(fd))
+		{
+			if(paragraphWritten == false)
+			{
+				WriteDefaultValueString(ctx, os, fd);
+			}
+			else
+			{
+				os << "<para>";
+				WriteDefaultValueString(ctx, os, fd);
+				os << "</para>";
+			}
+			os << ctx.eol;
+		}
+
+		WriteEntryCustomOptions(
+			ctx, os, CustomOptionsText(ctx, FIELD_OPTIONS, fd->options()), paragraphWritten);
+
+		os << "</entry>" << ctx.eol;
+		
+		os
+			<< "</row>"<<ctx.eol
+			<< ctx.eol;
+	}
+
+	void WriteEnumInformalTableEntry(
+		DocbookContext const &ctx,
+		std::ostringstream &os, 
+		string const &fieldname,
+		int enumValue,
+		SourceCodeInfo_Location const *comment,
+		string const &options,
+		EnumValueDescriptor const *aliasOf,
+		bool alternateColor)
+	{
+		WriteBodyRowStart(ctx, os, alternateColor, true);
+		os 
+			<< ctx.indent << "<entry>" << fieldname << "</entry>" << ctx.eol
+			<< ctx.indent << "<entry>" << FormattedNumber(enumValue) << "</entry>" << ctx.eol
+			<< ctx.indent << "<entry>";
+
+		bool paragraphWritten = ParagraphFormatComment(ctx, os, comment);
+
+		if(aliasOf != NULL)
+		{
+			if(paragraphWritten == false)
+			{
+				os << "Alias of " << aliasOf->name() << ".";
+			}
+			else
+			{
+				os << "<para>Alias of " << aliasOf->name() << ".</para>";
+			}
+			os << ctx.eol;
+		}
+
+		WriteEntryCustomOptions(ctx, os, options, paragraphWritten);
+
+		os 
+			<< "</entry>" << ctx.eol
+			<< "</row>"<<ctx.eol
+			<< ctx.eol;
+	}
+
+	//! @details
+	//! @return
+	//! The rule of the field as written in the .proto file.
+	char const *LabelName(FieldDescriptor const *fd)
+	{
+		switch(fd->label())
+		{
+		case FieldDescriptor::LABEL_OPTIONAL:
+			return "optional";
+		case FieldDescriptor::LABEL_REPEATED:
+			return "repeated";
+		case FieldDescriptor::LABEL_REQUIRED:
+			return "required";
+		}
+		return "";
+	}
+
+	void WriteMessageFieldEntries( 
+		DocbookContext const &ctx,
+		std::ostringstream &os, 
+		Descriptor const *messageDescriptor)
+	{
+		for (int i = 0; i < messageDescriptor->field_count(); i++) {
+			FieldDescriptor const *fd = messageDescriptor->field(i);
+			string labelStr = LabelName(fd);
+
+			string typeName;
+
+			switch(fd->type())
+			{
+			case FieldDescriptor::TYPE_MESSAGE:
+				typeName = MakeXLink(
+					ctx,
+					fd->message_type(),
+					fd->message_type()->full_name(),
+					fd->message_type()->name());
+				break;
+			case FieldDescriptor::TYPE_ENUM:
+				typeName = MakeXLink(
+					ctx,
+					fd->enum_type(),
+					fd->enum_type()->full_name(),
+					fd->enum_type()->name());
+				break;
+			default:
+
+				if(ctx.includeScalarValueTable)
+				{
+					typeName = MakeXLinkScalarTable(ctx, fd->type_name());
+				}
+				else
+				{
+					typeName = fd->type_name();
+				}
+				
+				break;
+			}
+
+			SplitTableBeforeRow(ctx, os, i, WriteMessageTableStart);
+
+			bool alternateColor = (i%2 != 0);
+			WriteMessageInformalTableEntry(
+				ctx,
+				os, 
+				fd->name(),
+				typeName,
+				labelStr,
+				fd,
+				GetDescriptorComment(ctx, fd),
+				alternateColor);
+		}
+	}
+
+	//! @details
+	//! A single row written for a whole run of values, see 
+	//! OPTION_NAME_COMPACT_ENUM_RANGES.
+	void WriteEnumRangeEntry(
+		DocbookContext const &ctx,
+		std::ostringstream &os, 
+		EnumValueDescriptor const *first,
+		EnumValueDescriptor const *last,
+		bool alternateColor)
+	{
+		WriteBodyRowStart(ctx, os, alternateColor, true);
+		os 
+			<< ctx.indent << "<entry>" << first->name() << " &#x2013; " << last->name() << "</entry>" << ctx.eol
+			<< ctx.indent << "<entry>" << FormattedNumber(first->number()) 
+				<< "&#x2013;" << FormattedNumber(last->number()) << "</entry>" << ctx.eol
+			<< ctx.indent << "<entry>" 
+				<< FormattedNumber(static_cast<int64>(last->number()) - first->number() + 1) 
+				<< " consecutive values." << "</entry>" << ctx.eol
+			<< "</row>"<<ctx.eol
+			<< ctx.eol;
+	}
+
+	bool LowerEnumNumber(EnumValueDescriptor const *lhs, EnumValueDescriptor const *rhs)
+	{
+		return lhs->number() < rhs->number();
+	}
+
+	//! @details
+	//! Writes the values by number, the aliases right after the value they
+	//! share their number with. With OPTION_NAME_COMPACT_ENUM_RANGES, a run 
+	//! of plain values with consecutive numbers becomes a single row. The
+	//! table is split and colored by rows written, not by values.
+	void WriteEnumFieldEntries(
+		DocbookContext const &ctx,
+		std::ostringstream &os, 
+		EnumDescriptor const *enumDescriptor)
+	{
+		vector<EnumValueDescriptor const *> values;
+		values.reserve(enumDescriptor->value_count());
+		for (int i = 0; i < enumDescriptor->value_count(); i++) 
+		{
+			values.push_back(enumDescriptor->value(i));
+		}
+		std::stable_sort(values.begin(), values.end(), LowerEnumNumber);
+
+		// The first value declared with each number, the one the others 
+		// are an alias of.
+		hash_map<int, EnumValueDescriptor const *> firstByNumber;
+		hash_map<int, int> countByNumber;
+		for (size_t i = 0; i < values.size(); i++) 
+		{
+			firstByNumber.insert(std::make_pair(values[i]->number(), values[i]));
+			countByNumber[values[i]->number()]++;
+		}
+
+		// A value may only be part of a range if nothing in its row would
+		// be lost.
+		vector<bool> plain(values.size(), false);
+		if(ctx.compactEnumRanges)
+		{
+			for (size_t i = 0; i < values.size(); i++) 
+			{
+				SourceCodeInfo_Location const *comment = GetDescriptorComment(ctx, values[i]);
+				plain[i] = 
+					countByNumber[values[i]->number()] == 1 &&
+					(comment == NULL ||
+						(IsBlankComment(ctx, comment->leading_comments()) &&
+						IsBlankComment(ctx, comment->trailing_comments()))) &&
+					CustomOptionsText(ctx, ENUM_VALUE_OPTIONS, values[i]->options()).empty();
+			}
+		}
+
+		int row = 0;
+		for (size_t i = 0; i < values.size(); row++) 
+		{
+			SplitTableBeforeRow(ctx, os, row, WriteEnumTableStart);
+			bool alternateColor = (row%2 != 0);
+
+			size_t end = i + 1;
+			while(end < values.size() && plain[i] && plain[end] &&
+				values[end]->number() == values[end - 1]->number() + 1)
+			{
+				++end;
+			}
+
+			if(end - i >= ENUM_RANGE_MIN_VALUES)
+			{
+				WriteEnumRangeEntry(ctx, os, values[i], values[end - 1], alternateColor);
+				i = end;
+				continue;
+			}
+
+			EnumValueDescriptor const *first = firstByNumber[values[i]->number()];
+			WriteEnumInformalTableEntry(
+				ctx,
+				os, 
+				values[i]->name(),
+				values[i]->number(),
+				GetDescriptorComment(ctx, values[i]),
+				CustomOptionsText(ctx, ENUM_VALUE_OPTIONS, values[i]->options()),
+				first != values[i] ? first : NULL,
+				alternateColor);
+			i++;
+		}
+	}
+
+	//! @details
+	//! This method writes the Enum table that belongs to a descriptor.
+	//!
+	//! This method is templatized because Enums may live under file or message
+	//! descriptor under the protobuf definition. Since it is the same code,
+	//! template saves some time.
+	//!
+	//! @param[in] DocbookContext const & ctx
+	//! The context of the current run
+	//!
+	//! @param[in] DescriptorType const * descriptor
+	//! The ptr to the descriptor
+	//!
+	//! @param[in,out] std::ostringstream & os
+	//! The accumulated string
+	//!
+	//! @param[in] string const & prefix
+	//! The prefix holds the scope of the enum. E.g. If the enum E is nested with 
+	//! message M, the prefix should be "M.". This way, it shows up as M.E in the 
+	//! document.
+	//!
+	//! @param[in] int section
+	//! Section level is used to describe which <secX> tag to use.
+	//!
+	template <typename DescriptorType>
+	void WriteEnumTable( 
+		DocbookContext const &ctx,
+		DescriptorType const *descriptor, 
+		std::ostringstream &os,
+		string const &prefix,
+		int section)
+	{
+		for (int i = 0; i < descriptor->enum_type_count(); i++) 
+		{
+			EnumDescriptor const *enumDescriptor = descriptor->enum_type(i);
+
+			string xmlID = ctx.ids.MakeId(enumDescriptor->full_name());
+
+			string enumName;
+			if(prefix.empty() == false)
+			{
+				enumName = prefix;
+				enumName += ".";
+				enumName += enumDescriptor->name();
+			}
+			else
+			{
+				enumName = enumDescriptor->name();
+			}
+
+			WriteEnumInformalTableHeader(
+				ctx,
+				os,
+				xmlID, 
+				enumName,
+				GetDescriptorComment(ctx, enumDescriptor),
+				CustomOptionsText(ctx, ENUM_OPTIONS, enumDescriptor->options()),
+				ReferencesParagraph(ctx, enumDescriptor),
+				section);
+
+			WriteEnumFieldEntries(ctx, os, enumDescriptor);
+			WriteInformalTableFooter(ctx, os, section);
+		}
+	}
+
+	//! @details
+	//! This method writes a table for a single message. If the message
+	//! has no fields, no tables will be written.
+	//!
+	//! @param[in] DocbookContext const & ctx
+	//! The context of the current run
+	//!
+	//! @param[in,out] std::ostringstream & os
+	//! The accumulated string
+	//!
+	//! @param[in] Descriptor const * messageDescriptor
+	//! The ptr to the message descriptor
+	//!
+	//! @param[in] string const & descriptorName
+	//! The human readable name of this descriptor 
+	//!
+	//! @param[in] int sectionLevel
+	//! Section level is used to describe which <secX> tag to use.
+	//!
+	//! @return
+	//! true if a message is written, false otherwise. This is useful to
+	//! determine if a </sectX> tag is needed.
+	//!
+	bool WriteMessageTable(
+		DocbookContext const &ctx,
+		std::ostringstream &os, 
+		Descriptor const *messageDescriptor, 
+		string const &descriptorName,
+		int sectionLevel)
+	{
+		if(messageDescriptor->field_count() > 0)
+		{
+			string xmlID = ctx.ids.MakeId(messageDescriptor->full_name());
+
+			WriteMessageInformalTableHeader(
+				ctx,
+				os,
+				xmlID, 
+				descriptorName,
+				GetDescriptorComment(ctx, messageDescriptor),
+				CustomOptionsText(ctx, MESSAGE_OPTIONS, messageDescriptor->options()),
+				ReferencesParagraph(ctx, messageDescriptor) + 
+					WireSizeParagraph(ctx, messageDescriptor) + 
+					CppSizeParagraph(ctx, messageDescriptor),
+				SectionLevel(sectionLevel));
+
+			WriteMessageFieldEntries(ctx, os, messageDescriptor);
+
+			WriteInformalTableFooter(ctx, os);
+
+			return true;
+		}
+
+		return false;
+	}
+
+	//! @details
+	//! Append the prefix to descriptor name so that the name will be
+	//! scoped descriptively. (E.g. name.child_type1.child_type2)
+	string MakeScopedName(string const &prefix, string const &name)
+	{
+		if(prefix.empty())
+		{
+			return name;
+		}
+		return prefix + "." + name;
+	}
+
+	//! @details
+	//! Writes the table of a message and the enums nested within it, but 
+	//! not its nested messages.
+	//!
+	//! @return
+	//! true if a message table was written and its section must be closed
+	//! after the nested messages.
+	//!
+	bool WriteMessageBody(
+		DocbookContext const &ctx,
+		std::ostringstream &os, 
+		Descriptor const *messageDescriptor, 
+		string const &descriptorName, 
+		int depth)
+	{
+		// Print this message with all of its field. This should generate a
+		// InformalTable type in DocBook for this message.
+		bool messageWritten = 
+			WriteMessageTable(ctx, os, messageDescriptor, descriptorName, depth);
+
+		// Print the enums nested with this message. Since enum is defined 
+		// within the message, its section level should be one below the 
+		// parent message, hence +3.
+		WriteEnumTable(ctx, messageDescriptor, os, descriptorName, depth+1);
+
+		return messageWritten;
+	}
+
+	//! @details
+	//! Scalar Value Table is a table that holds descriptions for primitive 
+	//! types in protobuf (e.g. int32, fixed32, etc). It is a convenient reminder
+	//! on what those type means.
+	//! 
+	//! see OPTION_NAME_INCLUDE_SCALAR_VALUE_TABLE
+	//!
+	//! see https://developers.google.com/protocol-buffers/docs/proto
+	void WriteScalarValueTable(DocbookContext const &ctx, std::ostringstream &os)
+	{
+		os 
+			<< "<sect1>"
+			<< "<title>Scalar Value Types</title>" << ctx.eol
+			<< "<para> A scalar message field can have one of the following types - \
+			   the table shows the type specified in the .proto file, and the \
+			   corresponding type in the automatically generated class: </para>" << ctx.eol
+			<< "<informaltable frame=\"all\"";
+		WriteCompactTableStyle(ctx, os);
+		os
+			<< " xml:id=\"" << ctx.ids.MakeId(SCALAR_VALUE_TYPES_TABLE_XML_ID) << "\">" << ctx.eol
+			<< "<tgroup cols=\"4\">" << ctx.eol
+			<< " <colspec colname=\"c1\" colnum=\"1\" colwidth=\"2*\"/>" << ctx.eol
+			<< " <colspec colname=\"c2\" colnum=\"2\" colwidth=\"6*\"/>" << ctx.eol
+			<< " <colspec colname=\"c3\" colnum=\"3\" colwidth=\"2*\"/>" << ctx.eol
+			<< " <colspec colname=\"c4\" colnum=\"4\" colwidth=\"2*\"/>" << ctx.eol
+			<< "<thead>" << ctx.eol
+			<< "<row>" << ctx.eol
+
+			<< "<?dbhtml bgcolor=\"#" <<ctx.columnHeaderColor << "\" ?>" << ctx.eol
+			<< "<?dbfo bgcolor=\"#" <<ctx.columnHeaderColor << "\" ?>" << ctx.eol
+
+			<< "<entry>Type</entry>" << ctx.eol
+			<< "<entry>Notes</entry>" << ctx.eol
+			<< "<entry>C++ Type</entry>" << ctx.eol
+			<< "<entry>Java Type</entry>" << ctx.eol
+
+			<< "</row>" << ctx.eol
+			<< "</thead>" << ctx.eol
+			
+			<< "<tbody>" << ctx.eol;
+
+		int i=0;
+		int j=0;
+		for(i=0; i<NUM_SCALAR_TABLE_TYPE; ++i)
+		{
+			WriteBodyRowStart(ctx, os, i%2 == 1, false);
+			for(j=0; j<NUM_SCALAR_TABLE_COLUMN; ++j)
+			{
+				os << "<entry>" << s_scalarTable[i][j] << "</entry>" << ctx.eol;
+			}
+			os<< "</row>" << ctx.eol;
+		}
+
+		os
+			<< "</tbody>" << ctx.eol
+			<< "</tgroup>" << ctx.eol
+			<< "</informaltable>" << ctx.eol
+			<< "</sect1>"<< ctx.eol;
+	}
+
+	//! @details
+	//! Makes the template file for the very first call of 
+	//! DocGenerator::Generate method. This is needed because 
+	//! GeneratorContext::OpenForInsert requires knowledge of the output file.
+	//! Hence, GeneratorContext::Open must be called once before 
+	//! GeneratorContext::OpenForInsert would work.
+	//!
+	//! @param[in] ctx
+	//! The context of the current run.
+	//!
+	//! @param[in,out] context
+	//! The generator context used to write the file.
+	void MakeTemplateFile(DocbookContext const &ctx, GeneratorContext &context)
+	{
+		// If there is no custom template filename, it implies that we
+		// are going to use the default file template.
+		if(ctx.customTemplateFileName.empty())
+		{
+			std::ostringstream defaultTemplateOs;
+			WriteDocbookHeader(defaultTemplateOs);		
+			defaultTemplateOs 
+				<< INSERTION_POINT_START_TAG
+				<< DEFAULT_INSERTION_POINT
+				<< INSERTION_POINT_END_TAG
+				<< std::endl;
+
+			if(ctx.includeScalarValueTable)
+			{
+				WriteScalarValueTable(ctx, defaultTemplateOs);
+			}
+
+			WriteDocbookFooter(ctx, defaultTemplateOs);
+
+			scoped_ptr<io::ZeroCopyOutputStream> output(
+				context.Open(ctx.docbookOutputFileName));
+
+			io::Printer printer(output.get(), '$');
+			printer.PrintRaw(defaultTemplateOs.str().c_str());
+		}
+		// Otherwise, user has provided a template. We use the user's
+		// template as base and clone a new file.
+		else
+		{
+			// This section writes the cloned file.
+			{
+				scoped_ptr<io::ZeroCopyOutputStream> output(
+					context.Open(ctx.docbookOutputFileName));
+
+				io::Printer printer(output.get(), '$');
+				printer.PrintRaw(ctx.customTemplateFile.c_str());
+			}
+			// This section copies the scalar table if necessary into
+			// the file.
+			{
+				if(ctx.includeScalarValueTable)
+				{
+					std::ostringstream os;
+					WriteScalarValueTable(ctx, os);
+
+					scoped_ptr<io::ZeroCopyOutputStream> output(
+						context.OpenForInsert(
+						ctx.docbookOutputFileName, 
+						SCALAR_TABLE_INSERTION_POINT));
+
+					io::Printer printer(output.get(), '$');
+					printer.PrintRaw(os.str().c_str());
+				}
+			}
+		}
+	}
+
+	//! @details
+	//! Get the file content into a string buffer.
+	//! 
+	//! @remarks
+	//! Apparently this is one of the fastest method out there.
+	//! http://insanecoding.blogspot.com/2011/11/reading-in-entire-file-at-once-in-c.html
+	std::string GetFileContent(char const *filename)
+	{
+		std::string contents;
+		std::ifstream in(filename, std::ios::in | std::ios::binary);
+		if (in)
+		{
+			in.seekg(0, std::ios::end);
+			contents.resize(in.tellg());
+			in.seekg(0, std::ios::beg);
+			in.read(&contents[0], contents.size());
+			in.close();
+			return(contents);
+		}
+
+		return contents;
+	}
+
+	//! @details
+	//! Open the stream the DocBook of a .proto file is written to. 
+	//! Everything is inserted at the "insertion point", either the one of 
+	//! the default template so that all information is written to a single
+	//! docbook file, or the one named after the .proto file in the custom
+	//! template.
+	//!
+	//! @return
+	//! The stream, owned by the caller.
+	io::ZeroCopyOutputStream *OpenDocBookSection(
+		DocbookContext const &ctx,
+		GeneratorContext *context, 
+		string const &fileName)
+	{
+		if(ctx.customTemplateFileName.empty())
+		{
+			return context->OpenForInsert(
+				ctx.docbookOutputFileName, 
+				DEFAULT_INSERTION_POINT);
+		}
+		return context->OpenForInsert(ctx.docbookOutputFileName, fileName);
+	}
+
+	//! 
+	//! @details
+	//! This method writes the accumulated data buffer into the 
+	//! GeneratorContext. This allows protoc framework to take care of the
+	//! file IO.
+	//!
+	//! @param[in] DocbookContext const & ctx
+	//! The context of the current run.
+	//!
+	//! @param[in] string const & section
+	//! The DocBook of a single .proto file.
+	//!
+	//! @param[in,out] GeneratorContext * context
+	//! The context that we are writing to.
+	//!
+	//! @param[in,out] string * error
+	//! Error strings that may be passed out.
+	//!
+	//! @param[in,out] string const & fileName
+	//! The filename we are writing to.
+	//!
+	//! @return bool
+	//! true if success, false otherwise.
+	//!
+	bool WriteToDocBookFile(
+		DocbookContext const &ctx,
+		string const &section, 
+		GeneratorContext *context, 
+		string *error, 
+		string const &fileName)
+	{
+		scoped_ptr<io::ZeroCopyOutputStream> output(
+			OpenDocBookSection(ctx, context, fileName));
+
+		ReserveOutput(output.get(), section.size());
+
+		io::Printer printer(output.get(), '$');
+		printer.PrintRaw(section);
+
+		if (printer.failed()) 
+		{
+			*error = "CodeGenerator detected write error.";
+			return false;
+		}
+		return true;
+	}
+
+	//! @details
+	//! Constructor
+	//! Every option that affects the look-and-feel of the run is resolved 
+	//! once here, so the writers only need to read the fields.
+	DocbookContext::DocbookContext(std::map<string, string> const &options)
+		: docbookOptions(options)
+		, rowColor("ffffff")
+		, rowColorAlt("f0f0f0")
+		, columnHeaderColor("A6B4C4")
+		, includeScalarValueTable(true)
+		, includeCustomOptions(false)
+		, includeReferencedBy(false)
+		, includeWireSize(false)
+		, includeCppSize(false)
+		, includeTimestamp(false)
+		, preserveCommentLineBreaks(false)
+		, docbookOutputFileName(DEFAULT_OUTPUT_NAME)
+		, startingSectionLevel(1)
+		, threadCount(1)
+		, maxRowsPerTable(0)
+		, shardIndex(0)
+		, shardCount(1)
+		, brokenLinks(BROKEN_LINKS_KEEP)
+		, compact(false)
+		, lint(false)
+		, compactEnumRanges(false)
+		, eol("\n")
+		, indent("\t")
+	{
+		std::map<string, string>::const_iterator itr;
+		itr = docbookOptions.find(OPTION_NAME_ROW_COLOR);
+		if(itr != docbookOptions.end())
+		{
+			rowColor = itr->second;
+		}
+
+		itr = docbookOptions.find(OPTION_NAME_ROW_COLOR_ALT);
+		if(itr != docbookOptions.end())
+		{
+			rowColorAlt = itr->second;
+		}
+
+		itr = docbookOptions.find(OPTION_NAME_COLUMN_HEADER_COLOR);
+		if(itr != docbookOptions.end())
+		{
+			columnHeaderColor = itr->second;
+		}
+
+		itr = docbookOptions.find(OPTION_NAME_INCLUDE_SCALAR_VALUE_TABLE);
+		if(itr != docbookOptions.end())
+		{
+			if(itr->second == "0")
+			{
+				includeScalarValueTable = false;
+			}
+			else
+			{
+				includeScalarValueTable = true;
+			}
+		}
+
+		itr = docbookOptions.find(OPTION_NAME_INCLUDE_CUSTOM_OPTIONS);
+		if(itr != docbookOptions.end())
+		{
+			includeCustomOptions = (itr->second != "0");
+		}
+
+		itr = docbookOptions.find(OPTION_NAME_INCLUDE_REFERENCED_BY);
+		if(itr != docbookOptions.end())
+		{
+			includeReferencedBy = (itr->second != "0");
+		}
+
+		itr = docbookOptions.find(OPTION_NAME_INCLUDE_WIRE_SIZE);
+		if(itr != docbookOptions.end())
+		{
+			includeWireSize = (itr->second != "0");
+		}
+
+		itr = docbookOptions.find(OPTION_NAME_INCLUDE_CPP_SIZE);
+		if(itr != docbookOptions.end())
+		{
+			includeCppSize = (itr->second != "0");
+		}
+
+		itr = docbookOptions.find(OPTION_NAME_LINT);
+		if(itr != docbookOptions.end())
+		{
+			lint = (itr->second != "0");
+		}
+
+		// User provides a custom template file.
+		itr = docbookOptions.find(OPTION_NAME_CUSTOM_TEMPLATE_FILE);
+		if(itr != docbookOptions.end())
+		{
+			// Copy the content in memory, and if successful, consider this
+			// file valid by saving its name.
+			customTemplateFile = GetFileContent(itr->second.c_str());
+
+			if(customTemplateFile.empty() == false)
+			{
+				customTemplateFileName = itr->second;
+				docbookOutputFileName = customTemplateFileName;
+				int lastindex = docbookOutputFileName.find_last_of("."); 
+				docbookOutputFileName.insert(lastindex, "-out");
+			}
+		}
+
+		itr = docbookOptions.find(OPTION_NAME_STARTING_SECTION_LEVEL);
+		if(itr != docbookOptions.end())
+		{
+			std::istringstream buffer(itr->second);
+			buffer >> startingSectionLevel;
+
+			if(startingSectionLevel <= 0 || 
+				startingSectionLevel > MAX_ALLOWED_SECTION_LEVEL_OPTION)
+			{
+				startingSectionLevel = 1;
+			}
+		}
+
+		itr = docbookOptions.find(OPTION_NAME_INCLUDE_TIMESTAMP);
+		if(itr != docbookOptions.end())
+		{
+			if(itr->second == "0")
+			{
+				includeTimestamp = false;
+			}
+			else
+			{
+				includeTimestamp = true;
+			}
+		}
+
+		itr = docbookOptions.find(OPTION_NAME_PRESERVE_COMMENT_LINE_BREAKS);
+		if(itr != docbookOptions.end())
+		{
+			if(itr->second == "0")
+			{
+				preserveCommentLineBreaks = false;
+			}
+			else
+			{
+				preserveCommentLineBreaks = true;
+			}
+		}
+
+		itr = docbookOptions.find(OPTION_NAME_THREADS);
+		if(itr != docbookOptions.end())
+		{
+			std::istringstream buffer(itr->second);
+			buffer >> threadCount;
+
+			if(threadCount <= 0)
+			{
+				threadCount = HardwareConcurrency();
+			}
+		}
+
+		itr = docbookOptions.find(OPTION_NAME_MAX_ROWS_PER_TABLE);
+		if(itr != docbookOptions.end())
+		{
+			std::istringstream buffer(itr->second);
+			buffer >> maxRowsPerTable;
+
+			if(maxRowsPerTable < 0)
+			{
+				maxRowsPerTable = 0;
+			}
+		}
+
+		itr = docbookOptions.find(OPTION_NAME_BROKEN_LINKS);
+		if(itr != docbookOptions.end())
+		{
+			if(itr->second == "plain")
+			{
+				brokenLinks = BROKEN_LINKS_PLAIN;
+			}
+			else if(itr->second == "error")
+			{
+				brokenLinks = BROKEN_LINKS_ERROR;
+			}
+			else
+			{
+				brokenLinks = BROKEN_LINKS_KEEP;
+			}
+		}
+
+		itr = docbookOptions.find(OPTION_NAME_COMPACT);
+		if(itr != docbookOptions.end() && itr->second != "0")
+		{
+			compact = true;
+			eol = "";
+			indent = "";
+		}
+
+		itr = docbookOptions.find(OPTION_NAME_COMPACT_ENUM_RANGES);
+		if(itr != docbookOptions.end() && itr->second != "0")
+		{
+			compactEnumRanges = true;
+		}
+
+		itr = docbookOptions.find(OPTION_NAME_SHORT_IDS);
+		if(itr != docbookOptions.end() && itr->second != "0")
+		{
+			ids.UseShortIds(true);
+		}
+
+		itr = docbookOptions.find(OPTION_NAME_SHARD);
+		if(itr != docbookOptions.end())
+		{
+			std::istringstream buffer(itr->second);
+			char slash = 0;
+			buffer >> shardIndex >> slash >> shardCount;
+
+			if(buffer.fail() || slash != '/' || 
+				shardCount < 1 || shardIndex < 0 || shardIndex >= shardCount)
+			{
+				shardIndex = 0;
+				shardCount = 1;
+			}
+		}
+
+		itr = docbookOptions.find(OPTION_NAME_OLINK_TARGETS);
+		if(itr != docbookOptions.end())
+		{
+			olinkTargetsFileName = itr->second;
+		}
+
+		// Every option past the prefix names a database. They are read
+		// once, and only looked up from then on.
+		string const prefix = OPTION_NAME_OLINK_DATABASE;
+		for(itr = docbookOptions.lower_bound(prefix); 
+			itr != docbookOptions.end() && itr->first.compare(0, prefix.size(), prefix) == 0;
+			++itr)
+		{
+			string database = GetFileContent(itr->second.c_str());
+			if(ids.AddOlinkDatabase(itr->first.substr(prefix.size()), database) == 0)
+			{
+				std::cerr 
+					<< "warning: " << itr->second 
+					<< ": no olink targets read" << std::endl;
+			}
+		}
+	}
+
+	//! @details
+	//! A piece of the document. The pieces of a file, in order, make up 
+	//! its section: the header of the file, every message with its nested
+	//! messages right after it, then the enums and the footer of the file.
+	//! Every writer, serial or not, renders the same pieces.
+	struct DocumentPiece
+	{
+		enum Kind
+		{
+			FILE_HEADER,
+			MESSAGE,
+			FILE_TRAILER
+		};
+
+		DocumentPiece(Kind kind, FileDescriptor const *file)
+			: kind(kind)
+			, file(file)
+			, message(NULL)
+			, depth(0)
+		{
+		}
+
+		Kind kind;
+		FileDescriptor const *file;
+
+		//! For MESSAGE pieces.
+		Descriptor const *message;
+		string prefix;
+		int depth;
+
+		//! Sections to close after the message, innermost first. A message
+		//! section is closed after the last piece of its nested messages.
+		vector<int> closeDepths;
+	};
+
+	//! @details
+	//! Flatten a message and its nested messages into pieces.
+	void AddMessagePieces(
+		vector<DocumentPiece> *pieces,
+		Descriptor const *messageDescriptor,
+		string const &prefix,
+		int depth)
+	{
+		DocumentPiece piece(DocumentPiece::MESSAGE, messageDescriptor->file());
+		piece.message = messageDescriptor;
+		piece.prefix = prefix;
+		piece.depth = depth;
+		pieces->push_back(piece);
+
+		string descriptorName = MakeScopedName(prefix, messageDescriptor->name());
+		for(int i = 0; i < messageDescriptor->nested_type_count(); ++i)
+		{
+			AddMessagePieces(
+				pieces, 
+				messageDescriptor->nested_type(i), 
+				descriptorName, 
+				depth+1);
+		}
+
+		// Same condition as WriteMessageTable.
+		if(messageDescriptor->field_count() > 0)
+		{
+			pieces->back().closeDepths.push_back(depth);
+		}
+	}
+
+	//! @details
+	//! Flatten a file into pieces, after the ones already in the list.
+	void AddFilePieces(
+		DocbookContext const &ctx,
+		vector<DocumentPiece> *pieces,
+		FileDescriptor const *file)
+	{
+		pieces->push_back(DocumentPiece(DocumentPiece::FILE_HEADER, file));
+		for(int i = 0; i < file->message_type_count(); ++i)
+		{
+			AddMessagePieces(pieces, file->message_type(i), "", ctx.startingSectionLevel+1);
+		}
+		pieces->push_back(DocumentPiece(DocumentPiece::FILE_TRAILER, file));
+	}
+
+	void WriteDocumentPiece(
+		DocbookContext const &ctx,
+		std::ostringstream &os,
+		DocumentPiece const &piece)
+	{
+		switch(piece.kind)
+		{
+		case DocumentPiece::FILE_HEADER:
+			WriteProtoFileHeader(ctx, os, piece.file, ctx.startingSectionLevel);
+			break;
+
+		case DocumentPiece::MESSAGE:
+			WriteMessageBody(
+				ctx, 
+				os, 
+				piece.message, 
+				MakeScopedName(piece.prefix, piece.message->name()), 
+				piece.depth);
+			for(size_t i = 0; i < piece.closeDepths.size(); ++i)
+			{
+				WriteCloseSection(ctx, os, piece.closeDepths[i]);
+			}
+			break;
+
+		case DocumentPiece::FILE_TRAILER:
+			WriteEnumTable(ctx, piece.file, os, "", ctx.startingSectionLevel+1);
+			WriteProtoFileFooter(ctx, os, ctx.startingSectionLevel);
+			break;
+		}
+	}
+
+	//! @details
+	//! Renders pieces in order of their index, as long as the queue has
+	//! room for them.
+	class PieceRenderer : public Runnable
+	{
+	public:
+		PieceRenderer(
+			DocbookContext const &ctx,
+			vector<DocumentPiece> const &pieces,
+			AtomicCounter *nextPiece,
+			OrderedQueue *queue)
+			: m_ctx(ctx)
+			, m_pieces(pieces)
+			, m_nextPiece(nextPiece)
+			, m_queue(queue)
+		{
+		}
+
+		// implements Runnable ---------------------------------------------
+		void Run()
+		{
+			DBK_HEAP_PHASE_SCOPE(HEAP_PHASE_ROW_WRITERS);
+
+			// Pieces are claimed in order, so the piece the writer waits for
+			// is always being rendered by a thread that is not blocked.
+			long count = static_cast<long>(m_pieces.size());
+			for(long index = m_nextPiece->Increment() - 1; index < count;
+				index = m_nextPiece->Increment() - 1)
+			{
+				if(m_queue->Reserve(index) == false)
+					return;
+
+				std::ostringstream os;
+				WriteDocumentPiece(m_ctx, os, m_pieces[index]);
+
+				string text = os.str();
+				m_queue->Push(index, &text);
+			}
+		}
+
+	private:
+		DocbookContext const &m_ctx;
+		vector<DocumentPiece> const &m_pieces;
+		AtomicCounter *m_nextPiece;
+		OrderedQueue *m_queue;
+
+		GOOGLE_DISALLOW_EVIL_CONSTRUCTORS(PieceRenderer);
+	};
+
+	//! @details
+	//! Receives the rendered pieces, in order.
+	class PieceSink
+	{
+	public:
+		virtual ~PieceSink()
+		{
+		}
+
+		//! @return
+		//! false to stop the rendering.
+		virtual bool Write(DocumentPiece const &piece, string const &text) = 0;
+	};
+
+	//! @details
+	//! Renders the pieces with ctx.threadCount rendering threads, while the
+	//! calling thread hands each rendered piece to the sink as soon as 
+	//! every piece before it has been handed over. At most 
+	//! PIPELINE_PIECES_PER_THREAD pieces per thread are held in memory, and
+	//! the sink overlaps with the rendering. With a single thread, the 
+	//! pieces are rendered on the calling thread.
+	//!
+	//! @return bool
+	//! false if the sink stopped the rendering.
+	bool RenderPieces(
+		DocbookContext const &ctx,
+		vector<DocumentPiece> const &pieces,
+		PieceSink &sink)
+	{
+		OrderedQueue queue(ctx.threadCount * PIPELINE_PIECES_PER_THREAD);
+		AtomicCounter nextPiece;
+		PieceRenderer renderer(ctx, pieces, &nextPiece, &queue);
+
+		vector<Thread *> threads;
+		for(int i = 0; ctx.threadCount > 1 && i < ctx.threadCount; ++i)
+		{
+			Thread *thread = new Thread;
+			if(thread->Start(&renderer))
+			{
+				threads.push_back(thread);
+			}
+			else
+			{
+				delete thread;
+			}
+		}
+
+		bool succeeded = true;
+		for(size_t i = 0; i < pieces.size(); ++i)
+		{
+			string text;
+			if(threads.empty())
+			{
+				// Single threaded, or no thread could be started.
+				std::ostringstream os;
+				WriteDocumentPiece(ctx, os, pieces[i]);
+				text = os.str();
+			}
+			else
+			{
+				queue.Pop(&text);
+			}
+
+			if(sink.Write(pieces[i], text) == false)
+			{
+				succeeded = false;
+				break;
+			}
+		}
+
+		// Let the renderers go if the sink gave up early.
+		queue.Close();
+		for(size_t i = 0; i < threads.size(); ++i)
+		{
+			threads[i]->Join();
+			delete threads[i];
+		}
+		return succeeded;
+	}
+
+	//! @details
+	//! Appends the pieces to a stream.
+	class StreamPieceSink : public PieceSink
+	{
+	public:
+		explicit StreamPieceSink(std::ostringstream &os)
+			: m_os(os)
+		{
+		}
+
+		// implements PieceSink --------------------------------------------
+		bool Write(DocumentPiece const &, string const &text)
+		{
+			m_os << text;
+			return true;
+		}
+
+	private:
+		std::ostringstream &m_os;
+
+		GOOGLE_DISALLOW_EVIL_CONSTRUCTORS(StreamPieceSink);
+	};
+
+	//! @details
+	//! Writes the tables of a single .proto file into the stream. 
+	//!
+	//! @param[in] DocbookContext const & ctx
+	//! The context of the current run.
+	//!
+	//! @param[in,out] std::ostringstream & os
+	//! Stream to write to.
+	//!
+	//! @param[in] FileDescriptor const * file
+	//! The parsed information of the .proto file.
+	//!
+	void WriteProtoFile(
+		DocbookContext const &ctx, 
+		std::ostringstream &os, 
+		FileDescriptor const *file)
+	{
+		DBK_HEAP_PHASE_SCOPE(HEAP_PHASE_ROW_WRITERS);
+
+		vector<DocumentPiece> pieces;
+		AddFilePieces(ctx, &pieces, file);
+
+		StreamPieceSink sink(os);
+		RenderPieces(ctx, pieces, sink);
+	}
+
+	//! @details
+	//! Prints the pieces to the DocBook section of their file. One printer
+	//! for all the pieces of a file: a printer per piece would hand back 
+	//! and re-request the buffer of the stream each time, which is not 
+	//! cheap for every stream.
+	class OutputPieceSink : public PieceSink
+	{
+	public:
+		OutputPieceSink(
+			DocbookContext const &ctx, 
+			GeneratorContext *context,
+			string *error)
+			: m_ctx(ctx)
+			, m_context(context)
+			, m_error(error)
+			, m_openFile(NULL)
+		{
+		}
+
+		// implements PieceSink --------------------------------------------
+		bool Write(DocumentPiece const &piece, string const &text)
+		{
+			if(piece.file != m_openFile)
+			{
+				// Flush the previous file before opening the next one.
+				m_printer.reset();
+				m_output.reset();
+				m_output.reset(OpenDocBookSection(m_ctx, m_context, piece.file->name()));
+				m_printer.reset(new io::Printer(m_output.get(), '$'));
+				m_openFile = piece.file;
+			}
+
+			m_printer->PrintRaw(text);
+			if(m_printer->failed())
+			{
+				*m_error = "CodeGenerator detected write error.";
+				return false;
+			}
+			return true;
+		}
+
+	private:
+		DocbookContext const &m_ctx;
+		GeneratorContext *m_context;
+		string *m_error;
+
+		FileDescriptor const *m_openFile;
+		scoped_ptr<io::ZeroCopyOutputStream> m_output;
+		scoped_ptr<io::Printer> m_printer;
+
+		GOOGLE_DISALLOW_EVIL_CONSTRUCTORS(OutputPieceSink);
+	};
+
+	//! @details
+	//! Writes the tables of every file with ctx.threadCount rendering 
+	//! threads, straight to the output, without holding a whole file in
+	//! memory. See RenderPieces.
+	//!
+	//! @return bool
+	//! true if success, false otherwise.
+	bool WriteFilesPipelined(
+		DocbookContext const &ctx,
+		vector<FileDescriptor const *> const &files,
+		GeneratorContext *context,
+		string *error)
+	{
+		vector<DocumentPiece> pieces;
+		for(size_t i = 0; i < files.size(); ++i)
+		{
+			AddFilePieces(ctx, &pieces, files[i]);
+		}
+
+		DBK_HEAP_PHASE_SCOPE(HEAP_PHASE_FINAL_WRITE);
+		OutputPieceSink sink(ctx, context, error);
+		return RenderPieces(ctx, pieces, sink);
+	}
+
+	//! @details
+	//! Estimated rendering cost of a message: one unit for its table and 
+	//! one per row, nested types included.
+	long EstimateMessageCost(Descriptor const *descriptor)
+	{
+		long cost = 1 + descriptor->field_count();
+		for(int i = 0; i < descriptor->enum_type_count(); ++i)
+		{
+			cost += 1 + descriptor->enum_type(i)->value_count();
+		}
+		for(int i = 0; i < descriptor->nested_type_count(); ++i)
+		{
+			cost += EstimateMessageCost(descriptor->nested_type(i));
+		}
+		return cost;
+	}
+
+	long EstimateFileCost(FileDescriptor const *file)
+	{
+		long cost = 1;
+		for(int i = 0; i < file->message_type_count(); ++i)
+		{
+			cost += EstimateMessageCost(file->message_type(i));
+		}
+		for(int i = 0; i < file->enum_type_count(); ++i)
+		{
+			cost += 1 + file->enum_type(i)->value_count();
+		}
+		return cost;
+	}
+
+	//! @details
+	//! Orders files by decreasing cost, then by position, so that every 
+	//! shard comes up with the same assignment.
+	struct CostlierFile
+	{
+		explicit CostlierFile(vector<long> const &costs)
+			: m_costs(costs)
+		{
+		}
+
+		bool operator()(size_t a, size_t b) const
+		{
+			if(m_costs[a] != m_costs[b])
+				return m_costs[a] > m_costs[b];
+			return a < b;
+		}
+
+		vector<long> const &m_costs;
+	};
+
+	//! @details
+	//! Files of the run that belong to shard ctx.shardIndex. The files are
+	//! handed out costliest first, each to the shard with the least cost 
+	//! so far (longest processing time first).
+	//!
+	//! @return
+	//! Positions of the files in the run, in document order.
+	vector<size_t> SelectShardFiles(
+		DocbookContext const &ctx,
+		vector<FileDescriptor const *> const &files)
+	{
+		vector<long> costs;
+		vector<size_t> order;
+		for(size_t i = 0; i < files.size(); ++i)
+		{
+			costs.push_back(EstimateFileCost(files[i]));
+			order.push_back(i);
+		}
+		std::sort(order.begin(), order.end(), CostlierFile(costs));
+
+		vector<long> loads(ctx.shardCount, 0);
+		vector<size_t> selected;
+		for(size_t i = 0; i < order.size(); ++i)
+		{
+			int shard = static_cast<int>(
+				std::min_element(loads.begin(), loads.end()) - loads.begin());
+			loads[shard] += costs[order[i]];
+			if(shard == ctx.shardIndex)
+			{
+				selected.push_back(order[i]);
+			}
+		}
+
+		std::sort(selected.begin(), selected.end());
+		return selected;
+	}
+
+	//! @details
+	//! Order of the C++ Memory Footprint section: the heaviest object 
+	//! first.
+	bool HeavierCppObject(
+		CppSizeIndex::MessageSize const &left, 
+		CppSizeIndex::MessageSize const &right)
+	{
+		return left.objectSize > right.objectSize;
+	}
+
+	//! @details
+	//! @return
+	//! The section listing the findings of the lint, with a link to the 
+	//! table of each field. See OPTION_NAME_LINT.
+	string MakeLintSection(DocbookContext const &ctx)
+	{
+		vector<LintIndex::Finding> const &findings = ctx.lintFindings.Findings();
+		int sectionLevel = SectionLevel(ctx.startingSectionLevel);
+
+		std::ostringstream os;
+		os 
+			<< "<sect" << FormattedNumber(sectionLevel) << ">"
+			<< "<title> Schema Lint</title>" << ctx.eol
+			<< "<para>" << FormattedNumber(findings.size()) 
+			<< (findings.size() == 1 ? " finding" : " findings") 
+			<< ".</para>" << ctx.eol;
+
+		if(findings.empty() == false)
+		{
+			os << "<itemizedlist>" << ctx.eol;
+			for(size_t i = 0; i < findings.size(); ++i)
+			{
+				FieldDescriptor const *fd = findings[i].field;
+				Descriptor const *message = fd->containing_type();
+				os 
+					<< "<listitem><para>" 
+					<< MakeXLink(ctx, message, message->full_name(), fd->full_name())
+					<< ": ";
+				SanitizeCommentForXML(ctx, os, findings[i].message);
+				os 
+					<< " (" << findings[i].rule << ")</para></listitem>" << ctx.eol;
+			}
+			os << "</itemizedlist>" << ctx.eol;
+		}
+
+		WriteCloseSection(ctx, os, sectionLevel);
+		return os.str();
+	}
+
+	//! @details
+	//! @return
+	//! The findings of the lint, one "rule file field message" line each,
+	//! tab separated.
+	string MakeLintReport(DocbookContext const &ctx)
+	{
+		vector<LintIndex::Finding> const &findings = ctx.lintFindings.Findings();
+
+		std::ostringstream os;
+		for(size_t i = 0; i < findings.size(); ++i)
+		{
+			FieldDescriptor const *fd = findings[i].field;
+			os 
+				<< findings[i].rule << "\t" << fd->file()->name() << "\t" 
+				<< fd->full_name() << "\t" << findings[i].message << "\n";
+		}
+		return os.str();
+	}
+
+	//! @details
+	//! @return
+	//! The section listing the messages of the run from the heaviest C++
+	//! object down. See OPTION_NAME_INCLUDE_CPP_SIZE.
+	string MakeCppSizeSection(DocbookContext const &ctx)
+	{
+		// Only the messages with a table, so that every row links to one.
+		vector<CppSizeIndex::MessageSize> sizes;
+		for(size_t i = 0; i < ctx.cppSizes.Sizes().size(); ++i)
+		{
+			if(ctx.cppSizes.Sizes()[i].descriptor->field_count() > 0)
+			{
+				sizes.push_back(ctx.cppSizes.Sizes()[i]);
+			}
+		}
+		std::stable_sort(sizes.begin(), sizes.end(), HeavierCppObject);
+
+		int sectionLevel = SectionLevel(ctx.startingSectionLevel);
+
+		std::ostringstream os;
+		os 
+			<< "<sect" << FormattedNumber(sectionLevel) << ">"
+			<< "<title> C++ Memory Footprint</title>" << ctx.eol
+			<< "<para>Estimated size of the objects of the C++ classes protoc 2.5 "
+			<< "generates, on 64-bit targets, without the strings, messages and "
+			<< "repeated elements their fields point to.</para>" << ctx.eol;
+
+		if(sizes.empty() == false)
+		{
+			os 
+				<< "<informaltable frame=\"all\">" << ctx.eol
+				<< "<tgroup cols=\"2\">" << ctx.eol
+				<< "<thead>" << ctx.eol
+				<< "<row>" << ctx.eol
+				<< ctx.indent << "<entry>Message</entry>" << ctx.eol
+				<< ctx.indent << "<entry>Object Size</entry>" << ctx.eol
+				<< "</row>" << ctx.eol
+				<< "</thead>" << ctx.eol
+				<< "<tbody>" << ctx.eol;
+
+			for(size_t i = 0; i < sizes.size(); ++i)
+			{
+				Descriptor const *descriptor = sizes[i].descriptor;
+				os 
+					<< "<row>" << ctx.eol
+					<< ctx.indent << "<entry>" 
+					<< MakeXLink(ctx, descriptor, descriptor->full_name(), descriptor->full_name())
+					<< "</entry>" << ctx.eol
+					<< ctx.indent << "<entry>" << FormattedNumber(sizes[i].objectSize) 
+					<< " B</entry>" << ctx.eol
+					<< "</row>" << ctx.eol;
+			}
+
+			os 
+				<< "</tbody>" << ctx.eol
+				<< "</tgroup>" << ctx.eol
+				<< "</informaltable>" << ctx.eol;
+		}
+
+		WriteCloseSection(ctx, os, sectionLevel);
+		return os.str();
+	}
+
+	//! @details
+	//! Sections written after the ones of the files, as (insertion point, 
+	//! section) pairs: the lint, then the C++ footprint. In the default 
+	//! template they all go to the insertion point of the files.
+	vector<pair<string, string> > MakeTrailingSections(DocbookContext const &ctx)
+	{
+		vector<pair<string, string> > sections;
+		if(ctx.lint)
+		{
+			sections.push_back(
+				std::make_pair(string(LINT_INSERTION_POINT), MakeLintSection(ctx)));
+		}
+		if(ctx.includeCppSize)
+		{
+			sections.push_back(
+				std::make_pair(string(CPP_SIZE_INSERTION_POINT), MakeCppSizeSection(ctx)));
+		}
+		return sections;
+	}
+
+	string MakeShardFragmentName(DocbookContext const &ctx)
+	{
+		std::ostringstream os;
+		os 
+			<< ctx.docbookOutputFileName << ".shard-" 
+			<< FormattedNumber(ctx.shardIndex) << "-of-" 
+			<< FormattedNumber(ctx.shardCount);
+		return os.str();
+	}
+
+	//! @details
+	//! Writes the sections of the files of this shard into its fragment.
+	//! See OPTION_NAME_SHARD.
+	bool WriteShardFragment(
+		DocbookContext const &ctx,
+		vector<FileDescriptor const *> const &files,
+		GeneratorContext *context,
+		string *error)
+	{
+		scoped_ptr<io::ZeroCopyOutputStream> output(
+			context->Open(MakeShardFragmentName(ctx)));
+		io::Printer printer(output.get(), '$');
+
+		// The trailing sections come last, as more files written by the 
+		// first shard.
+		vector<pair<string, string> > trailing = MakeTrailingSections(ctx);
+		size_t sectionCount = files.size() + trailing.size();
+
+		std::ostringstream header;
+		header 
+			<< SHARD_FRAGMENT_TAG 
+			<< " shard=\"" << FormattedNumber(ctx.shardIndex) 
+			<< "/" << FormattedNumber(ctx.shardCount) << "\""
+			<< " files=\"" << FormattedNumber(sectionCount) << "\"?>\n";
+		printer.PrintRaw(header.str());
+
+		vector<size_t> selected = SelectShardFiles(ctx, files);
+		for(size_t i = 0; ctx.shardIndex == 0 && i < trailing.size(); ++i)
+		{
+			selected.push_back(files.size() + i);
+		}
+
+		for(size_t i = 0; i < selected.size(); ++i)
+		{
+			string fileName;
+			string section;
+			if(selected[i] >= files.size())
+			{
+				fileName = trailing[selected[i] - files.size()].first;
+				section = trailing[selected[i] - files.size()].second;
+			}
+			else
+			{
+				std::ostringstream os;
+				fileName = files[selected[i]]->name();
+				WriteProtoFile(ctx, os, files[selected[i]]);
+				section = os.str();
+			}
+
+			std::ostringstream sectionHeader;
+			sectionHeader 
+				<< SHARD_SECTION_TAG 
+				<< " index=\"" << FormattedNumber(selected[i]) << "\""
+				<< " file=\"" << fileName << "\""
+				<< " bytes=\"" << FormattedNumber(section.size()) << "\"?>\n";
+
+			DBK_HEAP_PHASE_SCOPE(HEAP_PHASE_FINAL_WRITE);
+			printer.PrintRaw(sectionHeader.str());
+			printer.PrintRaw(section);
+			printer.PrintRaw("\n");
+		}
+
+		if(printer.failed())
+		{
+			*error = "CodeGenerator detected write error.";
+			return false;
+		}
+		return true;
+	}
+
+	//! @details
+	//! Reads the value of an attribute of a processing instruction written
+	//! by WriteShardFragment.
+	bool ReadShardAttribute(string const &line, char const *name, string *value)
+	{
+		string key = string(" ") + name + "=\"";
+		string::size_type start = line.find(key);
+		if(start == string::npos)
+			return false;
+
+		start += key.size();
+		string::size_type end = line.find('"', start);
+		if(end == string::npos)
+			return false;
+
+		value->assign(line, start, end - start);
+		return true;
+	}
+
+	//! @return
+	//! false unless the whole text is a number.
+	bool ParseShardNumber(string const &text, int64 *value)
+	{
+		std::istringstream buffer(text);
+		buffer >> *value;
+		return buffer.fail() == false && buffer.eof();
+	}
+
+	bool ReadShardNumber(string const &line, char const *name, int64 *value)
+	{
+		string text;
+		return ReadShardAttribute(line, name, &text) && ParseShardNumber(text, value);
+	}
+
+	//! @details
+	//! The state of a merge: the sections found so far, and the shards 
+	//! they came from.
+	struct ShardMerge
+	{
+		ShardMerge(size_t fragmentCount, size_t fragmentBytes)
+			: fragmentCount(fragmentCount)
+			, fragmentBytes(fragmentBytes)
+			, shardCount(0)
+			, fileCount(0)
+		{
+		}
+
+		//! @details
+		//! Bounds of the counts a header may claim, checked before anything
+		//! is sized after them: every shard wrote a fragment, and every 
+		//! file has a section in one of them.
+		size_t fragmentCount;
+		size_t fragmentBytes;
+
+		int64 shardCount;
+		int64 fileCount;
+		vector<bool> seenShards;
+
+		//! (file name, section) by position of the file in the run.
+		vector<pair<string, string> > sections;
+		vector<bool> seenSections;
+	};
+
+	//! @details
+	//! Adds the sections of a fragment to the merge.
+	//!
+	//! @param[in] name
+	//! Name of the fragment, for the errors.
+	bool ReadShardFragment(
+		string const &name,
+		string const &fragment,
+		ShardMerge *merge,
+		string *error)
+	{
+		string::size_type pos = fragment.find('\n');
+		string header = fragment.substr(0, pos);
+
+		int64 shardIndex = 0;
+		int64 shardCount = 0;
+		int64 fileCount = 0;
+		string shard;
+		string::size_type slash = string::npos;
+		if(header.compare(0, strlen(SHARD_FRAGMENT_TAG), SHARD_FRAGMENT_TAG) != 0 ||
+			ReadShardAttribute(header, "shard", &shard) == false)
+		{
+			*error = name + ": not a shard fragment.";
+			return false;
+		}
+		if((slash = shard.find('/')) == string::npos ||
+			ParseShardNumber(shard.substr(0, slash), &shardIndex) == false ||
+			ParseShardNumber(shard.substr(slash + 1), &shardCount) == false ||
+			ReadShardNumber(header, "files", &fileCount) == false ||
+			shardCount < 1 || shardIndex < 0 || shardIndex >= shardCount ||
+			fileCount < 0 || static_cast<uint64>(fileCount) > merge->fragmentBytes)
+		{
+			*error = name + ": corrupted shard fragment header.";
+			return false;
+		}
+		if(static_cast<uint64>(shardCount) > merge->fragmentCount)
+		{
+			*error = name + ": shard " + shard + ", but only " + 
+				SimpleItoa(static_cast<int>(merge->fragmentCount)) + 
+				" fragments were given.";
+			return false;
+		}
+
+		if(merge->shardCount == 0)
+		{
+			merge->shardCount = shardCount;
+			merge->fileCount = fileCount;
+			merge->seenShards.resize(shardCount, false);
+			merge->sections.resize(fileCount);
+			merge->seenSections.resize(fileCount, false);
+		}
+		if(shardCount != merge->shardCount || fileCount != merge->fileCount ||
+			shardIndex < 0 || shardIndex >= shardCount)
+		{
+			*error = name + ": shard " + shard + " does not belong to the same run.";
+			return false;
+		}
+		if(merge->seenShards[shardIndex])
+		{
+			*error = name + ": shard " + shard + " was given twice.";
+			return false;
+		}
+		merge->seenShards[shardIndex] = true;
+
+		while(pos != string::npos && pos + 1 < fragment.size())
+		{
+			++pos;
+			string::size_type end = fragment.find('\n', pos);
+			string line = fragment.substr(pos, end - pos);
+
+			int64 index = 0;
+			int64 bytes = 0;
+			string file;
+			if(end == string::npos ||
+				line.compare(0, strlen(SHARD_SECTION_TAG), SHARD_SECTION_TAG) != 0 ||
+				ReadShardNumber(line, "index", &index) == false ||
+				ReadShardAttribute(line, "file", &file) == false ||
+				ReadShardNumber(line, "bytes", &bytes) == false ||
+				index < 0 || index >= fileCount || bytes < 0 ||
+				end + 1 + bytes >= fragment.size() ||
+				fragment[end + 1 + bytes] != '\n')
+			{
+				*error = name + ": corrupted shard fragment.";
+				return false;
+			}
+			if(merge->seenSections[index])
+			{
+				*error = name + ": " + file + " is in more than one shard.";
+				return false;
+			}
+
+			merge->seenSections[index] = true;
+			merge->sections[index].first = file;
+			merge->sections[index].second.assign(fragment, end + 1, bytes);
+			pos = end + 1 + bytes;
+		}
+		return true;
+	}
+
+	//! @details
+	//! Build the documents out of the sections of the files, in document
+	//! order, the same way GenerateRun does.
+	bool WriteSections(
+		DocbookContext const &ctx,
+		vector<pair<string, string> > const &sections,
+		std::map<string, string> *documents,
+		string *error);
+
+	//! @details
+	//! Register the id of every table of the run in ctx.ids and check 
+	//! the target of every link against it. The references between the 
+	//! types of the run and their sizes are indexed, and the fields 
+	//! linted, at the same time.
+	//!
+	//! @param[out] problems
+	//! Broken links and id collisions found.
+	//!
+	//! @return bool
+	//! false if there are problems and OPTION_NAME_BROKEN_LINKS is "error".
+	//!
+	bool CheckLinks(
+		DocbookContext &ctx,
+		vector<FileDescriptor const *> const &files,
+		vector<string> *problems,
+		string *error)
+	{
+		ctx.ids.Clear();
+		ctx.references.Clear();
+		ctx.wireSizes.Clear();
+		ctx.cppSizes.Clear();
+		for(size_t i = 0; i < files.size(); ++i)
+		{
+			ctx.ids.AddFile(files[i]);
+			if(ctx.includeReferencedBy)
+			{
+				ctx.references.AddFile(files[i]);
+			}
+			if(ctx.includeWireSize)
+			{
+				ctx.wireSizes.AddFile(files[i]);
+			}
+			if(ctx.includeCppSize)
+			{
+				ctx.cppSizes.AddFile(files[i]);
+			}
+		}
+
+		ctx.lintFindings.Clear();
+		if(ctx.lint)
+		{
+			ctx.lintFindings.AddFiles(files);
+		}
+		ctx.ids.Verify(files, problems);
+
+		if(ctx.brokenLinks == BROKEN_LINKS_ERROR && problems->empty() == false)
+		{
+			*error = "";
+			for(size_t i = 0; i < problems->size(); ++i)
+			{
+				*error += (*problems)[i] + "\n";
+			}
+			return false;
+		}
+		return true;
+	}
+
+	//! @details
+	//! @return
+	//! The olink target database of the run, see OPTION_NAME_OLINK_TARGETS.
+	string MakeOlinkTargets(DocbookContext const &ctx)
+	{
+		std::ostringstream os;
+		os 
+			<< "<?xml version=\"1.0\" encoding=\"utf-8\"?>\n"
+			<< "<div element=\"article\" href=\"\" number=\"\" targetptr=\"\">\n";
+
+		// One obj per table, in document order.
+		vector<pair<string, string> > const &tables = ctx.ids.Tables();
+		for(size_t i = 0; i < tables.size(); ++i)
+		{
+			string const &id = tables[i].first;
+			os 
+				<< "<obj element=\"informaltable\" href=\"#" << id 
+				<< "\" number=\"\" targetptr=\"" << id << "\"><ttl>";
+			SanitizeCommentForXML(ctx, os, tables[i].second);
+			os << "</ttl><xreftext>";
+			SanitizeCommentForXML(ctx, os, tables[i].second);
+			os << "</xreftext></obj>\n";
+		}
+
+		os << "</div>\n";
+		return os.str();
+	}
+
+	//! @details
+	//! Warn about the broken links of a run that succeeded anyway.
+	void ReportLinkProblems(vector<string> const &problems)
+	{
+		for(size_t i = 0; i < problems.size(); ++i)
+		{
+			std::cerr << "warning: " << problems[i] << std::endl;
+		}
+	}
+
+	//! @details
+	//! Generates the DocBook for every file of a run. The comments of every
+	//! file are indexed up front. The template file is made first, since 
+	//! GeneratorContext::OpenForInsert requires the output file to exist.
+	//! Each file is then inserted into it in order.
+	//!
+	//! @param[in] DocbookContext const & ctx
+	//! The context of the current run.
+	//!
+	//! @param[in] files
+	//! The files to generate, in document order.
+	//!
+	//! @param[in,out] GeneratorContext * context
+	//! The context that we are writing to.
+	//!
+	//! @param[in,out] string * error
+	//! Error strings that may be passed out.
+	//!
+	//! @return bool
+	//! true if success, false otherwise.
+	//!
+	bool GenerateRun(
+		DocbookContext &ctx,
+		vector<FileDescriptor const *> const &files,
+		GeneratorContext *context,
+		string *error)
+	{
+		for(size_t i = 0; i < files.size(); ++i)
+		{
+			DBK_HEAP_PHASE_SCOPE(HEAP_PHASE_COMMENTS);
+			ctx.comments.AddFile(files[i]);
+			ctx.customOptions.AddFile(files[i]);
+		}
+
+		vector<string> problems;
+		if(CheckLinks(ctx, files, &problems, error) == false)
+		{
+			return false;
+		}
+
+		// Every shard has the ids of the whole run, only one writes them.
+		if(ctx.olinkTargetsFileName.empty() == false && ctx.shardIndex == 0)
+		{
+			scoped_ptr<io::ZeroCopyOutputStream> output(
+				context->Open(ctx.olinkTargetsFileName));
+
+			io::Printer printer(output.get(), '$');
+			printer.PrintRaw(MakeOlinkTargets(ctx));
+		}
+
+		if(ctx.lint && ctx.shardIndex == 0)
+		{
+			scoped_ptr<io::ZeroCopyOutputStream> output(
+				context->Open(ctx.docbookOutputFileName + LINT_REPORT_SUFFIX));
+
+			io::Printer printer(output.get(), '$');
+			printer.PrintRaw(MakeLintReport(ctx));
+		}
+
+		if(ctx.shardCount > 1)
+		{
+			if(WriteShardFragment(ctx, files, context, error) == false)
+			{
+				return false;
+			}
+
+			// Every shard finds the same problems, only one reports them.
+			if(ctx.shardIndex == 0)
+			{
+				ReportLinkProblems(problems);
+			}
+			return true;
+		}
+
+		{
+			DBK_HEAP_PHASE_SCOPE(HEAP_PHASE_FINAL_WRITE);
+			MakeTemplateFile(ctx, *context);
+		}
+
+		if(ctx.threadCount > 1)
+		{
+			if(WriteFilesPipelined(ctx, files, context, error) == false)
+			{
+				return false;
+			}
+		}
+		else
+		{
+			for(size_t i = 0; i < files.size(); ++i)
+			{
+				std::ostringstream os;
+				WriteProtoFile(ctx, os, files[i]);
+
+				DBK_HEAP_PHASE_SCOPE(HEAP_PHASE_FINAL_WRITE);
+				if(WriteToDocBookFile(ctx, os.str(), context, error, files[i]->name()) == false)
+				{
+					return false;
+				}
+			}
+		}
+
+		vector<pair<string, string> > trailing = MakeTrailingSections(ctx);
+		for(size_t i = 0; i < trailing.size(); ++i)
+		{
+			if(WriteToDocBookFile(
+				ctx, trailing[i].second, context, error, trailing[i].first) == false)
+			{
+				return false;
+			}
+		}
+
+		ReportLinkProblems(problems);
+		return true;
+	}
+
+	//! @details
+	//! In-memory GeneratorContext used by the in-process API. Open and
+	//! OpenForInsert follow the same rules as protoc's CommandLineInterface,
+	//! so the documents built here are byte-identical to the ones protoc 
+	//! writes to disk.
+	class DocumentContext : public GeneratorContext
+	{
+	public:
+		DocumentContext(
+			std::map<string, string> *documents,
+			vector<FileDescriptor const *> const &files)
+			: m_documents(documents)
+			, m_files(files)
+		{
+		}
+
+		// implements GeneratorContext -------------------------------------
+		io::ZeroCopyOutputStream* Open(string const &filename)
+		{
+			return new DocumentStream(this, filename, "");
+		}
+
+		io::ZeroCopyOutputStream* OpenForInsert(
+			string const &filename, 
+			string const &insertionPoint)
+		{
+			return new DocumentStream(this, filename, insertionPoint);
+		}
+
+		void ListParsedFiles(vector<FileDescriptor const *> *output)
+		{
+			*output = m_files;
+		}
+
+		//! @details
+		//! Errors found while placing the streams into the documents.
+		string const &Error() const
+		{
+			return m_error;
+		}
+
+	private:
+		//! @details
+		//! Buffers everything written to it, and places the data into the
+		//! target document when it is destroyed.
+		//!
+		//! An insertion whose exact size is reserved up front is written 
+		//! straight into a gap of that size opened in the target document,
+		//! without the buffer.
+		class DocumentStream : public SizedOutputStream
+		{
+		public:
+			DocumentStream(
+				DocumentContext *owner,
+				string const &filename,
+				string const &insertionPoint)
+				: m_owner(owner)
+				, m_filename(filename)
+				, m_insertionPoint(insertionPoint)
+				, m_inner(new SizedStringOutputStream(&m_data))
+				, m_target(NULL)
+				, m_gap(0)
+				, m_gapSize(0)
+				, m_gapUsed(0)
+			{
+			}
+
+			~DocumentStream()
+			{
+				if(m_target != NULL)
+				{
+					GOOGLE_DCHECK_EQ(m_gapUsed, m_gapSize) 
+						<< "Wrong size reserved for the output.";
+					m_owner->CloseGap(m_target, m_gap, m_gapSize, m_gapUsed);
+					return;
+				}
+
+				// Make sure all data has been written.
+				m_inner.reset();
+				m_owner->Place(m_filename, m_insertionPoint, m_data);
+			}
+
+			// implements SizedOutputStream ---------------------------------
+			void Reserve(int64 size)
+			{
+				if(m_inner->ByteCount() == 0 && m_insertionPoint.empty() == false)
+				{
+					m_target = m_owner->OpenGap(
+						m_filename, m_insertionPoint, size, &m_gap);
+					if(m_target != NULL)
+					{
+						m_gapSize = size;
+						return;
+					}
+				}
+				m_inner->Reserve(size);
+			}
+
+			// implements ZeroCopyOutputStream ------------------------------
+			bool Next(void **data, int *size) 
+			{
+				if(m_target == NULL)
+				{
+					return m_inner->Next(data, size); 
+				}
+				if(m_gapUsed == m_gapSize)
+				{
+					// Past the reserved size.
+					return false;
+				}
+				*data = &(*m_target)[m_gap + m_gapUsed];
+				*size = static_cast<int>(m_gapSize - m_gapUsed);
+				m_gapUsed = m_gapSize;
+				return true;
+			}
+
+			void BackUp(int count) 
+			{
+				if(m_target == NULL)
+				{
+					m_inner->BackUp(count); 
+					return;
+				}
+				m_gapUsed -= count;
+			}
+
+			int64 ByteCount() const 
+			{
+				return m_target == NULL ? m_inner->ByteCount() : m_gapUsed; 
+			}
+
+		private:
+			DocumentContext *m_owner;
+			string m_filename;
+			string m_insertionPoint;
+			string m_data;
+			scoped_ptr<SizedStringOutputStream> m_inner;
+
+			//! Document the gap is in, NULL while the data is buffered.
+			string *m_target;
+			string::size_type m_gap;
+			int64 m_gapSize;
+			int64 m_gapUsed;
+		};
+
+		//! @details
+		//! Finds where data inserted at an insertion point goes: right
+		//! before the line that holds the insertion point, so that 
+		//! multiple insertions at the same point end up in order.
+		//!
+		//! @param[out] indent
+		//! Indentation of the insertion point, repeated on each inserted 
+		//! line.
+		//!
+		//! @return
+		//! The target document, NULL if there is no such document or 
+		//! insertion point.
+		string *FindInsertion(
+			string const &filename, 
+			string const &insertionPoint,
+			string::size_type *pos,
+			string *indent,
+			string *error)
+		{
+			std::map<string, string>::iterator itr = m_documents->find(filename);
+			if(itr == m_documents->end())
+			{
+				*error += filename + ": Tried to insert into file that doesn't exist.\n";
+				return NULL;
+			}
+			string &target = itr->second;
+
+			*pos = target.find("@@protoc_insertion_point(" + insertionPoint + ")");
+			if(*pos == string::npos)
+			{
+				*error += filename + ": insertion point \"" + insertionPoint + 
+					"\" not found.\n";
+				return NULL;
+			}
+
+			// Seek backwards to the beginning of the line.
+			*pos = target.find_last_of('\n', *pos);
+			*pos = (*pos == string::npos) ? 0 : *pos + 1;
+
+			indent->assign(target, *pos, target.find_first_not_of(" \t", *pos) - *pos);
+			return &target;
+		}
+
+		//! @details
+		//! Opens a gap of size bytes in the document where an insertion 
+		//! goes, for a DocumentStream to write into.
+		//!
+		//! @return
+		//! The target document, or NULL if the insertion cannot be written
+		//! as is (missing insertion point, or indented lines). The stream 
+		//! then buffers the data, and Place reports or handles it.
+		string *OpenGap(
+			string const &filename, 
+			string const &insertionPoint,
+			int64 size,
+			string::size_type *pos)
+		{
+			string indent;
+			string ignored;
+			string *target = FindInsertion(filename, insertionPoint, pos, &indent, &ignored);
+			if(target == NULL || indent.empty() == false)
+			{
+				return NULL;
+			}
+
+			// The document grows once, to its exact new size.
+			target->insert(*pos, static_cast<string::size_type>(size), '\0');
+			return target;
+		}
+
+		//! @details
+		//! Shrinks the gap to what was written into it, and ends the data
+		//! with a line break the way Place does.
+		void CloseGap(
+			string *target, 
+			string::size_type pos, 
+			int64 size, 
+			int64 used)
+		{
+			string::size_type end = pos + static_cast<string::size_type>(used);
+			target->erase(end, static_cast<string::size_type>(size - used));
+
+			if(used > 0 && (*target)[end - 1] != '\n')
+			{
+				target->insert(end, 1, '\n');
+			}
+		}
+
+		//! @details
+		//! Either creates the document, or inserts the data right before
+		//! the line that holds the insertion point. Each inserted line is
+		//! indented the same way as the insertion point, just like protoc.
+		void Place(
+			string const &filename, 
+			string const &insertionPoint, 
+			string &data)
+		{
+			if(insertionPoint.empty())
+			{
+				if(m_documents->find(filename) != m_documents->end())
+				{
+					m_error += filename + ": Tried to write the same file twice.\n";
+					return;
+				}
+				(*m_documents)[filename].swap(data);
+				return;
+			}
+
+			// If the data doesn't end with a clean line break, add one.
+			if(data.empty() == false && data[data.size() - 1] != '\n')
+			{
+				data.push_back('\n');
+			}
+
+			string::size_type pos = 0;
+			string indent;
+			string *target = FindInsertion(filename, insertionPoint, &pos, &indent, &m_error);
+			if(target == NULL)
+			{
+				return;
+			}
+
+			if(indent.empty())
+			{
+				target->insert(pos, data);
+				return;
+			}
+
+			string indented;
+			string::size_type dataPos = 0;
+			while(dataPos < data.size())
+			{
+				string::size_type lineLength = 
+					data.find('\n', dataPos) + 1 - dataPos;
+				indented += indent;
+				indented.append(data, dataPos, lineLength);
+				dataPos += lineLength;
+			}
+			target->insert(pos, indented);
+		}
+
+		std::map<string, string> *m_documents;
+		vector<FileDescriptor const *> m_files;
+		string m_error;
+
+		GOOGLE_DISALLOW_EVIL_CONSTRUCTORS(DocumentContext);
+	};
+
+	//! @details
+	//! Builds a pool out of the bytes of a serialized FileDescriptorSet.
+	//!
+	//! @param[out] files
+	//! Every file of the set, in the order of the set.
+	bool BuildDescriptorSet(
+		string const &descriptorSet,
+		DescriptorPool *pool,
+		vector<FileDescriptor const *> *files,
+		string *error)
+	{
+		FileDescriptorSet fileSet;
+		if(fileSet.ParseFromString(descriptorSet) == false)
+		{
+			*error = "Unable to parse the FileDescriptorSet.";
+			return false;
+		}
+
+		BuildErrorCollector errorCollector(error);
+		for(int i = 0; i < fileSet.file_size(); ++i)
+		{
+			FileDescriptor const *file = 
+				pool->BuildFileCollectingErrors(fileSet.file(i), &errorCollector);
+			if(file == NULL)
+			{
+				return false;
+			}
+			files->push_back(file);
+		}
+		return true;
+	}
+
+	//! @details
+	//! Every message and enum of a schema, nested or not, by full name.
+	class TypeIndex
+	{
+	public:
+		TypeIndex()
+		{
+		}
+
+		void AddFile(FileDescriptor const *file)
+		{
+			for(int i = 0; i < file->message_type_count(); ++i)
+			{
+				AddMessage(file->message_type(i));
+			}
+			for(int i = 0; i < file->enum_type_count(); ++i)
+			{
+				AddEnum(file->enum_type(i));
+			}
+		}
+
+		template <typename DescriptorType>
+		DescriptorType const *Find(string const &fullName) const;
+
+		//! Messages in declaration order, nested ones after their parent.
+		vector<Descriptor const *> const &Messages() const
+		{
+			return m_messageOrder;
+		}
+
+		//! Enums in declaration order, nested ones after their parent.
+		vector<EnumDescriptor const *> const &Enums() const
+		{
+			return m_enumOrder;
+		}
+
+	private:
+		void AddMessage(Descriptor const *descriptor)
+		{
+			m_messages[descriptor->full_name()] = descriptor;
+			m_messageOrder.push_back(descriptor);
+
+			for(int i = 0; i < descriptor->enum_type_count(); ++i)
+			{
+				AddEnum(descriptor->enum_type(i));
+			}
+			for(int i = 0; i < descriptor->nested_type_count(); ++i)
+			{
+				AddMessage(descriptor->nested_type(i));
+			}
+		}
+
+		void AddEnum(EnumDescriptor const *descriptor)
+		{
+			m_enums[descriptor->full_name()] = descriptor;
+			m_enumOrder.push_back(descriptor);
+		}
+
+		hash_map<string, Descriptor const *> m_messages;
+		hash_map<string, EnumDescriptor const *> m_enums;
+		vector<Descriptor const *> m_messageOrder;
+		vector<EnumDescriptor const *> m_enumOrder;
+
+		GOOGLE_DISALLOW_EVIL_CONSTRUCTORS(TypeIndex);
+	};
+
+	template <>
+	Descriptor const *TypeIndex::Find<Descriptor>(string const &fullName) const
+	{
+		hash_map<string, Descriptor const *>::const_iterator itr = 
+			m_messages.find(fullName);
+		return itr == m_messages.end() ? NULL : itr->second;
+	}
+
+	template <>
+	EnumDescriptor const *TypeIndex::Find<EnumDescriptor>(string const &fullName) const
+	{
+		hash_map<string, EnumDescriptor const *>::const_iterator itr = 
+			m_enums.find(fullName);
+		return itr == m_enums.end() ? NULL : itr->second;
+	}
+
+	//! @details
+	//! The comment of a descriptor as a single string, to compare them.
+	template <typename DescriptorType>
+	string CommentText(DocbookContext const &ctx, DescriptorType const *descriptor)
+	{
+		SourceCodeInfo_Location const *location = ctx.comments.Find(descriptor);
+		if(location == NULL)
+		{
+			return "";
+		}
+		return location->leading_comments() + location->trailing_comments();
+	}
+
+	//! @details
+	//! The type of a field as a plain name, to compare them.
+	string FieldTypeName(FieldDescriptor const *fd)
+	{
+		switch(fd->type())
+		{
+		case FieldDescriptor::TYPE_MESSAGE:
+			return fd->message_type()->full_name();
+		case FieldDescriptor::TYPE_ENUM:
+			return fd->enum_type()->full_name();
+		default:
+			return fd->type_name();
+		}
+	}
+
+	//! @details
+	//! The default value of a field, to compare them. Strings are left 
+	//! as they are, since the text is sanitized when it is written.
+	string DefaultValueText(DocbookContext const &ctx, FieldDescriptor const *fd)
+	{
+		if(fd->has_default_value() == false)
+		{
+			return "";
+		}
+		if(fd->type() == FieldDescriptor::TYPE_STRING)
+		{
+			return fd->default_value_string();
+		}
+		std::ostringstream os;
+		WriteDefaultValue(ctx, os, fd);
+		return os.str();
+	}
+
+	//! @details
+	//! The description column of a change: what changed, then the comment
+	//! of the element.
+	template <typename DescriptorType>
+	SourceCodeInfo_Location MakeChangeNote(
+		DocbookContext const &ctx,
+		string const &changes,
+		DescriptorType const *descriptor)
+	{
+		SourceCodeInfo_Location note;
+		note.set_leading_comments(changes);
+		SourceCodeInfo_Location const *comment = ctx.comments.Find(descriptor);
+		if(comment != NULL)
+		{
+			note.set_trailing_comments(
+				comment->leading_comments() + comment->trailing_comments());
+		}
+		return note;
+	}
+
+	//! @details
+	//! @return
+	//! The changes of a field that has the same number in both schemas, 
+	//! or an empty string if there is none.
+	string DescribeFieldChanges(
+		DocbookContext const &ctx,
+		FieldDescriptor const *oldField,
+		FieldDescriptor const *newField)
+	{
+		string changes;
+		if(oldField->name() != newField->name())
+		{
+			changes += "Renamed from " + oldField->name() + ". ";
+		}
+		if(oldField->label() != newField->label())
+		{
+			changes += string("Rule changed from ") + LabelName(oldField) + ". ";
+		}
+
+		string oldType = FieldTypeName(oldField);
+		if(oldType != FieldTypeName(newField))
+		{
+			changes += "Type changed from " + oldType + ". ";
+		}
+
+		string oldDefault = DefaultValueText(ctx, oldField);
+		string newDefault = DefaultValueText(ctx, newField);
+		if(oldDefault != newDefault)
+		{
+			if(oldDefault.empty())
+				changes += "Default added. ";
+			else if(newDefault.empty())
+				changes += "Default removed, was " + oldDefault + ". ";
+			else
+				changes += "Default changed from " + oldDefault + ". ";
+		}
+
+		if(CommentText(ctx, oldField) != CommentText(ctx, newField))
+		{
+			changes += "Comment changed. ";
+		}
+		return changes;
+	}
+
+	//! @details
+	//! Section of a type that has no table in the report.
+	void WriteChangeSection(
+		DocbookContext const &ctx,
+		std::ostringstream &os,
+		char const *kind,
+		string const &title,
+		SourceCodeInfo_Location const *note,
+		int sectionLevel)
+	{
+		os 
+			<< "<sect" << FormattedNumber(SectionLevel(sectionLevel)) << ">"
+			<< "<title> " << kind << ": " << title << "</title>" << ctx.eol;
+		ParagraphFormatComment(ctx, os, note);
+		os << ctx.eol;
+		WriteCloseSection(ctx, os, SectionLevel(sectionLevel));
+	}
+
+	void WriteFieldChangeEntry(
+		DocbookContext const &ctx,
+		std::ostringstream &os,
+		FieldDescriptor const *fd,
+		string const &changes,
+		bool alternateColor)
+	{
+		string typeName = FieldTypeName(fd);
+		if(fd->type() != FieldDescriptor::TYPE_MESSAGE &&
+			fd->type() != FieldDescriptor::TYPE_ENUM &&
+			ctx.includeScalarValueTable)
+		{
+			typeName = MakeXLinkScalarTable(ctx, typeName);
+		}
+
+		SourceCodeInfo_Location note = MakeChangeNote(ctx, changes, fd);
+		WriteMessageInformalTableEntry(
+			ctx, os, fd->name(), typeName, LabelName(fd), fd, &note, alternateColor);
+	}
+
+	//! @details
+	//! Writes a message that was added, removed or changed. Only the 
+	//! fields that changed are listed for a changed message.
+	//!
+	//! @return
+	//! true if there was something to write.
+	bool WriteMessageChanges(
+		DocbookContext const &ctx,
+		std::ostringstream &os,
+		Descriptor const *oldMessage,
+		Descriptor const *newMessage,
+		int sectionLevel)
+	{
+		Descriptor const *message = newMessage != NULL ? newMessage : oldMessage;
+
+		string typeChanges;
+		vector<pair<FieldDescriptor const *, string> > rows;
+		if(oldMessage == NULL || newMessage == NULL)
+		{
+			typeChanges = newMessage != NULL ? "Added. " : "Removed. ";
+			for(int i = 0; i < message->field_count(); ++i)
+			{
+				rows.push_back(std::make_pair(message->field(i), string()));
+			}
+		}
+		else
+		{
+			if(CommentText(ctx, oldMessage) != CommentText(ctx, newMessage))
+			{
+				typeChanges = "Comment changed. ";
+			}
+
+			// Fields are matched by number, through the hash tables of the
+			// pools.
+			for(int i = 0; i < newMessage->field_count(); ++i)
+			{
+				FieldDescriptor const *newField = newMessage->field(i);
+				FieldDescriptor const *oldField = 
+					oldMessage->FindFieldByNumber(newField->number());
+				if(oldField == NULL)
+				{
+					rows.push_back(std::make_pair(newField, string("Added. ")));
+					continue;
+				}
+
+				string changes = DescribeFieldChanges(ctx, oldField, newField);
+				if(changes.empty() == false)
+				{
+					rows.push_back(std::make_pair(newField, changes));
+				}
+			}
+			for(int i = 0; i < oldMessage->field_count(); ++i)
+			{
+				FieldDescriptor const *oldField = oldMessage->field(i);
+				if(newMessage->FindFieldByNumber(oldField->number()) == NULL)
+				{
+					rows.push_back(std::make_pair(oldField, string("Removed. ")));
+				}
+			}
+
+			if(typeChanges.empty() && rows.empty())
+			{
+				return false;
+			}
+		}
+
+		SourceCodeInfo_Location note = MakeChangeNote(ctx, typeChanges, message);
+		if(rows.empty())
+		{
+			WriteChangeSection(
+				ctx, os, "Message", message->full_name(), &note, sectionLevel);
+			return true;
+		}
+
+		WriteMessageInformalTableHeader(
+			ctx,
+			os,
+			ctx.ids.MakeId(SCHEMA_CHANGES_ID_PREFIX + message->full_name()),
+			message->full_name(),
+			&note,
+			string(),
+			string(),
+			SectionLevel(sectionLevel));
+		for(size_t i = 0; i < rows.size(); ++i)
+		{
+			WriteFieldChangeEntry(ctx, os, rows[i].first, rows[i].second, i%2 == 1);
+		}
+		WriteInformalTableFooter(ctx, os, SectionLevel(sectionLevel));
+		return true;
+	}
+
+	//! @details
+	//! Writes an enum that was added, removed or changed. Only the values
+	//! that changed are listed for a changed enum.
+	//!
+	//! @return
+	//! true if there was something to write.
+	bool WriteEnumChanges(
+		DocbookContext const &ctx,
+		std::ostringstream &os,
+		EnumDescriptor const *oldEnum,
+		EnumDescriptor const *newEnum,
+		int sectionLevel)
+	{
+		EnumDescriptor const *enumDescriptor = newEnum != NULL ? newEnum : oldEnum;
+
+		string typeChanges;
+		vector<pair<EnumValueDescriptor const *, string> > rows;
+		if(oldEnum == NULL || newEnum == NULL)
+		{
+			typeChanges = newEnum != NULL ? "Added. " : "Removed. ";
+			for(int i = 0; i < enumDescriptor->value_count(); ++i)
+			{
+				rows.push_back(std::make_pair(enumDescriptor->value(i), string()));
+			}
+		}
+		else
+		{
+			if(CommentText(ctx, oldEnum) != CommentText(ctx, newEnum))
+			{
+				typeChanges = "Comment changed. ";
+			}
+
+			// Values are matched by name, through the hash tables of the
+			// pools.
+			for(int i = 0; i < newEnum->value_count(); ++i)
+			{
+				EnumValueDescriptor const *newValue = newEnum->value(i);
+				EnumValueDescriptor const *oldValue = 
+					oldEnum->FindValueByName(newValue->name());
+				if(oldValue == NULL)
+				{
+					rows.push_back(std::make_pair(newValue, string("Added. ")));
+					continue;
+				}
+
+				string changes;
+				if(oldValue->number() != newValue->number())
+				{
+					FormattedNumber oldNumber(oldValue->number());
+					changes += "Value changed from " + 
+						string(oldNumber.data(), oldNumber.size()) + ". ";
+				}
+				if(CommentText(ctx, oldValue) != CommentText(ctx, newValue))
+				{
+					changes += "Comment changed. ";
+				}
+				if(changes.empty() == false)
+				{
+					rows.push_back(std::make_pair(newValue, changes));
+				}
+			}
+			for(int i = 0; i < oldEnum->value_count(); ++i)
+			{
+				EnumValueDescriptor const *oldValue = oldEnum->value(i);
+				if(newEnum->FindValueByName(oldValue->name()) == NULL)
+				{
+					rows.push_back(std::make_pair(oldValue, string("Removed. ")));
+				}
+			}
+
+			if(typeChanges.empty() && rows.empty())
+			{
+				return false;
+			}
+		}
+
+		// Only the values changed when the enum itself did not: no note then.
+		SourceCodeInfo_Location note;
+		note.set_leading_comments(typeChanges);
+		SourceCodeInfo_Location const *typeNote = 
+			typeChanges.empty() ? NULL : &note;
+		if(rows.empty())
+		{
+			WriteChangeSection(
+				ctx, os, "Enum", enumDescriptor->full_name(), typeNote, sectionLevel);
+			return true;
+		}
+
+		WriteEnumInformalTableHeader(
+			ctx,
+			os,
+			ctx.ids.MakeId(SCHEMA_CHANGES_ID_PREFIX + enumDescriptor->full_name()),
+			enumDescriptor->full_name(),
+			typeNote,
+			string(),
+			string(),
+			SectionLevel(sectionLevel));
+		for(size_t i = 0; i < rows.size(); ++i)
+		{
+			SourceCodeInfo_Location valueNote = 
+				MakeChangeNote(ctx, rows[i].second, rows[i].first);
+			WriteEnumInformalTableEntry(
+				ctx, 
+				os, 
+				rows[i].first->name(), 
+				rows[i].first->number(), 
+				&valueNote, 
+				string(),
+				NULL,
+				i%2 == 1);
+		}
+		WriteInformalTableFooter(ctx, os, SectionLevel(sectionLevel));
+		return true;
+	}
+
+	//! @details
+	//! Writes the schema change report: every type of the new schema that 
+	//! was added or changed, in declaration order, then every type of the 
+	//! old schema that was removed. Types are matched by full name.
+	void WriteSchemaChanges(
+		DocbookContext const &ctx,
+		std::ostringstream &os,
+		TypeIndex const &oldTypes,
+		TypeIndex const &newTypes)
+	{
+		int sectionLevel = ctx.startingSectionLevel;
+		std::ostringstream body;
+		int changed = 0;
+
+		for(size_t i = 0; i < newTypes.Messages().size(); ++i)
+		{
+			Descriptor const *newMessage = newTypes.Messages()[i];
+			Descriptor const *oldMessage = 
+				oldTypes.Find<Descriptor>(newMessage->full_name());
+			if(WriteMessageChanges(ctx, body, oldMessage, newMessage, sectionLevel+1))
+				++changed;
+		}
+		for(size_t i = 0; i < newTypes.Enums().size(); ++i)
+		{
+			EnumDescriptor const *newEnum = newTypes.Enums()[i];
+			EnumDescriptor const *oldEnum = 
+				oldTypes.Find<EnumDescriptor>(newEnum->full_name());
+			if(WriteEnumChanges(ctx, body, oldEnum, newEnum, sectionLevel+1))
+				++changed;
+		}
+		for(size_t i = 0; i < oldTypes.Messages().size(); ++i)
+		{
+			Descriptor const *oldMessage = oldTypes.Messages()[i];
+			if(newTypes.Find<Descriptor>(oldMessage->full_name()) == NULL)
+			{
+				WriteMessageChanges(ctx, body, oldMessage, NULL, sectionLevel+1);
+				++changed;
+			}
+		}
+		for(size_t i = 0; i < oldTypes.Enums().size(); ++i)
+		{
+			EnumDescriptor const *oldEnum = oldTypes.Enums()[i];
+			if(newTypes.Find<EnumDescriptor>(oldEnum->full_name()) == NULL)
+			{
+				WriteEnumChanges(ctx, body, oldEnum, NULL, sectionLevel+1);
+				++changed;
+			}
+		}
+
+		os 
+			<< "<sect" << FormattedNumber(SectionLevel(sectionLevel)) << ">"
+			<< "<title> Schema Changes</title>" << ctx.eol
+			<< "<para>" << FormattedNumber(changed) 
+			<< (changed == 1 ? " type" : " types") 
+			<< " added, removed or changed.</para>" << ctx.eol
+			<< body.str();
+		WriteCloseSection(ctx, os, SectionLevel(sectionLevel));
+	}
+
+	bool WriteSections(
+		DocbookContext const &ctx,
+		vector<pair<string, string> > const &sections,
+		std::map<string, string> *documents,
+		string *error)
+	{
+		DBK_HEAP_PHASE_SCOPE(HEAP_PHASE_FINAL_WRITE);
+
+		DocumentContext output(documents, vector<FileDescriptor const *>());
+
+		MakeTemplateFile(ctx, output);
+
+		for(size_t i = 0; i < sections.size(); ++i)
+		{
+			if(WriteToDocBookFile(
+				ctx, sections[i].second, &output, error, sections[i].first) == false)
+			{
+				return false;
+			}
+		}
+
+		if(output.Error().empty() == false)
+		{
+			*error = output.Error();
+			return false;
+		}
+		return true;
+	}
+} // end anonymous namespace
+
+//! @details
+//! Constructor
+//! Upon construction, options from docbook.properties (if available) will 
+//! be loaded. Under the protoc plugin framework, only one instance of
+//! DocbookGenerator is ever created, so options will only be loaded once.
+//!
+DocbookGenerator::DocbookGenerator()
+{
+	//! @remark
+	//! Wait a bit to allow human being to attach the debugger to this process.
+	//! Not sure if this is the best way to debug this type of interprocess
+	//! program, but it works well enough for me. (askldjd)
+	//Sleep(10000);
+
+	// Upon construction, read the docbook.properties file once to load up
+	// all the user options. They are resolved into a DocbookContext at the
+	// start of every run.
+	m_docbookOptions = utils::ParseProperty("docbook.properties");
+}
+
+DocbookGenerator::~DocbookGenerator() 
+{
+}
+
+//! @details
+//! This is the main entry point for this plugin. For each file parsed by 
+//! protoc, it will forward the .proto parsed tree into FileDescriptor
+//! format. DocbookGenerator will then traverse the information and generate
+//! the equivalent DocBook output.
+//!
+//! @param [in] file
+//! The parsed information in FileDescriptor form.
+//!
+//! @param [in] parameter
+//! Comma separated k=v options (e.g. --docbook_out=row_color=ffffff:.).
+//! These override the options from docbook.properties for this run.
+//!
+//! @param [in] context
+//! The context object is used to concat DocBook stream into the target file.
+//! This is part of the protoc framework.
+//!
+//! @param [in] error
+//! String for any error that has occurred.
+//!
+bool DocbookGenerator::Generate(
+	FileDescriptor const *file,
+	string const &parameter,
+	GeneratorContext *context,
+	string *error) const 
+{
+	// protoc hands the files over one at a time, but every file is merged
+	// into the same DocBook document. The whole run is therefore generated
+	// when the first file arrives, and the remaining calls are no-ops.
+	vector<FileDescriptor const *> files;
+	context->ListParsedFiles(&files);
+	if(files.empty())
+	{
+		files.push_back(file);
+	}
+	else if(files.front() != file)
+	{
+		return true;
+	}
+
+	std::map<string, string> options = m_docbookOptions;
+	utils::ApplyParameter(parameter, &options);
+
+	DocbookContext ctx(options);
+	bool succeeded = GenerateRun(ctx, files, context, error);
+
+	// Everything from here on is charged to the final write, including the
+	// serialization of the response that protoc does after the last file.
+	DBK_SET_HEAP_PHASE(HEAP_PHASE_FINAL_WRITE);
+
+	return succeeded;
+}
+
+std::map<string, string> ResolveDocbookOptions(string const &parameter)
+{
+	std::map<string, string> options = utils::ParseProperty("docbook.properties");
+	utils::ApplyParameter(parameter, &options);
+	return options;
+}
+
+bool GenerateDocbook(
+	vector<FileDescriptor const *> const &files,
+	std::map<string, string> const &options,
+	std::map<string, string> *documents,
+	string *error)
+{
+	DocbookContext ctx(options);
+	DocumentContext output(documents, files);
+
+	if(GenerateRun(ctx, files, &output, error) == false)
+	{
+		return false;
+	}
+
+	if(output.Error().empty() == false)
+	{
+		*error = output.Error();
+		return false;
+	}
+	return true;
+}
+
+bool GenerateDocbook(
+	vector<FileDescriptor const *> const &files,
+	std::map<string, string> const &options,
+	io::ZeroCopyOutputStream *output,
+	string *error)
+{
+	std::map<string, string> documents;
+	if(GenerateDocbook(files, options, &documents, error) == false)
+	{
+		return false;
+	}
+
+	// A run always produces exactly one document, and possibly the olink 
+	// target database and the lint report, which are of no use here.
+	std::map<string, string>::const_iterator itr = 
+		options.find(OPTION_NAME_OLINK_TARGETS);
+	if(itr != options.end())
+	{
+		documents.erase(itr->second);
+	}
+	for(itr = documents.begin(); itr != documents.end(); ++itr)
+	{
+		documents.erase(itr->first + LINT_REPORT_SUFFIX);
+	}
+
+	io::Printer printer(output, '$');
+	printer.PrintRaw(documents.begin()->second);
+
+	if(printer.failed())
+	{
+		*error = "CodeGenerator detected write error.";
+		return false;
+	}
+	return true;
+}
+
+bool GenerateDocbookFromDescriptorSet(
+	string const &descriptorSet,
+	vector<string> const &filesToGenerate,
+	std::map<string, string> const &options,
+	std::map<string, string> *documents,
+	string *error)
+{
+	// Each call builds its own pool, so concurrent calls share nothing.
+	DescriptorPool pool;
+	vector<FileDescriptor const *> files;
+	if(BuildDescriptorSet(descriptorSet, &pool, &files, error) == false)
+	{
+		return false;
+	}
+
+	if(filesToGenerate.empty() == false)
+	{
+		files.clear();
+	}
+	for(size_t i = 0; i < filesToGenerate.size(); ++i)
+	{
+		FileDescriptor const *file = pool.FindFileByName(filesToGenerate[i]);
+		if(file == NULL)
+		{
+			*error = filesToGenerate[i] + ": not found in the FileDescriptorSet.";
+			return false;
+		}
+		files.push_back(file);
+	}
+
+	return GenerateDocbook(files, options, documents, error);
+}
+
+bool MergeDocbookShards(
+	std::map<string, string> const &fragments,
+	std::map<string, string> const &options,
+	std::map<string, string> *documents,
+	string *error)
+{
+	size_t fragmentBytes = 0;
+	for(std::map<string, string>::const_iterator itr = fragments.begin();
+		itr != fragments.end(); ++itr)
+	{
+		fragmentBytes += itr->second.size();
+	}
+
+	ShardMerge merge(fragments.size(), fragmentBytes);
+	for(std::map<string, string>::const_iterator itr = fragments.begin();
+		itr != fragments.end(); ++itr)
+	{
+		if(ReadShardFragment(itr->first, itr->second, &merge, error) == false)
+		{
+			return false;
+		}
+	}
+
+	for(int64 i = 0; i < merge.shardCount; ++i)
+	{
+		if(merge.seenShards[i] == false)
+		{
+			std::ostringstream os;
+			os << "shard " << FormattedNumber(i) << "/" 
+				<< FormattedNumber(merge.shardCount) << " is missing.";
+			*error = os.str();
+			return false;
+		}
+	}
+
+	DocbookContext ctx(options);
+	return WriteSections(ctx, merge.sections, documents, error);
+}
+
+bool GenerateDocbookDiff(
+	string const &oldDescriptorSet,
+	string const &newDescriptorSet,
+	std::map<string, string> const &options,
+	std::map<string, string> *documents,
+	string *error)
+{
+	DescriptorPool oldPool;
+	vector<FileDescriptor const *> oldFiles;
+	if(BuildDescriptorSet(oldDescriptorSet, &oldPool, &oldFiles, error) == false)
+	{
+		*error = "old: " + *error;
+		return false;
+	}
+
+	DescriptorPool newPool;
+	vector<FileDescriptor const *> newFiles;
+	if(BuildDescriptorSet(newDescriptorSet, &newPool, &newFiles, error) == false)
+	{
+		*error = "new: " + *error;
+		return false;
+	}
+
+	// The change report has the regular four columns, and no sizes.
+	DocbookContext ctx(options);
+	ctx.includeWireSize = false;
+	ctx.includeCppSize = false;
+	TypeIndex oldTypes;
+	TypeIndex newTypes;
+	for(size_t i = 0; i < oldFiles.size(); ++i)
+	{
+		ctx.comments.AddFile(oldFiles[i]);
+		oldTypes.AddFile(oldFiles[i]);
+	}
+	for(size_t i = 0; i < newFiles.size(); ++i)
+	{
+		ctx.comments.AddFile(newFiles[i]);
+		newTypes.AddFile(newFiles[i]);
+	}
+
+	std::ostringstream os;
+	WriteSchemaChanges(ctx, os, oldTypes, newTypes);
+
+	DocumentContext output(documents, newFiles);
+	MakeTemplateFile(ctx, output);
+	if(WriteToDocBookFile(
+		ctx, os.str(), &output, error, SCHEMA_CHANGES_INSERTION_POINT) == false)
+	{
+		return false;
+	}
+
+	if(output.Error().empty() == false)
+	{
+		*error = output.Error();
+		return false;
+	}
+	return true;
+}
+
+struct DocbookRenderer::Impl
+{
+	explicit Impl(std::map<string, string> const &options)
+		: ctx(options)
+	{
+	}
+
+	DocbookContext ctx;
+};
+
+DocbookRenderer::DocbookRenderer(std::map<string, string> const &options)
+	: m_impl(new Impl(options))
+{
+}
+
+DocbookRenderer::~DocbookRenderer()
+{
+	delete m_impl;
+}
+
+bool DocbookRenderer::CheckLinks(
+	vector<FileDescriptor const *> const &files,
+	vector<string> *problems,
+	string *error)
+{
+	return docbook::CheckLinks(m_impl->ctx, files, problems, error);
+}
+
+void DocbookRenderer::RenderFile(FileDescriptor const *file, string *section)
+{
+	DocbookContext &ctx = m_impl->ctx;
+
+	// Only the comments of this file are needed, and the descriptors of
+	// earlier calls may be gone by now.
+	ctx.comments.Clear();
+	ctx.customOptions.Clear();
+	{
+		DBK_HEAP_PHASE_SCOPE(HEAP_PHASE_COMMENTS);
+		ctx.comments.AddFile(file);
+		ctx.customOptions.AddFile(file);
+	}
+
+	std::ostringstream os;
+	WriteProtoFile(ctx, os, file);
+	*section = os.str();
+
+	ctx.comments.Clear();
+	ctx.customOptions.Clear();
+}
+
+string DocbookRenderer::ReferencesOf(FileDescriptor const *file) const
+{
+	DocbookContext const &ctx = m_impl->ctx;
+
+	string references;
+	for(int i = 0; i < file->message_type_count(); ++i)
+	{
+		AppendReferences(ctx, file->message_type(i), &references);
+	}
+	for(int i = 0; i < file->enum_type_count(); ++i)
+	{
+		references += ReferencesText(ctx, file->enum_type(i)) + "\n";
+	}
+	return references;
+}
+
+bool DocbookRenderer::WriteDocuments(
+	vector<pair<string, string> > const &sections,
+	std::map<string, string> *documents,
+	string *error)
+{
+	DocbookContext const &ctx = m_impl->ctx;
+	vector<pair<string, string> > trailing = MakeTrailingSections(ctx);
+	if(trailing.empty())
+	{
+		if(WriteSections(ctx, sections, documents, error) == false)
+		{
+			return false;
+		}
+	}
+	else
+	{
+		vector<pair<string, string> > withTrailing(sections);
+		withTrailing.insert(withTrailing.end(), trailing.begin(), trailing.end());
+		if(WriteSections(ctx, withTrailing, documents, error) == false)
+		{
+			return false;
+		}
+	}
+
+	if(ctx.lint)
+	{
+		(*documents)[ctx.docbookOutputFileName + LINT_REPORT_SUFFIX] = MakeLintReport(ctx);
+	}
+
+	if(ctx.olinkTargetsFileName.empty() == false)
+	{
+		(*documents)[ctx.olinkTargetsFileName] = MakeOlinkTargets(ctx);
+	}
+	return true;
+}
+
+namespace detail {
+
+struct GeneratorFunctions::Impl
+{
+	explicit Impl(std::map<string, string> const &options)
+		: ctx(options)
+	{
+	}
+
+	DocbookContext ctx;
+};
+
+GeneratorFunctions::GeneratorFunctions(std::map<string, string> const &options)
+	: m_impl(new Impl(options))
+{
+}
+
+GeneratorFunctions::~GeneratorFunctions()
+{
+	delete m_impl;
+}
+
+bool GeneratorFunctions::IndexFiles(
+	vector<FileDescriptor const *> const &files,
+	vector<string> *problems,
+	string *error)
+{
+	for(size_t i = 0; i < files.size(); ++i)
+	{
+		m_impl->ctx.comments.AddFile(files[i]);
+	}
+	return docbook::CheckLinks(m_impl->ctx, files, problems, error);
+}
+
+void GeneratorFunctions::SanitizeCommentForXML(
+	std::ostream &os, 
+	string const &comment) const
+{
+	docbook::SanitizeCommentForXML(m_impl->ctx, os, comment);
+}
+
+bool GeneratorFunctions::ParagraphFormatComment(
+	std::ostream &os, 
+	SourceCodeInfo_Location const *comment) const
+{
+	return docbook::ParagraphFormatComment(m_impl->ctx, os, comment);
+}
+
+void GeneratorFunctions::WriteDefaultValueString(
+	std::ostream &os, 
+	FieldDescriptor const *fd) const
+{
+	docbook::WriteDefaultValueString(m_impl->ctx, os, fd);
+}
+
+string GeneratorFunctions::MakeXLink(
+	void const *target,
+	string const &messageName, 
+	string const &displayName) const
+{
+	return docbook::MakeXLink(m_impl->ctx, target, messageName, displayName);
+}
+
+void GeneratorFunctions::WriteMessageInformalTableEntry(
+	std::ostringstream &os, 
+	string const &fieldname,
+	string const &type,
+	string const &occurrence,
+	FieldDescriptor const *fd,
+	SourceCodeInfo_Location const *comment,
+	bool alternateColor) const
+{
+	docbook::WriteMessageInformalTableEntry(
+		m_impl->ctx, os, fieldname, type, occurrence, fd, comment, alternateColor);
+}
+
+SourceCodeInfo_Location const *GeneratorFunctions::GetDescriptorComment(
+	FieldDescriptor const *fd) const
+{
+	return docbook::GetDescriptorComment(m_impl->ctx, fd);
+}
+
+bool HasDefaultValueString(FieldDescriptor const *fd)
+{
+	return docbook::HasDefaultValueString(fd);
+}
+
+}  // namespace detail
+
+}}}}  // end namespace
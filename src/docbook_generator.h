@@ -1,60 +1,220 @@
-// protoc-gen-docbook
-// http://code.google.com/p/protoc-gen-docbook/
-//
-// Redistribution and use in source and binary forms, with or without
-//// modification, are permitted provided that the following conditions are
-// met:
-//
-//     * Redistributions of source code must retain the above copyright
-// notice, this list of conditions and the following disclaimer.
-//     * Redistributions in binary form must reproduce the above
-// copyright notice, this list of conditions and the following disclaimer
-// in the documentation and/or other materials provided with the
-// distribution.
-//     * Neither the name of Google Inc. nor the names of its
-// contributors may be used to endorse or promote products derived from
-// this software without specific prior written permission.
-//
-// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
-// "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
-// LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
-// A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
-// OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
-// SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
-// LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
-// DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
-// THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
-// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
-// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
-//
-// Author: askldjd@gmail.com
-
-#ifndef GOOGLE_PROTOBUF_COMPILER_DOCBOOK_GENERATOR_H__
-#define GOOGLE_PROTOBUF_COMPILER_DOCBOOK_GENERATOR_H__
-
-#include <string>
-#include <google/protobuf/compiler/code_generator.h>
-#include <map>
-namespace google { namespace protobuf { namespace compiler {namespace docbook {
-
-	class LIBPROTOC_EXPORT DocbookGenerator : public CodeGenerator {
-	public:
-		DocbookGenerator();
-		~DocbookGenerator();
-
-		// implements CodeGenerator ----------------------------------------
-		bool Generate(const FileDescriptor* file,
-			const string& parameter,
-			GeneratorContext* context,
-			string* error) const;
-
-	private:
-		GOOGLE_DISALLOW_EVIL_CONSTRUCTORS(DocbookGenerator);
-	};
-
-}  // namespace docbook
-}  // namespace compiler
-}  // namespace protobuf
-
-}  // namespace google
-#endif  // GOOGLE_PROTOBUF_COMPILER_DOCBOOK_GENERATOR_H__
+// protoc-gen-docbook
+// http://code.google.com/p/protoc-gen-docbook/
+//
+// Redistribution and use in source and binary forms, with or without
+//// modification, are permitted provided that the following conditions are
+// met:
+//
+//     * Redistributions of source code must retain the above copyright
+// notice, this list of conditions and the following disclaimer.
+//     * Redistributions in binary form must reproduce the above
+// copyright notice, this list of conditions and the following disclaimer
+// in the documentation and/or other materials provided with the
+// distribution.
+//     * Neither the name of Google Inc. nor the names of its
+// contributors may be used to endorse or promote products derived from
+// this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+// "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+// LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+// A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+// OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+// SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+// LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+// DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+// THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//
+// Author: askldjd@gmail.com
+
+#ifndef GOOGLE_PROTOBUF_COMPILER_DOCBOOK_GENERATOR_H__
+#define GOOGLE_PROTOBUF_COMPILER_DOCBOOK_GENERATOR_H__
+
+#include <string>
+#include <vector>
+#include <google/protobuf/compiler/code_generator.h>
+#include <map>
+namespace google { namespace protobuf { namespace compiler {namespace docbook {
+
+	class LIBPROTOC_EXPORT DocbookGenerator : public CodeGenerator {
+	public:
+		DocbookGenerator();
+		~DocbookGenerator();
+
+		// implements CodeGenerator ----------------------------------------
+		bool Generate(const FileDescriptor* file,
+			const string& parameter,
+			GeneratorContext* context,
+			string* error) const;
+
+	private:
+		//! K/V pairs loaded from docbook.properties. Every run resolves its
+		//! own context from these, so the generator itself stays stateless.
+		std::map<string, string> m_docbookOptions;
+
+		GOOGLE_DISALLOW_EVIL_CONSTRUCTORS(DocbookGenerator);
+	};
+
+	//! @details
+	//! In-process API for tools that already hold the FileDescriptors in
+	//! memory, so they don't need to go through protoc and the plugin.
+	//!
+	//! The options are the same K/V pairs as docbook.properties. Every call
+	//! resolves its own context from them, so concurrent calls are safe as
+	//! long as the descriptors are not modified in the meantime.
+	//!
+	//! @param[in] files
+	//! The files to document, in document order.
+	//!
+	//! @param[in] options
+	//! K/V pairs, see docbook.properties.
+	//!
+	//! @param[out] documents
+	//! Generated documents keyed by their file name (e.g. docbook_out.xml).
+	//!
+	//! @param[out] error
+	//! Description of the problem if the generation fails.
+	//!
+	//! @return
+	//! true if success, false otherwise.
+	LIBPROTOC_EXPORT bool GenerateDocbook(
+		std::vector<FileDescriptor const *> const &files,
+		std::map<string, string> const &options,
+		std::map<string, string> *documents,
+		string *error);
+
+	//! @details
+	//! Same as above, but streams the generated document into output.
+	LIBPROTOC_EXPORT bool GenerateDocbook(
+		std::vector<FileDescriptor const *> const &files,
+		std::map<string, string> const &options,
+		io::ZeroCopyOutputStream *output,
+		string *error);
+
+	//! @details
+	//! Same as above, from the bytes of a serialized FileDescriptorSet 
+	//! (e.g. protoc --include_imports --descriptor_set_out). Each call builds
+	//! its own DescriptorPool.
+	//!
+	//! @param[in] filesToGenerate
+	//! Names of the files to document. If empty, every file in the set is
+	//! documented.
+	LIBPROTOC_EXPORT bool GenerateDocbookFromDescriptorSet(
+		string const &descriptorSet,
+		std::vector<string> const &filesToGenerate,
+		std::map<string, string> const &options,
+		std::map<string, string> *documents,
+		string *error);
+
+	//! @details
+	//! Combine the fragments written by the shards of a run (see the 
+	//! "shard" option) into the documents a single run would have written.
+	//! The options must be the ones of the shards, apart from "shard".
+	//!
+	//! @param[in] fragments
+	//! Contents of the fragment of every shard, keyed by a name used in
+	//! the errors (e.g. the path of the fragment).
+	LIBPROTOC_EXPORT bool MergeDocbookShards(
+		std::map<string, string> const &fragments,
+		std::map<string, string> const &options,
+		std::map<string, string> *documents,
+		string *error);
+
+	//! @details
+	//! Report the changes between two versions of a schema, each given as
+	//! the bytes of a serialized FileDescriptorSet (with 
+	//! --include_source_info to compare the comments too).
+	//!
+	//! Messages and enums are matched by full name, fields by number and
+	//! enum values by name, through hash tables, so the time is linear in
+	//! the size of the schemas. The report is a DocBook section that lists
+	//! the types that were added, removed or changed, with the same tables
+	//! as the regular output. A changed type only lists the fields or 
+	//! values that changed: rule, type, default, comment, name or number.
+	//!
+	//! With a custom template, the report goes to the "schema_changes"
+	//! insertion point.
+	LIBPROTOC_EXPORT bool GenerateDocbookDiff(
+		string const &oldDescriptorSet,
+		string const &newDescriptorSet,
+		std::map<string, string> const &options,
+		std::map<string, string> *documents,
+		string *error);
+
+	//! @details
+	//! Options the plugin would use for a run: docbook.properties from the
+	//! working directory, overridden by the comma separated k=v pairs of 
+	//! the parameter.
+	LIBPROTOC_EXPORT std::map<string, string> ResolveDocbookOptions(
+		string const &parameter);
+
+	//! @details
+	//! Incremental form of GenerateDocbook, for tools that regenerate the
+	//! same documents over and over (e.g. --watch). Each file is rendered
+	//! into a section of its own, and the caller keeps the sections, so only
+	//! the files that changed need to be rendered again.
+	//!
+	//! The options are resolved once, when the renderer is constructed. A
+	//! renderer must not be used from several threads at once.
+	class LIBPROTOC_EXPORT DocbookRenderer
+	{
+	public:
+		explicit DocbookRenderer(std::map<string, string> const &options);
+		~DocbookRenderer();
+
+		//! @details
+		//! Check the links between the files of a run. Must be called 
+		//! before their sections are rendered, and the descriptors must 
+		//! outlive the rendering. Problems are only returned, never printed.
+		//!
+		//! @return
+		//! false if there are problems and broken_links is "error".
+		bool CheckLinks(
+			std::vector<FileDescriptor const *> const &files,
+			std::vector<string> *problems,
+			string *error);
+
+		//! @details
+		//! Render the DocBook section of a single file. The section does 
+		//! not depend on the descriptor once it is rendered.
+		void RenderFile(FileDescriptor const *file, string *section);
+
+		//! @details
+		//! @return
+		//! The "Referenced by" lists of the types of a file, as of the last
+		//! CheckLinks, empty if include_referenced_by is off. They come 
+		//! from the files referring to these types, so the section of a 
+		//! file that did not change must still be rendered again when they
+		//! do.
+		string ReferencesOf(FileDescriptor const *file) const;
+
+		//! @details
+		//! Build the documents out of rendered sections. With lint or 
+		//! include_cpp_size, the descriptors given to CheckLinks must still
+		//! be alive.
+		//!
+		//! @param[in] sections
+		//! (file name, section) pairs in document order.
+		//!
+		//! @param[out] documents
+		//! Generated documents keyed by their file name.
+		bool WriteDocuments(
+			std::vector<std::pair<string, string> > const &sections,
+			std::map<string, string> *documents,
+			string *error);
+
+	private:
+		struct Impl;
+		Impl *m_impl;
+
+		GOOGLE_DISALLOW_EVIL_CONSTRUCTORS(DocbookRenderer);
+	};
+
+}  // namespace docbook
+}  // namespace compiler
+}  // namespace protobuf
+
+}  // namespace google
+#endif  // GOOGLE_PROTOBUF_COMPILER_DOCBOOK_GENERATOR_H__
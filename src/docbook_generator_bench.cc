@@ -0,0 +1,644 @@
+// protoc-gen-docbook
+// http://code.google.com/p/protoc-gen-docbook/
+//
+// Redistribution and use in source and binary forms, with or without
+//// modification, are permitted provided that the following conditions are
+// met:
+//
+//     * Redistributions of source code must retain the above copyright
+// notice, this list of conditions and the following disclaimer.
+//     * Redistributions in binary form must reproduce the above
+// copyright notice, this list of conditions and the following disclaimer
+// in the documentation and/or other materials provided with the
+// distribution.
+//     * Neither the name of Google Inc. nor the names of its
+// contributors may be used to endorse or promote products derived from
+// this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+// "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+// LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+// A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+// OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+// SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+// LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+// DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+// THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//
+// Author: askldjd@gmail.com
+//
+// Microbenchmarks of the hot functions of the generator, measured directly
+// over a synthetic .proto with a realistic mix of comments (short, long,
+// heavy on XML escaping, missing) and default values. Linux only.
+//
+// usage: protoc-gen-docbook-bench [--filter=TEXT] [--repetitions=N] 
+//                                 [--save=FILE] [--baseline=FILE]
+//
+//   --filter       only run the benchmarks whose name contains TEXT.
+//   --repetitions  number of timed batches per benchmark [default = 15]
+//   --save         write the results to FILE, to compare later runs to.
+//   --baseline     compare the results to the ones saved in FILE.
+//
+
+#include "docbook_generator_internal.h"
+#include <google/protobuf/descriptor.h>
+#include <google/protobuf/descriptor.pb.h>
+#include <google/protobuf/stubs/strutil.h>
+#include <time.h>
+#include <cstdio>
+#include <cstdlib>
+#include <algorithm>
+#include <fstream>
+#include <iostream>
+#include <map>
+#include <sstream>
+#include <string>
+#include <vector>
+
+namespace google { namespace protobuf { namespace compiler { namespace docbook {
+
+namespace {
+
+	//! @details
+	//! Deterministic pseudo-random numbers, so that every run measures the
+	//! same input.
+	class Random
+	{
+	public:
+		explicit Random(uint32 seed)
+			: m_state(seed)
+		{
+		}
+
+		//! @return
+		//! A number in [0, n).
+		int Uniform(int n)
+		{
+			m_state = m_state * 1664525u + 1013904223u;
+			return static_cast<int>((m_state >> 8) % static_cast<uint32>(n));
+		}
+
+	private:
+		uint32 m_state;
+	};
+
+	char const *WORDS[] = 
+	{
+		"the", "request", "identifier", "of", "a", "session", "is", "unique",
+		"timestamp", "in", "milliseconds", "since", "epoch", "must", "be", 
+		"set", "when", "server", "returns", "an", "error", "code", "optional",
+		"deprecated", "use", "instead", "value", "list", "entries", "sorted"
+	};
+
+	//! Words that need escaping once written as XML.
+	char const *ESCAPED_WORDS[] = 
+	{
+		"a<b", "x & y", "\"quoted\"", "it's", "<tag>", "->", "&amp;", "1 < 2 > 0"
+	};
+
+	int const WORD_COUNT = sizeof(WORDS) / sizeof(WORDS[0]);
+	int const ESCAPED_WORD_COUNT = sizeof(ESCAPED_WORDS) / sizeof(ESCAPED_WORDS[0]);
+
+	string MakeWords(Random &random, int count, int escapedPercent)
+	{
+		string text;
+		for(int i = 0; i < count; ++i)
+		{
+			text += (i % 12 == 11) ? "\n " : " ";
+			if(random.Uniform(100) < escapedPercent)
+				text += ESCAPED_WORDS[random.Uniform(ESCAPED_WORD_COUNT)];
+			else
+				text += WORDS[random.Uniform(WORD_COUNT)];
+		}
+		return text;
+	}
+
+	//! @details
+	//! A comment as found in real schemas: 20% none, 40% short, 25% long
+	//! over several lines, 15% heavy on characters XML must escape.
+	//!
+	//! @return
+	//! false if the field has no comment.
+	bool MakeComment(Random &random, string *comment)
+	{
+		int kind = random.Uniform(100);
+		if(kind < 20)
+			return false;
+		else if(kind < 60)
+			*comment = MakeWords(random, 3 + random.Uniform(8), 2);
+		else if(kind < 85)
+			*comment = MakeWords(random, 40 + random.Uniform(80), 2);
+		else
+			*comment = MakeWords(random, 10 + random.Uniform(20), 40);
+		return true;
+	}
+
+	int const MESSAGE_COUNT = 250;
+	int const FIELDS_PER_MESSAGE = 20;
+
+	//! @details
+	//! Sets the type, and in 60% of the cases the default value, of a 
+	//! field of message m.
+	void MakeFieldType(Random &random, int m, FieldDescriptorProto *field)
+	{
+		bool withDefault = random.Uniform(100) < 60;
+		switch(random.Uniform(10))
+		{
+		case 0:
+		case 1:
+			field->set_type(FieldDescriptorProto::TYPE_MESSAGE);
+			field->set_type_name(".bench.Message" + 
+				SimpleItoa((m + 1 + random.Uniform(MESSAGE_COUNT - 1)) % MESSAGE_COUNT));
+			return;
+		case 2:
+			field->set_type(FieldDescriptorProto::TYPE_ENUM);
+			field->set_type_name(".bench.Color");
+			if(withDefault)
+				field->set_default_value("GREEN");
+			return;
+		case 3:
+			field->set_type(FieldDescriptorProto::TYPE_STRING);
+			if(withDefault)
+				field->set_default_value(random.Uniform(2) ? "unknown" : "<none> & \"n/a\"");
+			return;
+		case 4:
+			field->set_type(FieldDescriptorProto::TYPE_INT64);
+			if(withDefault)
+				field->set_default_value("-9000000000");
+			return;
+		case 5:
+			field->set_type(FieldDescriptorProto::TYPE_DOUBLE);
+			if(withDefault)
+				field->set_default_value("0.125");
+			return;
+		case 6:
+			field->set_type(FieldDescriptorProto::TYPE_BOOL);
+			if(withDefault)
+				field->set_default_value("true");
+			return;
+		case 7:
+			field->set_type(FieldDescriptorProto::TYPE_BYTES);
+			if(withDefault)
+				field->set_default_value("\\001\\002abc");
+			return;
+		default:
+			field->set_type(FieldDescriptorProto::TYPE_INT32);
+			if(withDefault)
+				field->set_default_value(SimpleItoa(random.Uniform(100000)));
+			return;
+		}
+	}
+
+	void MakeBenchFile(FileDescriptorProto *proto)
+	{
+		Random random(12345);
+		proto->set_name("bench.proto");
+		proto->set_package("bench");
+
+		EnumDescriptorProto *color = proto->add_enum_type();
+		color->set_name("Color");
+		char const *colors[] = { "RED", "GREEN", "BLUE" };
+		for(int i = 0; i < 3; ++i)
+		{
+			color->add_value()->set_name(colors[i]);
+			color->mutable_value(i)->set_number(i);
+		}
+
+		SourceCodeInfo *info = proto->mutable_source_code_info();
+		for(int m = 0; m < MESSAGE_COUNT; ++m)
+		{
+			DescriptorProto *message = proto->add_message_type();
+			message->set_name("Message" + SimpleItoa(m));
+
+			for(int f = 0; f < FIELDS_PER_MESSAGE; ++f)
+			{
+				FieldDescriptorProto *field = message->add_field();
+				field->set_name("field_" + SimpleItoa(f));
+				field->set_number(f + 1);
+				field->set_label(FieldDescriptorProto::LABEL_OPTIONAL);
+				MakeFieldType(random, m, field);
+
+				string comment;
+				if(MakeComment(random, &comment))
+				{
+					SourceCodeInfo_Location *location = info->add_location();
+					location->add_path(FileDescriptorProto::kMessageTypeFieldNumber);
+					location->add_path(m);
+					location->add_path(DescriptorProto::kFieldFieldNumber);
+					location->add_path(f);
+					location->add_span(m * FIELDS_PER_MESSAGE + f);
+					location->add_span(0);
+					location->add_span(10);
+					location->set_leading_comments(comment);
+				}
+			}
+		}
+	}
+
+	//! @details
+	//! Everything the benchmarks feed the functions with, built once.
+	struct BenchInput
+	{
+		BenchInput()
+			: functions(std::map<string, string>())
+			, file(NULL)
+		{
+			FileDescriptorProto proto;
+			MakeBenchFile(&proto);
+			file = pool.BuildFile(proto);
+			GOOGLE_CHECK(file != NULL);
+
+			vector<FileDescriptor const *> files(1, file);
+			vector<string> problems;
+			string error;
+			functions.IndexFiles(files, &problems, &error);
+
+			for(int m = 0; m < file->message_type_count(); ++m)
+			{
+				Descriptor const *message = file->message_type(m);
+				for(int f = 0; f < message->field_count(); ++f)
+				{
+					FieldDescriptor const *fd = message->field(f);
+					fields.push_back(fd);
+
+					SourceCodeInfo_Location const *comment = 
+						functions.GetDescriptorComment(fd);
+					locations.push_back(comment);
+					if(comment != NULL)
+						comments.push_back(comment->leading_comments());
+					if(detail::HasDefaultValueString(fd))
+						defaults.push_back(fd);
+					if(fd->type() == FieldDescriptor::TYPE_MESSAGE)
+						links.push_back(fd);
+				}
+			}
+		}
+
+		DescriptorPool pool;
+		detail::GeneratorFunctions functions;
+		FileDescriptor const *file;
+
+		vector<FieldDescriptor const *> fields;
+		vector<SourceCodeInfo_Location const *> locations;
+		vector<string> comments;
+		vector<FieldDescriptor const *> defaults;
+		vector<FieldDescriptor const *> links;
+	};
+
+	//! @details
+	//! One function under test. Run(i) makes the i-th call, cycling 
+	//! through the input.
+	class Benchmark
+	{
+	public:
+		Benchmark(char const *name, BenchInput const &input)
+			: m_name(name)
+			, m_input(input)
+			, m_bytes(0)
+		{
+		}
+
+		virtual ~Benchmark()
+		{
+		}
+
+		char const *Name() const
+		{
+			return m_name;
+		}
+
+		virtual void Run(size_t i) = 0;
+
+		//! @details
+		//! Bytes written by the calls so far.
+		int64 TakeBytes()
+		{
+			m_bytes += m_os.str().size();
+			m_os.str(string());
+
+			int64 bytes = m_bytes;
+			m_bytes = 0;
+			return bytes;
+		}
+
+	protected:
+		//! @details
+		//! The stream to write to. Emptied every few calls so that it 
+		//! stays in cache, like the stream of a message being rendered.
+		std::ostringstream &Stream(size_t i)
+		{
+			if((i & 63) == 0)
+			{
+				m_bytes += m_os.str().size();
+				m_os.str(string());
+			}
+			return m_os;
+		}
+
+		void Produced(size_t bytes)
+		{
+			m_bytes += bytes;
+		}
+
+		char const *m_name;
+		BenchInput const &m_input;
+		std::ostringstream m_os;
+		int64 m_bytes;
+	};
+
+	class SanitizeBench : public Benchmark
+	{
+	public:
+		explicit SanitizeBench(BenchInput const &input)
+			: Benchmark("SanitizeCommentForXML", input)
+		{
+		}
+
+		void Run(size_t i)
+		{
+			m_input.functions.SanitizeCommentForXML(Stream(i), 
+				m_input.comments[i % m_input.comments.size()]);
+		}
+	};
+
+	class ParagraphBench : public Benchmark
+	{
+	public:
+		explicit ParagraphBench(BenchInput const &input)
+			: Benchmark("ParagraphFormatComment", input)
+		{
+		}
+
+		void Run(size_t i)
+		{
+			m_input.functions.ParagraphFormatComment(Stream(i), 
+				m_input.locations[i % m_input.locations.size()]);
+		}
+	};
+
+	class DefaultValueBench : public Benchmark
+	{
+	public:
+		explicit DefaultValueBench(BenchInput const &input)
+			: Benchmark("WriteDefaultValueString", input)
+		{
+		}
+
+		void Run(size_t i)
+		{
+			m_input.functions.WriteDefaultValueString(Stream(i), 
+				m_input.defaults[i % m_input.defaults.size()]);
+		}
+	};
+
+	class XLinkBench : public Benchmark
+	{
+	public:
+		explicit XLinkBench(BenchInput const &input)
+			: Benchmark("MakeXLink", input)
+		{
+		}
+
+		void Run(size_t i)
+		{
+			Descriptor const *target = 
+				m_input.links[i % m_input.links.size()]->message_type();
+			Produced(m_input.functions.MakeXLink(
+				target, target->full_name(), target->name()).size());
+		}
+	};
+
+	class TableEntryBench : public Benchmark
+	{
+	public:
+		explicit TableEntryBench(BenchInput const &input)
+			: Benchmark("WriteMessageInformalTableEntry", input)
+			, m_typeName("<emphasis role=\"underline\" xlink:href=\"#bench_Message1\">Message1</emphasis>")
+		{
+		}
+
+		void Run(size_t i)
+		{
+			size_t index = i % m_input.fields.size();
+			m_input.functions.WriteMessageInformalTableEntry(
+				Stream(i), 
+				m_input.fields[index]->name(),
+				m_typeName,
+				"optional",
+				m_input.fields[index],
+				m_input.locations[index],
+				(i & 1) != 0);
+		}
+
+	private:
+		string m_typeName;
+	};
+
+	class CommentLookupBench : public Benchmark
+	{
+	public:
+		explicit CommentLookupBench(BenchInput const &input)
+			: Benchmark("GetDescriptorComment", input)
+			, m_found(0)
+		{
+		}
+
+		void Run(size_t i)
+		{
+			if(m_input.functions.GetDescriptorComment(
+				m_input.fields[i % m_input.fields.size()]) != NULL)
+				++m_found;
+		}
+
+		//! Keeps the lookups from being optimized away.
+		volatile size_t m_found;
+	};
+
+	double Now()
+	{
+		timespec now;
+		clock_gettime(CLOCK_MONOTONIC, &now);
+		return now.tv_sec + now.tv_nsec * 1e-9;
+	}
+
+	//! @details
+	//! Batches are sized to take at least this long, so that the clock 
+	//! resolution does not matter.
+	double const MIN_BATCH_SECONDS = 0.02;
+
+	struct Result
+	{
+		Result()
+			: nsPerCall(0)
+			, spread(0)
+			, bytesPerSecond(0)
+		{
+		}
+
+		string name;
+
+		//! Median over the repetitions.
+		double nsPerCall;
+
+		//! (slowest - fastest) / median of the repetitions.
+		double spread;
+
+		double bytesPerSecond;
+	};
+
+	double TimeBatch(Benchmark &bench, size_t calls, size_t *next)
+	{
+		double start = Now();
+		for(size_t i = 0; i < calls; ++i)
+		{
+			bench.Run((*next)++);
+		}
+		return Now() - start;
+	}
+
+	Result Measure(Benchmark &bench, int repetitions)
+	{
+		size_t next = 0;
+
+		// Warm up, and find the batch size.
+		size_t calls = 1000;
+		while(TimeBatch(bench, calls, &next) < MIN_BATCH_SECONDS)
+		{
+			calls *= 2;
+		}
+		bench.TakeBytes();
+
+		vector<double> nsPerCall;
+		double seconds = 0;
+		for(int r = 0; r < repetitions; ++r)
+		{
+			double elapsed = TimeBatch(bench, calls, &next);
+			seconds += elapsed;
+			nsPerCall.push_back(elapsed * 1e9 / calls);
+		}
+		int64 bytes = bench.TakeBytes();
+
+		std::sort(nsPerCall.begin(), nsPerCall.end());
+		Result result;
+		result.name = bench.Name();
+		result.nsPerCall = nsPerCall[nsPerCall.size() / 2];
+		result.spread = (nsPerCall.back() - nsPerCall.front()) / result.nsPerCall;
+		result.bytesPerSecond = bytes / seconds;
+		return result;
+	}
+
+	//! @details
+	//! Baseline file: one "name ns_per_call bytes_per_second" line per 
+	//! benchmark.
+	std::map<string, double> LoadBaseline(string const &fileName)
+	{
+		std::map<string, double> baseline;
+		std::ifstream in(fileName.c_str());
+		string name;
+		double nsPerCall = 0;
+		double bytesPerSecond = 0;
+		while(in >> name >> nsPerCall >> bytesPerSecond)
+		{
+			baseline[name] = nsPerCall;
+		}
+		return baseline;
+	}
+
+	bool SaveResults(string const &fileName, vector<Result> const &results)
+	{
+		std::ofstream out(fileName.c_str());
+		for(size_t i = 0; i < results.size(); ++i)
+		{
+			out 
+				<< results[i].name << " " << results[i].nsPerCall << " " 
+				<< results[i].bytesPerSecond << "\n";
+		}
+		return out.good();
+	}
+
+	void PrintResult(Result const &result, std::map<string, double> const &baseline)
+	{
+		std::printf("%-32s %10.1f %7.1f%% %10.1f", 
+			result.name.c_str(), result.nsPerCall, result.spread * 100, 
+			result.bytesPerSecond / (1024 * 1024));
+
+		std::map<string, double>::const_iterator itr = baseline.find(result.name);
+		if(itr != baseline.end() && itr->second > 0)
+		{
+			std::printf(" %+9.1f%%", (result.nsPerCall / itr->second - 1) * 100);
+		}
+		std::printf("\n");
+	}
+
+} // end anonymous namespace
+
+}}}}  // end namespace
+
+int main(int argc, char *argv[])
+{
+	using namespace google::protobuf::compiler::docbook;
+
+	std::string filter;
+	std::string saveFile;
+	std::string baselineFile;
+	int repetitions = 15;
+
+	for(int i = 1; i < argc; ++i)
+	{
+		std::string arg = argv[i];
+		if(arg.compare(0, 9, "--filter=") == 0)
+			filter = arg.substr(9);
+		else if(arg.compare(0, 14, "--repetitions=") == 0)
+			repetitions = std::max(1, std::atoi(arg.substr(14).c_str()));
+		else if(arg.compare(0, 7, "--save=") == 0)
+			saveFile = arg.substr(7);
+		else if(arg.compare(0, 11, "--baseline=") == 0)
+			baselineFile = arg.substr(11);
+		else
+		{
+			std::cerr << "Unknown option: " << arg << std::endl;
+			return 1;
+		}
+	}
+
+	BenchInput input;
+	std::map<std::string, double> baseline;
+	if(baselineFile.empty() == false)
+	{
+		baseline = LoadBaseline(baselineFile);
+	}
+
+	SanitizeBench sanitize(input);
+	ParagraphBench paragraph(input);
+	DefaultValueBench defaultValue(input);
+	XLinkBench xlink(input);
+	TableEntryBench tableEntry(input);
+	CommentLookupBench commentLookup(input);
+	Benchmark *benchmarks[] = 
+	{
+		&sanitize, &paragraph, &defaultValue, &xlink, &tableEntry, &commentLookup
+	};
+
+	std::printf("%-32s %10s %8s %10s %10s\n", 
+		"benchmark", "ns/call", "spread", "MB/s", 
+		baseline.empty() ? "" : "vs base");
+
+	std::vector<Result> results;
+	for(size_t i = 0; i < sizeof(benchmarks) / sizeof(benchmarks[0]); ++i)
+	{
+		if(std::string(benchmarks[i]->Name()).find(filter) == std::string::npos)
+			continue;
+
+		results.push_back(Measure(*benchmarks[i], repetitions));
+		PrintResult(results.back(), baseline);
+	}
+
+	if(saveFile.empty() == false && SaveResults(saveFile, results) == false)
+	{
+		std::cerr << saveFile << ": Unable to save the results." << std::endl;
+		return 1;
+	}
+	return 0;
+}
@@ -0,0 +1,115 @@
+// protoc-gen-docbook
+// http://code.google.com/p/protoc-gen-docbook/
+//
+// Redistribution and use in source and binary forms, with or without
+//// modification, are permitted provided that the following conditions are
+// met:
+//
+//     * Redistributions of source code must retain the above copyright
+// notice, this list of conditions and the following disclaimer.
+//     * Redistributions in binary form must reproduce the above
+// copyright notice, this list of conditions and the following disclaimer
+// in the documentation and/or other materials provided with the
+// distribution.
+//     * Neither the name of Google Inc. nor the names of its
+// contributors may be used to endorse or promote products derived from
+// this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+// "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+// LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+// A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+// OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+// SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+// LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+// DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+// THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//
+// Author: askldjd@gmail.com
+//
+// The hot functions of the generator, exposed for the microbenchmarks in
+// docbook_generator_bench.cc so that they can be measured without 
+// compiling the generator into the benchmark. Not part of the API: the
+// signatures follow the ones inside docbook_generator.cc.
+//
+
+#ifndef DOCBOOK_GENERATOR_INTERNAL_H__
+#define DOCBOOK_GENERATOR_INTERNAL_H__
+
+#include <google/protobuf/descriptor.h>
+#include <google/protobuf/descriptor.pb.h>
+#include <map>
+#include <ostream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+namespace google { namespace protobuf { namespace compiler {namespace docbook {
+
+namespace detail {
+
+	//! @details
+	//! The context of a run, resolved from its options, and the functions
+	//! that render with it. Each function forwards to the generator's 
+	//! function of the same name.
+	class GeneratorFunctions
+	{
+	public:
+		explicit GeneratorFunctions(std::map<string, string> const &options);
+		~GeneratorFunctions();
+
+		//! @details
+		//! Index the comments and the ids of the files, as a run does 
+		//! before rendering. The descriptors must outlive the calls below.
+		//!
+		//! @return
+		//! false if there are problems and broken_links is "error".
+		bool IndexFiles(
+			std::vector<FileDescriptor const *> const &files,
+			std::vector<string> *problems,
+			string *error);
+
+		void SanitizeCommentForXML(std::ostream &os, string const &comment) const;
+
+		bool ParagraphFormatComment(
+			std::ostream &os, 
+			SourceCodeInfo_Location const *comment) const;
+
+		void WriteDefaultValueString(std::ostream &os, FieldDescriptor const *fd) const;
+
+		string MakeXLink(
+			void const *target,
+			string const &messageName, 
+			string const &displayName) const;
+
+		void WriteMessageInformalTableEntry(
+			std::ostringstream &os, 
+			string const &fieldname,
+			string const &type,
+			string const &occurrence,
+			FieldDescriptor const *fd,
+			SourceCodeInfo_Location const *comment,
+			bool alternateColor) const;
+
+		SourceCodeInfo_Location const *GetDescriptorComment(
+			FieldDescriptor const *fd) const;
+
+	private:
+		struct Impl;
+		Impl *m_impl;
+
+		GOOGLE_DISALLOW_EVIL_CONSTRUCTORS(GeneratorFunctions);
+	};
+
+	bool HasDefaultValueString(FieldDescriptor const *fd);
+
+}  // namespace detail
+
+}  // namespace docbook
+}  // namespace compiler
+}  // namespace protobuf
+}  // namespace google
+
+#endif // DOCBOOK_GENERATOR_INTERNAL_H__
@@ -0,0 +1,75 @@
+// protoc-gen-docbook
+// http://code.google.com/p/protoc-gen-docbook/
+//
+// Redistribution and use in source and binary forms, with or without
+//// modification, are permitted provided that the following conditions are
+// met:
+//
+//     * Redistributions of source code must retain the above copyright
+// notice, this list of conditions and the following disclaimer.
+//     * Redistributions in binary form must reproduce the above
+// copyright notice, this list of conditions and the following disclaimer
+// in the documentation and/or other materials provided with the
+// distribution.
+//     * Neither the name of Google Inc. nor the names of its
+// contributors may be used to endorse or promote products derived from
+// this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+// "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+// LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+// A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+// OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+// SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+// LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+// DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+// THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//
+// Author: askldjd@gmail.com
+//
+// Deals with the fact that the hash table lives in a different place on
+// each toolchain. protobuf has the same helper in stubs/hash.h, but that
+// one depends on protobuf's build-time config.h and is not part of the
+// installed headers.
+//
+
+#ifndef DOCBOOK_HASH_H__
+#define DOCBOOK_HASH_H__
+
+#if __cplusplus >= 201103L || (defined(_MSC_VER) && _MSC_VER >= 1600)
+#include <unordered_map>
+#include <unordered_set>
+#define DBK_HASH_NAMESPACE std
+#elif defined(_MSC_VER)
+// Visual Studio 2008 SP1 ships TR1 under <unordered_map>.
+#include <unordered_map>
+#include <unordered_set>
+#define DBK_HASH_NAMESPACE std::tr1
+#else
+#include <tr1/unordered_map>
+#include <tr1/unordered_set>
+#define DBK_HASH_NAMESPACE std::tr1
+#endif
+
+namespace google { namespace protobuf { namespace compiler {namespace docbook {
+
+	template <typename Key, typename Data,
+		typename HashFcn = DBK_HASH_NAMESPACE::hash<Key> >
+	class hash_map : public DBK_HASH_NAMESPACE::unordered_map<Key, Data, HashFcn>
+	{
+	};
+
+	template <typename Key, 
+		typename HashFcn = DBK_HASH_NAMESPACE::hash<Key> >
+	class hash_set : public DBK_HASH_NAMESPACE::unordered_set<Key, HashFcn>
+	{
+	};
+
+}  // namespace docbook
+}  // namespace compiler
+}  // namespace protobuf
+}  // namespace google
+
+#endif // DOCBOOK_HASH_H__
@@ -0,0 +1,273 @@
+// protoc-gen-docbook
+// http://code.google.com/p/protoc-gen-docbook/
+//
+// Redistribution and use in source and binary forms, with or without
+//// modification, are permitted provided that the following conditions are
+// met:
+//
+//     * Redistributions of source code must retain the above copyright
+// notice, this list of conditions and the following disclaimer.
+//     * Redistributions in binary form must reproduce the above
+// copyright notice, this list of conditions and the following disclaimer
+// in the documentation and/or other materials provided with the
+// distribution.
+//     * Neither the name of Google Inc. nor the names of its
+// contributors may be used to endorse or promote products derived from
+// this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+// "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+// LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+// A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+// OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+// SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+// LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+// DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+// THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//
+// Author: askldjd@gmail.com
+//
+// Replacement global operator new/delete used by the allocation profiling
+// build. Every block carries a small header that records its size and the
+// phase it was allocated in, so that frees are charged back to the phase
+// that made the allocation and per-phase live/peak bytes stay accurate.
+//
+// This file only uses malloc/free and GCC atomic builtins, so it works on
+// a plain Linux box without any external profiler installed.
+//
+
+#include "docbook_heap_profile.h"
+
+#ifdef DBK_HEAP_PROFILE
+
+#include <cstdio>
+#include <cstdlib>
+#include <new>
+
+namespace google { namespace protobuf { namespace compiler { namespace docbook {
+
+namespace {
+
+	//! @details
+	//! Header placed in front of every block handed out by operator new.
+	//! It is padded to 16 bytes so the user pointer keeps malloc alignment.
+	struct BlockHeader
+	{
+		size_t size;
+		size_t phase;
+	};
+
+	//! @details
+	//! Counters kept for each phase. All of them are updated with atomic
+	//! builtins because generation may run on several threads.
+	struct PhaseCounters
+	{
+		size_t allocations;
+		size_t frees;
+		size_t bytesAllocated;
+		size_t liveBytes;
+		size_t peakLiveBytes;
+	};
+
+	char const *s_phaseNames[NUM_HEAP_PHASES] = {
+		"startup",
+		"descriptor pool build",
+		"comment handling",
+		"row writers",
+		"final write"
+	};
+
+	PhaseCounters s_phaseCounters[NUM_HEAP_PHASES];
+
+	size_t s_totalLiveBytes = 0;
+	size_t s_totalPeakLiveBytes = 0;
+
+	//! @details
+	//! Phase of the calling thread. Threads start in the startup phase and
+	//! move along as the generator marks its progress.
+	__thread int s_currentPhase = HEAP_PHASE_STARTUP;
+
+	void UpdatePeak(size_t *peak, size_t value)
+	{
+		size_t seen = *peak;
+		while(value > seen)
+		{
+			size_t previous = __sync_val_compare_and_swap(peak, seen, value);
+			if(previous == seen)
+				break;
+			seen = previous;
+		}
+	}
+
+	void *ProfiledAlloc(size_t size)
+	{
+		BlockHeader *header = 
+			static_cast<BlockHeader *>(std::malloc(sizeof(BlockHeader) + size));
+		if(header == NULL)
+			return NULL;
+
+		int phase = s_currentPhase;
+		header->size = size;
+		header->phase = phase;
+
+		PhaseCounters &counters = s_phaseCounters[phase];
+		__sync_fetch_and_add(&counters.allocations, 1);
+		__sync_fetch_and_add(&counters.bytesAllocated, size);
+		UpdatePeak(
+			&counters.peakLiveBytes, 
+			__sync_add_and_fetch(&counters.liveBytes, size));
+		UpdatePeak(
+			&s_totalPeakLiveBytes, 
+			__sync_add_and_fetch(&s_totalLiveBytes, size));
+
+		return header + 1;
+	}
+
+	void ProfiledFree(void *ptr)
+	{
+		if(ptr == NULL)
+			return;
+
+		BlockHeader *header = static_cast<BlockHeader *>(ptr) - 1;
+
+		PhaseCounters &counters = s_phaseCounters[header->phase];
+		__sync_fetch_and_add(&counters.frees, 1);
+		__sync_fetch_and_sub(&counters.liveBytes, header->size);
+		__sync_fetch_and_sub(&s_totalLiveBytes, header->size);
+
+		std::free(header);
+	}
+
+	void *ProfiledNew(size_t size)
+	{
+		void *ptr = ProfiledAlloc(size);
+		if(ptr == NULL)
+			throw std::bad_alloc();
+		return ptr;
+	}
+
+	//! @details
+	//! Prints the report when static objects are torn down at exit. 
+	//! Only stdio is used here since iostreams may already be gone, and
+	//! stdout is reserved for the plugin response.
+	struct HeapProfileReporter
+	{
+		~HeapProfileReporter()
+		{
+			size_t totalAllocations = 0;
+			size_t totalBytes = 0;
+
+			std::fprintf(stderr, 
+				"protoc-gen-docbook heap profile\n"
+				"%-24s %12s %12s %16s %16s %16s\n",
+				"phase", "allocs", "frees", "bytes", "live bytes", 
+				"peak live bytes");
+
+			for(int i = 0; i < NUM_HEAP_PHASES; ++i)
+			{
+				PhaseCounters const &counters = s_phaseCounters[i];
+				std::fprintf(stderr, 
+					"%-24s %12lu %12lu %16lu %16lu %16lu\n",
+					s_phaseNames[i],
+					(unsigned long)counters.allocations,
+					(unsigned long)counters.frees,
+					(unsigned long)counters.bytesAllocated,
+					(unsigned long)counters.liveBytes,
+					(unsigned long)counters.peakLiveBytes);
+
+				totalAllocations += counters.allocations;
+				totalBytes += counters.bytesAllocated;
+			}
+
+			std::fprintf(stderr, 
+				"%-24s %12lu %12s %16lu %16lu %16lu\n",
+				"total",
+				(unsigned long)totalAllocations,
+				"",
+				(unsigned long)totalBytes,
+				(unsigned long)s_totalLiveBytes,
+				(unsigned long)s_totalPeakLiveBytes);
+		}
+	};
+
+	HeapProfileReporter s_heapProfileReporter;
+
+} // end anonymous namespace
+
+void SetHeapProfilePhase(HeapProfilePhase phase)
+{
+	s_currentPhase = phase;
+}
+
+HeapProfileScope::HeapProfileScope(HeapProfilePhase phase)
+	: m_previous(static_cast<HeapProfilePhase>(s_currentPhase))
+{
+	s_currentPhase = phase;
+}
+
+HeapProfileScope::~HeapProfileScope()
+{
+	s_currentPhase = m_previous;
+}
+
+}}}}  // end namespace
+
+using google::protobuf::compiler::docbook::ProfiledNew;
+using google::protobuf::compiler::docbook::ProfiledAlloc;
+using google::protobuf::compiler::docbook::ProfiledFree;
+
+void *operator new(size_t size)
+{
+	return ProfiledNew(size);
+}
+
+void *operator new[](size_t size)
+{
+	return ProfiledNew(size);
+}
+
+void *operator new(size_t size, std::nothrow_t const &) throw()
+{
+	return ProfiledAlloc(size);
+}
+
+void *operator new[](size_t size, std::nothrow_t const &) throw()
+{
+	return ProfiledAlloc(size);
+}
+
+void operator delete(void *ptr) throw()
+{
+	ProfiledFree(ptr);
+}
+
+void operator delete[](void *ptr) throw()
+{
+	ProfiledFree(ptr);
+}
+
+void operator delete(void *ptr, std::nothrow_t const &) throw()
+{
+	ProfiledFree(ptr);
+}
+
+void operator delete[](void *ptr, std::nothrow_t const &) throw()
+{
+	ProfiledFree(ptr);
+}
+
+#if __cplusplus >= 201402L
+void operator delete(void *ptr, size_t) throw()
+{
+	ProfiledFree(ptr);
+}
+
+void operator delete[](void *ptr, size_t) throw()
+{
+	ProfiledFree(ptr);
+}
+#endif
+
+#endif // DBK_HEAP_PROFILE
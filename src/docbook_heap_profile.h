@@ -0,0 +1,111 @@
+// protoc-gen-docbook
+// http://code.google.com/p/protoc-gen-docbook/
+//
+// Redistribution and use in source and binary forms, with or without
+//// modification, are permitted provided that the following conditions are
+// met:
+//
+//     * Redistributions of source code must retain the above copyright
+// notice, this list of conditions and the following disclaimer.
+//     * Redistributions in binary form must reproduce the above
+// copyright notice, this list of conditions and the following disclaimer
+// in the documentation and/or other materials provided with the
+// distribution.
+//     * Neither the name of Google Inc. nor the names of its
+// contributors may be used to endorse or promote products derived from
+// this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+// "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+// LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+// A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+// OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+// SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+// LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+// DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+// THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//
+// Author: askldjd@gmail.com
+//
+// Allocation profiling hooks. When the plugin is built with
+// DBK_HEAP_PROFILE defined (see the "heapprof" target in linux/makefile),
+// the global operator new/delete are replaced and every allocation is
+// attributed to the generation phase that was active when it was made.
+// A report is printed to stderr when the process exits.
+//
+// In a normal build, the phase markers below compile to nothing.
+//
+
+#ifndef DOCBOOK_HEAP_PROFILE_H__
+#define DOCBOOK_HEAP_PROFILE_H__
+
+namespace google { namespace protobuf { namespace compiler {namespace docbook {
+
+	//! @details
+	//! Generation phases that allocations are attributed to.
+	enum HeapProfilePhase
+	{
+		//! Static initialization and docbook.properties loading.
+		HEAP_PHASE_STARTUP = 0,
+
+		//! Reading the CodeGeneratorRequest and building the DescriptorPool.
+		HEAP_PHASE_DESCRIPTOR_POOL,
+
+		//! Extracting, sanitizing and formatting comments.
+		HEAP_PHASE_COMMENTS,
+
+		//! Section, table and row writers.
+		HEAP_PHASE_ROW_WRITERS,
+
+		//! Writing the accumulated DocBook into the GeneratorContext and
+		//! serializing the response.
+		HEAP_PHASE_FINAL_WRITE,
+
+		NUM_HEAP_PHASES
+	};
+
+#ifdef DBK_HEAP_PROFILE
+
+	//! @details
+	//! Switch the calling thread to a new phase. The phase stays active
+	//! until it is switched again.
+	void SetHeapProfilePhase(HeapProfilePhase phase);
+
+	//! @details
+	//! RAII helper that switches the calling thread into a phase and 
+	//! restores the previous phase when it goes out of scope.
+	class HeapProfileScope
+	{
+	public:
+		explicit HeapProfileScope(HeapProfilePhase phase);
+		~HeapProfileScope();
+
+	private:
+		HeapProfilePhase m_previous;
+
+		HeapProfileScope(HeapProfileScope const &);
+		HeapProfileScope &operator=(HeapProfileScope const &);
+	};
+
+#define DBK_HEAP_PHASE_SCOPE(phase) \
+	::google::protobuf::compiler::docbook::HeapProfileScope \
+		dbkHeapProfileScope(phase)
+
+#define DBK_SET_HEAP_PHASE(phase) \
+	::google::protobuf::compiler::docbook::SetHeapProfilePhase(phase)
+
+#else
+
+#define DBK_HEAP_PHASE_SCOPE(phase)
+#define DBK_SET_HEAP_PHASE(phase)
+
+#endif // DBK_HEAP_PROFILE
+
+}  // namespace docbook
+}  // namespace compiler
+}  // namespace protobuf
+}  // namespace google
+
+#endif // DOCBOOK_HEAP_PROFILE_H__
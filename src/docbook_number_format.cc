@@ -0,0 +1,226 @@
+// protoc-gen-docbook
+// http://code.google.com/p/protoc-gen-docbook/
+//
+// Redistribution and use in source and binary forms, with or without
+//// modification, are permitted provided that the following conditions are
+// met:
+//
+//     * Redistributions of source code must retain the above copyright
+// notice, this list of conditions and the following disclaimer.
+//     * Redistributions in binary form must reproduce the above
+// copyright notice, this list of conditions and the following disclaimer
+// in the documentation and/or other materials provided with the
+// distribution.
+//     * Neither the name of Google Inc. nor the names of its
+// contributors may be used to endorse or promote products derived from
+// this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+// "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+// LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+// A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+// OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+// SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+// LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+// DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+// THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//
+// Author: askldjd@gmail.com
+//
+
+#include "docbook_number_format.h"
+
+#include <cfloat>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+
+namespace google { namespace protobuf { namespace compiler { namespace docbook {
+
+namespace {
+
+	//! @details
+	//! "00" to "99", so integers can be converted two digits at a time.
+	char const DIGIT_PAIRS[] =
+		"00010203040506070809"
+		"10111213141516171819"
+		"20212223242526272829"
+		"30313233343536373839"
+		"40414243444546474849"
+		"50515253545556575859"
+		"60616263646566676869"
+		"70717273747576777879"
+		"80818283848586878889"
+		"90919293949596979899";
+
+	char const HEX_DIGITS[] = "0123456789ABCDEF";
+
+	//! @details
+	//! Most significant digits a double or a float can need to round-trip.
+	const int DOUBLE_MAX_DIGITS = 17;
+	const int FLOAT_MAX_DIGITS = 9;
+
+	//! @details
+	//! Precision of a default std::ostream. Values that need fewer digits 
+	//! are still printed at this precision, which does not add any digit 
+	//! (%g drops trailing zeros) but keeps the notation a stream would 
+	//! pick, e.g. 52000 instead of 5.2e+04.
+	const int STREAM_DIGITS = 6;
+
+	char *FormatUnsigned(uint64 value, char *buffer)
+	{
+		char digits[NUMBER_BUFFER_SIZE];
+		char *pos = digits + sizeof(digits);
+
+		while(value >= 100)
+		{
+			unsigned int pair = static_cast<unsigned int>(value % 100) * 2;
+			value /= 100;
+			*--pos = DIGIT_PAIRS[pair + 1];
+			*--pos = DIGIT_PAIRS[pair];
+		}
+
+		if(value >= 10)
+		{
+			unsigned int pair = static_cast<unsigned int>(value) * 2;
+			*--pos = DIGIT_PAIRS[pair + 1];
+			*--pos = DIGIT_PAIRS[pair];
+		}
+		else
+		{
+			*--pos = static_cast<char>('0' + value);
+		}
+
+		size_t length = digits + sizeof(digits) - pos;
+		memcpy(buffer, pos, length);
+		buffer[length] = '\0';
+		return buffer + length;
+	}
+
+	char *FormatSigned(int64 value, char *buffer)
+	{
+		if(value < 0)
+		{
+			*buffer++ = '-';
+			// Negate in unsigned arithmetic so kint64min does not overflow.
+			return FormatUnsigned(0 - static_cast<uint64>(value), buffer);
+		}
+		return FormatUnsigned(static_cast<uint64>(value), buffer);
+	}
+
+	//! @details
+	//! Handle the values that have no digits to print.
+	//!
+	//! @return
+	//! Pointer to the terminating null, NULL if the value is finite.
+	char *FormatNonFinite(double value, char *buffer)
+	{
+		char const *text = NULL;
+		if(value != value)
+			text = "nan";
+		else if(value > DBL_MAX)
+			text = "inf";
+		else if(value < -DBL_MAX)
+			text = "-inf";
+		else
+			return NULL;
+
+		size_t length = strlen(text);
+		memcpy(buffer, text, length + 1);
+		return buffer + length;
+	}
+
+	//! @details
+	//! Print the value with a given number of significant digits.
+	int PrintPrecision(double value, int digits, char *buffer)
+	{
+		return sprintf(buffer, "%.*g", digits, value);
+	}
+
+	//! @details
+	//! Find the fewest significant digits that still parse back to the 
+	//! value, and print the value with them. Once a precision round-trips,
+	//! every larger precision does too, so the search is a bisection.
+	//! The search starts at STREAM_DIGITS.
+	//!
+	//! The parse goes through strtod for floats as well, which is exactly
+	//! how protoc reads the default value of a float field.
+	template <typename T>
+	char *FormatShortest(T value, int maxDigits, char *buffer)
+	{
+		char *end = FormatNonFinite(value, buffer);
+		if(end != NULL)
+			return end;
+
+		int low = STREAM_DIGITS;
+		int high = maxDigits;
+		while(low < high)
+		{
+			int mid = (low + high) / 2;
+			PrintPrecision(value, mid, buffer);
+			if(static_cast<T>(strtod(buffer, NULL)) == value)
+				high = mid;
+			else
+				low = mid + 1;
+		}
+
+		return buffer + PrintPrecision(value, low, buffer);
+	}
+
+} // end anonymous namespace
+
+char *FormatInt32(int32 value, char *buffer)
+{
+	return FormatSigned(value, buffer);
+}
+
+char *FormatInt64(int64 value, char *buffer)
+{
+	return FormatSigned(value, buffer);
+}
+
+char *FormatUInt32(uint32 value, char *buffer)
+{
+	return FormatUnsigned(value, buffer);
+}
+
+char *FormatUInt64(uint64 value, char *buffer)
+{
+	return FormatUnsigned(value, buffer);
+}
+
+char *FormatDouble(double value, char *buffer)
+{
+	return FormatShortest(value, DOUBLE_MAX_DIGITS, buffer);
+}
+
+char *FormatFloat(float value, char *buffer)
+{
+	return FormatShortest(value, FLOAT_MAX_DIGITS, buffer);
+}
+
+void WriteHexBytes(std::ostream &os, string const &bytes)
+{
+	// Encode in chunks so a long default does not need its own buffer.
+	char chunk[3 * 64];
+	size_t used = 0;
+
+	for(size_t i = 0; i < bytes.size(); ++i)
+	{
+		unsigned char byte = static_cast<unsigned char>(bytes[i]);
+		chunk[used++] = HEX_DIGITS[byte >> 4];
+		chunk[used++] = HEX_DIGITS[byte & 0x0F];
+		chunk[used++] = ' ';
+
+		if(used == sizeof(chunk))
+		{
+			os.write(chunk, used);
+			used = 0;
+		}
+	}
+	os.write(chunk, used);
+}
+
+}}}}  // end namespace
@@ -0,0 +1,140 @@
+// protoc-gen-docbook
+// http://code.google.com/p/protoc-gen-docbook/
+//
+// Redistribution and use in source and binary forms, with or without
+//// modification, are permitted provided that the following conditions are
+// met:
+//
+//     * Redistributions of source code must retain the above copyright
+// notice, this list of conditions and the following disclaimer.
+//     * Redistributions in binary form must reproduce the above
+// copyright notice, this list of conditions and the following disclaimer
+// in the documentation and/or other materials provided with the
+// distribution.
+//     * Neither the name of Google Inc. nor the names of its
+// contributors may be used to endorse or promote products derived from
+// this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+// "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+// LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+// A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+// OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+// SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+// LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+// DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+// THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//
+// Author: askldjd@gmail.com
+//
+// Allocation-free number formatting for everything the generator writes
+// as a number: default values, enum values and section levels.
+//
+// Integers are converted two digits at a time. Floating point values are
+// printed with the fewest digits that parse back to the exact same value,
+// so a default such as 0.1 stays "0.1" and 3.14159265358979 is no longer
+// cut down to 6 digits.
+//
+
+#ifndef DOCBOOK_NUMBER_FORMAT_H__
+#define DOCBOOK_NUMBER_FORMAT_H__
+
+#include <google/protobuf/stubs/common.h>
+#include <ostream>
+#include <string>
+
+namespace google { namespace protobuf { namespace compiler {namespace docbook {
+
+	//! @details
+	//! Size of a buffer large enough for any formatted number, including
+	//! the terminating null.
+	const int NUMBER_BUFFER_SIZE = 32;
+
+	//! @details
+	//! Format a number into the buffer. The buffer must hold at least 
+	//! NUMBER_BUFFER_SIZE characters. The result is null terminated.
+	//!
+	//! @return
+	//! Pointer to the terminating null of the formatted number.
+	char *FormatInt32(int32 value, char *buffer);
+	char *FormatInt64(int64 value, char *buffer);
+	char *FormatUInt32(uint32 value, char *buffer);
+	char *FormatUInt64(uint64 value, char *buffer);
+
+	//! @details
+	//! Shortest round-trip formatting. Infinity and NaN are written the 
+	//! way protoc accepts them in a default value ("inf", "-inf", "nan").
+	char *FormatDouble(double value, char *buffer);
+	char *FormatFloat(float value, char *buffer);
+
+	//! @details
+	//! Write every byte as two upper case hex digits followed by a space.
+	void WriteHexBytes(std::ostream &os, string const &bytes);
+
+	//! @details
+	//! A number formatted on the stack, ready to be streamed.
+	//!
+	//! @code
+	//! os << FormattedNumber(fd->default_value_double());
+	//! @endcode
+	class FormattedNumber
+	{
+	public:
+		explicit FormattedNumber(int32 value)
+			: m_end(FormatInt32(value, m_buffer))
+		{
+		}
+
+		explicit FormattedNumber(int64 value)
+			: m_end(FormatInt64(value, m_buffer))
+		{
+		}
+
+		explicit FormattedNumber(uint32 value)
+			: m_end(FormatUInt32(value, m_buffer))
+		{
+		}
+
+		explicit FormattedNumber(uint64 value)
+			: m_end(FormatUInt64(value, m_buffer))
+		{
+		}
+
+		explicit FormattedNumber(double value)
+			: m_end(FormatDouble(value, m_buffer))
+		{
+		}
+
+		explicit FormattedNumber(float value)
+			: m_end(FormatFloat(value, m_buffer))
+		{
+		}
+
+		char const *data() const
+		{
+			return m_buffer;
+		}
+
+		size_t size() const
+		{
+			return m_end - m_buffer;
+		}
+
+	private:
+		char m_buffer[NUMBER_BUFFER_SIZE];
+		char *m_end;
+	};
+
+	inline std::ostream &operator<<(std::ostream &os, FormattedNumber const &number)
+	{
+		return os.write(number.data(), number.size());
+	}
+
+}  // namespace docbook
+}  // namespace compiler
+}  // namespace protobuf
+}  // namespace google
+
+#endif // DOCBOOK_NUMBER_FORMAT_H__
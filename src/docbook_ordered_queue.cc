@@ -0,0 +1,97 @@
+// protoc-gen-docbook
+// http://code.google.com/p/protoc-gen-docbook/
+//
+// Redistribution and use in source and binary forms, with or without
+//// modification, are permitted provided that the following conditions are
+// met:
+//
+//     * Redistributions of source code must retain the above copyright
+// notice, this list of conditions and the following disclaimer.
+//     * Redistributions in binary form must reproduce the above
+// copyright notice, this list of conditions and the following disclaimer
+// in the documentation and/or other materials provided with the
+// distribution.
+//     * Neither the name of Google Inc. nor the names of its
+// contributors may be used to endorse or promote products derived from
+// this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+// "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+// LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+// A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+// OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+// SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+// LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+// DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+// THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//
+// Author: askldjd@gmail.com
+//
+
+#include "docbook_ordered_queue.h"
+
+namespace google { namespace protobuf { namespace compiler { namespace docbook {
+
+OrderedQueue::OrderedQueue(long capacity)
+	: m_next(0)
+	, m_capacity(capacity < 1 ? 1 : capacity)
+	, m_closed(false)
+{
+}
+
+OrderedQueue::~OrderedQueue()
+{
+}
+
+bool OrderedQueue::Reserve(long index)
+{
+	MutexLock lock(&m_mutex);
+	while(m_closed == false && index >= m_next + m_capacity)
+	{
+		m_taken.Wait(&m_mutex);
+	}
+	return m_closed == false;
+}
+
+void OrderedQueue::Push(long index, std::string *item)
+{
+	MutexLock lock(&m_mutex);
+	m_items[index].swap(*item);
+	if(index == m_next)
+	{
+		m_pushed.Signal();
+	}
+}
+
+bool OrderedQueue::Pop(std::string *item)
+{
+	MutexLock lock(&m_mutex);
+
+	std::map<long, std::string>::iterator itr;
+	while(m_closed == false && (itr = m_items.find(m_next)) == m_items.end())
+	{
+		m_pushed.Wait(&m_mutex);
+	}
+	if(m_closed)
+		return false;
+
+	item->swap(itr->second);
+	m_items.erase(itr);
+	++m_next;
+
+	// The window moved by one, but several producers may wait on it.
+	m_taken.Broadcast();
+	return true;
+}
+
+void OrderedQueue::Close()
+{
+	MutexLock lock(&m_mutex);
+	m_closed = true;
+	m_taken.Broadcast();
+	m_pushed.Broadcast();
+}
+
+}}}}  // end namespace
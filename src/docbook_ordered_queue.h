@@ -0,0 +1,112 @@
+// protoc-gen-docbook
+// http://code.google.com/p/protoc-gen-docbook/
+//
+// Redistribution and use in source and binary forms, with or without
+//// modification, are permitted provided that the following conditions are
+// met:
+//
+//     * Redistributions of source code must retain the above copyright
+// notice, this list of conditions and the following disclaimer.
+//     * Redistributions in binary form must reproduce the above
+// copyright notice, this list of conditions and the following disclaimer
+// in the documentation and/or other materials provided with the
+// distribution.
+//     * Neither the name of Google Inc. nor the names of its
+// contributors may be used to endorse or promote products derived from
+// this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+// "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+// LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+// A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+// OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+// SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+// LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+// DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+// THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//
+// Author: askldjd@gmail.com
+//
+// Bounded queue that hands out numbered items in number order, whatever
+// order they are completed in. Producers reserve a number before doing
+// the work, so at most `capacity` items are ever in flight or waiting.
+//
+
+#ifndef DOCBOOK_ORDERED_QUEUE_H__
+#define DOCBOOK_ORDERED_QUEUE_H__
+
+#include "docbook_thread.h"
+#include <map>
+#include <string>
+
+namespace google { namespace protobuf { namespace compiler {namespace docbook {
+
+	//! @details
+	//! Ordered-completion queue between several producers and a single
+	//! consumer. Items are numbered from 0 without gaps. The consumer gets
+	//! item n only once items 0 to n-1 have been taken.
+	class OrderedQueue
+	{
+	public:
+		//! @param[in] capacity
+		//! Number of items that may be reserved ahead of the one the 
+		//! consumer waits for, at least 1.
+		explicit OrderedQueue(long capacity);
+		~OrderedQueue();
+
+		//! @details
+		//! Wait until item index fits within the capacity. Call before 
+		//! producing the item, so that memory stays bounded.
+		//!
+		//! @return
+		//! false if the queue was closed.
+		bool Reserve(long index);
+
+		//! @details
+		//! Hand over a reserved item. The content of item is swapped out.
+		void Push(long index, std::string *item);
+
+		//! @details
+		//! Wait for the next item in order. The content of item is 
+		//! swapped in.
+		//!
+		//! @return
+		//! false if the queue was closed.
+		bool Pop(std::string *item);
+
+		//! @details
+		//! Wake up every waiting thread, and make all calls fail from now
+		//! on. Used to stop the producers when the consumer gives up.
+		void Close();
+
+	private:
+		Mutex m_mutex;
+
+		//! The consumer took an item, or the queue was closed.
+		ConditionVariable m_taken;
+
+		//! The item the consumer waits for was pushed, or the queue was
+		//! closed.
+		ConditionVariable m_pushed;
+
+		//! Items pushed but not taken yet.
+		std::map<long, std::string> m_items;
+
+		//! Next item for the consumer.
+		long m_next;
+
+		long m_capacity;
+		bool m_closed;
+
+		OrderedQueue(OrderedQueue const &);
+		OrderedQueue &operator=(OrderedQueue const &);
+	};
+
+}  // namespace docbook
+}  // namespace compiler
+}  // namespace protobuf
+}  // namespace google
+
+#endif // DOCBOOK_ORDERED_QUEUE_H__
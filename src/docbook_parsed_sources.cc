@@ -0,0 +1,394 @@
+// protoc-gen-docbook
+// http://code.google.com/p/protoc-gen-docbook/
+//
+// Redistribution and use in source and binary forms, with or without
+//// modification, are permitted provided that the following conditions are
+// met:
+//
+//     * Redistributions of source code must retain the above copyright
+// notice, this list of conditions and the following disclaimer.
+//     * Redistributions in binary form must reproduce the above
+// copyright notice, this list of conditions and the following disclaimer
+// in the documentation and/or other materials provided with the
+// distribution.
+//     * Neither the name of Google Inc. nor the names of its
+// contributors may be used to endorse or promote products derived from
+// this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+// "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+// LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+// A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+// OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+// SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+// LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+// DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+// THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//
+// Author: askldjd@gmail.com
+//
+
+#include "docbook_parsed_sources.h"
+#include "docbook_task_scheduler.h"
+#include <google/protobuf/compiler/parser.h>
+#include <google/protobuf/descriptor.pb.h>
+#include <google/protobuf/io/tokenizer.h>
+#include <google/protobuf/io/zero_copy_stream.h>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+
+namespace google { namespace protobuf { namespace compiler { namespace docbook {
+
+namespace {
+
+	//! @details
+	//! Collects parse errors the way protoc prints them 
+	//! (file:line:column: message). They are printed in one go once the 
+	//! file is parsed, so errors of files parsed in parallel don't mix.
+	class ParseErrorCollector : public io::ErrorCollector
+	{
+	public:
+		explicit ParseErrorCollector(string const &fileName)
+			: m_fileName(fileName)
+		{
+		}
+
+		// implements ErrorCollector ---------------------------------------
+		void AddError(int line, int column, string const &message)
+		{
+			std::ostringstream os;
+			os 
+				<< m_fileName << ":" << line + 1 << ":" << column + 1 << ": " 
+				<< message << std::endl;
+			m_errors += os.str();
+		}
+
+		string const &Errors() const
+		{
+			return m_errors;
+		}
+
+	private:
+		string m_fileName;
+		string m_errors;
+	};
+
+} // end anonymous namespace
+
+//! @details
+//! A source file and the result of its last successful parse.
+struct ParsedSources::SourceFile
+{
+	SourceFile()
+		: parsed(false)
+	{
+	}
+
+	FileDescriptorProto proto;
+	bool parsed;
+
+	//! Where the file was found, empty if it was not found.
+	string diskPath;
+};
+
+//! @details
+//! Parses one file, then queues a task for each import that nobody has 
+//! asked for yet. The check and the insertion happen under the lock, so
+//! every file is resolved and parsed by exactly one task.
+class ParsedSources::ParseTask : public Task
+{
+public:
+	ParseTask(ParsedSources *owner, string const &fileName, SourceFile *file, bool *succeeded)
+		: m_owner(owner)
+		, m_fileName(fileName)
+		, m_file(file)
+		, m_succeeded(succeeded)
+	{
+	}
+
+	// implements Task -----------------------------------------------------
+	void Run(TaskScheduler &scheduler, int worker)
+	{
+		if(m_owner->Parse(m_fileName, m_file) == false)
+		{
+			MutexLock lock(&m_owner->m_mutex);
+			*m_succeeded = false;
+			return;
+		}
+
+		FileDescriptorProto const &proto = m_file->proto;
+		MutexLock lock(&m_owner->m_mutex);
+		for(int i = 0; i < proto.dependency_size(); ++i)
+		{
+			SourceFile *&dependency = m_owner->m_files[proto.dependency(i)];
+			if(dependency == NULL)
+			{
+				dependency = new SourceFile;
+				scheduler.Spawn(
+					new ParseTask(m_owner, proto.dependency(i), dependency, m_succeeded), 
+					worker);
+			}
+		}
+	}
+
+private:
+	ParsedSources *m_owner;
+	string m_fileName;
+	SourceFile *m_file;
+	bool *m_succeeded;
+};
+
+bool ParsedSources::ParsedFileDatabase::FindFileByName(
+	string const &fileName, 
+	FileDescriptorProto *output)
+{
+	SourceFileMap::const_iterator itr = m_owner->m_files.find(fileName);
+	if(itr == m_owner->m_files.end() || itr->second->parsed == false)
+		return false;
+
+	output->CopyFrom(itr->second->proto);
+	return true;
+}
+
+bool ParsedSources::ParsedFileDatabase::FindFileContainingSymbol(
+	string const &, 
+	FileDescriptorProto *)
+{
+	return false;
+}
+
+bool ParsedSources::ParsedFileDatabase::FindFileContainingExtension(
+	string const &, 
+	int, 
+	FileDescriptorProto *)
+{
+	return false;
+}
+
+ParsedSources::ParsedSources(vector<string> const &protoPaths)
+	: m_protoPaths(protoPaths)
+	, m_database(this)
+{
+	if(m_protoPaths.empty())
+	{
+		m_protoPaths.push_back(".");
+	}
+
+	for(size_t i = 0; i < m_protoPaths.size(); ++i)
+	{
+		m_sourceTree.MapPath("", m_protoPaths[i]);
+	}
+}
+
+ParsedSources::~ParsedSources()
+{
+	for(SourceFileMap::iterator itr = m_files.begin(); itr != m_files.end(); ++itr)
+	{
+		delete itr->second;
+	}
+}
+
+bool ParsedSources::MapInputFiles(vector<string> *files)
+{
+	for(size_t i = 0; i < files->size(); ++i)
+	{
+		string &file = (*files)[i];
+		string virtualFile;
+		string shadowingDiskFile;
+		switch(m_sourceTree.DiskFileToVirtualFile(file, &virtualFile, &shadowingDiskFile))
+		{
+		case DiskSourceTree::SUCCESS:
+			file = virtualFile;
+			break;
+		case DiskSourceTree::SHADOWED:
+			std::cerr 
+				<< file << ": Input is shadowed in the --proto_path by \""
+				<< shadowingDiskFile << "\".  Either use the latter file as your "
+				<< "input or reorder the --proto_path so that the former file's "
+				<< "location comes first." << std::endl;
+			return false;
+		case DiskSourceTree::CANNOT_OPEN:
+			std::cerr << file << ": No such file or directory" << std::endl;
+			return false;
+		case DiskSourceTree::NO_MAPPING:
+			std::cerr 
+				<< file << ": File does not reside within any path specified "
+				<< "using --proto_path (or -I)." << std::endl;
+			return false;
+		}
+	}
+	return true;
+}
+
+bool ParsedSources::Load(vector<string> const &files, int threadCount)
+{
+	if(threadCount <= 0)
+	{
+		threadCount = HardwareConcurrency();
+	}
+
+	bool succeeded = true;
+	TaskScheduler scheduler(threadCount);
+
+	// Files already parsed are only walked for imports they have not 
+	// reached yet, e.g. one added by Reparse.
+	vector<string> pending(files.begin(), files.end());
+	std::set<string> visited;
+	while(pending.empty() == false)
+	{
+		string fileName = pending.back();
+		pending.pop_back();
+		if(visited.insert(fileName).second == false)
+			continue;
+
+		SourceFile *&file = m_files[fileName];
+		if(file == NULL)
+		{
+			file = new SourceFile;
+			scheduler.Spawn(new ParseTask(this, fileName, file, &succeeded), visited.size());
+			continue;
+		}
+
+		for(int i = 0; i < file->proto.dependency_size(); ++i)
+		{
+			pending.push_back(file->proto.dependency(i));
+		}
+	}
+
+	scheduler.Run();
+	return succeeded;
+}
+
+bool ParsedSources::Reparse(string const &fileName)
+{
+	SourceFile *&file = m_files[fileName];
+	if(file == NULL)
+	{
+		file = new SourceFile;
+	}
+	return Parse(fileName, file);
+}
+
+bool ParsedSources::Parse(string const &fileName, SourceFile *file)
+{
+	// DiskSourceTree only reads its mappings, so several files can be 
+	// opened at once.
+	string diskPath;
+	if(m_sourceTree.VirtualFileToDiskFile(fileName, &diskPath))
+	{
+		file->diskPath = diskPath;
+	}
+
+	scoped_ptr<io::ZeroCopyInputStream> input(m_sourceTree.Open(fileName));
+	if(input == NULL)
+	{
+		MutexLock lock(&m_mutex);
+		std::cerr << fileName << ": File not found." << std::endl;
+		return false;
+	}
+
+	ParseErrorCollector errorCollector(fileName);
+	io::Tokenizer tokenizer(input.get(), &errorCollector);
+
+	FileDescriptorProto proto;
+	Parser parser;
+	parser.RecordErrorsTo(&errorCollector);
+	if(parser.Parse(&tokenizer, &proto) == false || errorCollector.Errors().empty() == false)
+	{
+		MutexLock lock(&m_mutex);
+		std::cerr << errorCollector.Errors();
+		return false;
+	}
+
+	proto.set_name(fileName);
+	file->proto.Swap(&proto);
+	file->parsed = true;
+	return true;
+}
+
+void ParsedSources::AddDependents(std::set<string> *files) const
+{
+	std::multimap<string, string> importedBy;
+	for(SourceFileMap::const_iterator itr = m_files.begin(); itr != m_files.end(); ++itr)
+	{
+		FileDescriptorProto const &proto = itr->second->proto;
+		for(int i = 0; i < proto.dependency_size(); ++i)
+		{
+			importedBy.insert(std::make_pair(proto.dependency(i), itr->first));
+		}
+	}
+
+	vector<string> pending(files->begin(), files->end());
+	while(pending.empty() == false)
+	{
+		string fileName = pending.back();
+		pending.pop_back();
+
+		typedef std::multimap<string, string>::const_iterator Iterator;
+		std::pair<Iterator, Iterator> range = importedBy.equal_range(fileName);
+		for(Iterator itr = range.first; itr != range.second; ++itr)
+		{
+			if(files->insert(itr->second).second)
+			{
+				pending.push_back(itr->second);
+			}
+		}
+	}
+}
+
+string ParsedSources::DiskPath(string const &fileName) const
+{
+	SourceFileMap::const_iterator itr = m_files.find(fileName);
+	if(itr == m_files.end())
+		return "";
+	return itr->second->diskPath;
+}
+
+void ParsedSources::ListFiles(vector<string> *fileNames) const
+{
+	for(SourceFileMap::const_iterator itr = m_files.begin(); itr != m_files.end(); ++itr)
+	{
+		fileNames->push_back(itr->first);
+	}
+}
+
+void BuildErrorCollector::AddError(
+	string const &fileName,
+	string const &elementName,
+	Message const *,
+	ErrorLocation,
+	string const &message)
+{
+	if(m_error != NULL)
+	{
+		*m_error += fileName + ": " + elementName + ": " + message + "\n";
+	}
+	else
+	{
+		std::cerr << fileName << ": " << elementName << ": " << message << std::endl;
+	}
+}
+
+bool WriteDocumentsToDirectory(
+	std::map<string, string> const &documents,
+	string const &directory)
+{
+	for(std::map<string, string>::const_iterator itr = documents.begin();
+		itr != documents.end(); ++itr)
+	{
+		string path = directory + "/" + itr->first;
+		std::ofstream ofs(path.c_str(), std::ios::out | std::ios::binary);
+		ofs.write(itr->second.data(), itr->second.size());
+		if(ofs.fail())
+		{
+			std::cerr << path << ": Unable to write the document." << std::endl;
+			return false;
+		}
+	}
+	return true;
+}
+
+}}}}  // end namespace
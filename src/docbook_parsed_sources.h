@@ -0,0 +1,220 @@
+// protoc-gen-docbook
+// http://code.google.com/p/protoc-gen-docbook/
+//
+// Redistribution and use in source and binary forms, with or without
+//// modification, are permitted provided that the following conditions are
+// met:
+//
+//     * Redistributions of source code must retain the above copyright
+// notice, this list of conditions and the following disclaimer.
+//     * Redistributions in binary form must reproduce the above
+// copyright notice, this list of conditions and the following disclaimer
+// in the documentation and/or other materials provided with the
+// distribution.
+//     * Neither the name of Google Inc. nor the names of its
+// contributors may be used to endorse or promote products derived from
+// this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+// "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+// LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+// A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+// OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+// SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+// LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+// DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+// THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//
+// Author: askldjd@gmail.com
+//
+// In-process replacement for the parsing protoc does before it runs the
+// plugin. Used by the command line (see main.cc) and by --watch.
+//
+
+#ifndef DOCBOOK_PARSED_SOURCES_H__
+#define DOCBOOK_PARSED_SOURCES_H__
+
+#include <google/protobuf/compiler/importer.h>
+#include <google/protobuf/descriptor_database.h>
+#include <map>
+#include <set>
+#include <string>
+#include <vector>
+#include "docbook_thread.h"
+
+namespace google { namespace protobuf { namespace compiler {namespace docbook {
+
+	//! @details
+	//! What to generate and where to write it, taken from the command line.
+	struct SourceOptions
+	{
+		SourceOptions()
+			: outputDirectory(".")
+			, parseThreads(0)
+		{
+		}
+
+		//! Directories searched for the files and their imports, the same
+		//! as protoc's -I. The current directory is used if empty.
+		std::vector<string> protoPaths;
+
+		//! The .proto files to document, in document order.
+		std::vector<string> files;
+
+		//! Directory the documents are written into.
+		string outputDirectory;
+
+		//! K/V pairs, see docbook.properties.
+		std::map<string, string> docbookOptions;
+
+		//! Threads used to parse the files, 0 for one per processor.
+		int parseThreads;
+	};
+
+	//! @details
+	//! A set of .proto files parsed into FileDescriptorProtos, along with
+	//! every file they import. 
+	//!
+	//! Each file is found and parsed exactly once, however many files 
+	//! import it, so a large set sharing deep import chains costs one 
+	//! parse per file. The files are linked by a DescriptorPool built on 
+	//! top of Database().
+	class ParsedSources
+	{
+	public:
+		explicit ParsedSources(std::vector<string> const &protoPaths);
+		~ParsedSources();
+
+		//! @details
+		//! Turn the files given on the command line into the names they
+		//! have within the proto paths, the same way protoc does (e.g. 
+		//! "./src/foo.proto" is "foo.proto" with -I src).
+		//!
+		//! @return
+		//! false if a file is not within any proto path. The error is 
+		//! printed.
+		bool MapInputFiles(std::vector<string> *files);
+
+		//! @details
+		//! Parse the files, and every file they import, that have not been
+		//! parsed yet. Files are parsed in parallel as soon as an import
+		//! reveals them. Parse errors are printed to stderr.
+		//!
+		//! @return
+		//! false if any file could not be found or parsed.
+		bool Load(std::vector<string> const &files, int threadCount);
+
+		//! @details
+		//! Parse a file again. The previous result is kept if it fails.
+		bool Reparse(string const &fileName);
+
+		//! @details
+		//! Add every file that imports one of the files, directly or not.
+		void AddDependents(std::set<string> *files) const;
+
+		//! @details
+		//! @return
+		//! Where the file was found on disk, empty if it never was.
+		string DiskPath(string const &fileName) const;
+
+		//! @details
+		//! Names of every file known so far.
+		void ListFiles(std::vector<string> *fileNames) const;
+
+		//! @details
+		//! The directories searched for the files, in order.
+		std::vector<string> const &ProtoPaths() const
+		{
+			return m_protoPaths;
+		}
+
+		//! @details
+		//! The parsed files, for a DescriptorPool to link.
+		DescriptorDatabase *Database()
+		{
+			return &m_database;
+		}
+
+	private:
+		struct SourceFile;
+		class ParseTask;
+		typedef std::map<string, SourceFile *> SourceFileMap;
+
+		//! @details
+		//! Serves the parsed FileDescriptorProtos, so a pool can be 
+		//! linked without reading any source.
+		class ParsedFileDatabase : public DescriptorDatabase
+		{
+		public:
+			explicit ParsedFileDatabase(ParsedSources *owner)
+				: m_owner(owner)
+			{
+			}
+
+			// implements DescriptorDatabase -------------------------------
+			bool FindFileByName(string const &fileName, FileDescriptorProto *output);
+			bool FindFileContainingSymbol(string const &, FileDescriptorProto *);
+			bool FindFileContainingExtension(string const &, int, FileDescriptorProto *);
+
+		private:
+			ParsedSources *m_owner;
+		};
+
+		bool Parse(string const &fileName, SourceFile *file);
+
+		std::vector<string> m_protoPaths;
+		DiskSourceTree m_sourceTree;
+		SourceFileMap m_files;
+		ParsedFileDatabase m_database;
+
+		//! Guards m_files and stderr while Load runs.
+		Mutex m_mutex;
+
+		ParsedSources(ParsedSources const &);
+		ParsedSources &operator=(ParsedSources const &);
+	};
+
+	//! @details
+	//! Collects the errors found while linking descriptors, as 
+	//! "file: element: message" lines. Without a string to collect them 
+	//! into, they are printed to stderr as they are found.
+	class BuildErrorCollector : public DescriptorPool::ErrorCollector
+	{
+	public:
+		explicit BuildErrorCollector(string *error = NULL)
+			: m_error(error)
+		{
+		}
+
+		// implements ErrorCollector ---------------------------------------
+		void AddError(
+			string const &fileName,
+			string const &elementName,
+			Message const *,
+			ErrorLocation,
+			string const &message);
+
+	private:
+		string *m_error;
+
+		BuildErrorCollector(BuildErrorCollector const &);
+		BuildErrorCollector &operator=(BuildErrorCollector const &);
+	};
+
+	//! @details
+	//! Write every document into the directory.
+	//!
+	//! @return
+	//! false if a document could not be written. The error is printed.
+	bool WriteDocumentsToDirectory(
+		std::map<string, string> const &documents,
+		string const &directory);
+
+}  // namespace docbook
+}  // namespace compiler
+}  // namespace protobuf
+}  // namespace google
+
+#endif // DOCBOOK_PARSED_SOURCES_H__
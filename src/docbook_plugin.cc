@@ -0,0 +1,246 @@
+// protoc-gen-docbook
+// http://code.google.com/p/protoc-gen-docbook/
+//
+// Redistribution and use in source and binary forms, with or without
+//// modification, are permitted provided that the following conditions are
+// met:
+//
+//     * Redistributions of source code must retain the above copyright
+// notice, this list of conditions and the following disclaimer.
+//     * Redistributions in binary form must reproduce the above
+// copyright notice, this list of conditions and the following disclaimer
+// in the documentation and/or other materials provided with the
+// distribution.
+//     * Neither the name of Google Inc. nor the names of its
+// contributors may be used to endorse or promote products derived from
+// this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+// "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+// LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+// A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+// OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+// SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+// LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+// DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+// THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//
+// Author: askldjd@gmail.com
+//
+
+#include "docbook_plugin.h"
+#include "docbook_sized_stream.h"
+#include <google/protobuf/compiler/code_generator.h>
+#include <google/protobuf/compiler/plugin.pb.h>
+#include <google/protobuf/descriptor.h>
+#include <google/protobuf/io/coded_stream.h>
+#include <google/protobuf/io/zero_copy_stream_impl.h>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#ifdef _WIN32
+#include <io.h>
+#include <fcntl.h>
+#ifndef STDIN_FILENO
+#define STDIN_FILENO 0
+#endif
+#ifndef STDOUT_FILENO
+#define STDOUT_FILENO 1
+#endif
+#else
+#include <unistd.h>
+#endif
+
+namespace google { namespace protobuf { namespace compiler { namespace docbook {
+
+using std::string;
+using std::vector;
+
+namespace {
+
+	//! @details
+	//! GeneratorContext that writes each file of the response to stdout 
+	//! once its stream is closed.
+	class StreamingResponseContext : public GeneratorContext
+	{
+	public:
+		StreamingResponseContext(
+			io::CodedOutputStream *output,
+			vector<FileDescriptor const *> const &parsedFiles)
+			: m_output(output)
+			, m_parsedFiles(parsedFiles)
+		{
+		}
+
+		// implements GeneratorContext -------------------------------------
+		io::ZeroCopyOutputStream* Open(string const &filename)
+		{
+			return new FileStream(this, filename, "");
+		}
+
+		io::ZeroCopyOutputStream* OpenForInsert(
+			string const &filename, 
+			string const &insertionPoint)
+		{
+			return new FileStream(this, filename, insertionPoint);
+		}
+
+		void ListParsedFiles(vector<FileDescriptor const *> *output)
+		{
+			*output = m_parsedFiles;
+		}
+
+		//! @details
+		//! Write a response that only holds the error. Being the last
+		//! entry, it is merged into the files written so far.
+		void WriteError(string const &error)
+		{
+			CodeGeneratorResponse response;
+			response.set_error(error);
+			response.SerializeToCodedStream(m_output);
+		}
+
+	private:
+		//! @details
+		//! Buffers the content of one CodeGeneratorResponse.File, and 
+		//! writes it when it is destroyed.
+		class FileStream : public SizedOutputStream
+		{
+		public:
+			FileStream(
+				StreamingResponseContext *owner,
+				string const &filename,
+				string const &insertionPoint)
+				: m_owner(owner)
+				, m_file(m_response.add_file())
+				, m_inner(NULL)
+			{
+				m_file->set_name(filename);
+				if(insertionPoint.empty() == false)
+				{
+					m_file->set_insertion_point(insertionPoint);
+				}
+				m_inner = new SizedStringOutputStream(m_file->mutable_content());
+			}
+
+			~FileStream()
+			{
+				// Make sure all data has been written.
+				delete m_inner;
+
+				// A response with a single file serializes to exactly one 
+				// entry of the repeated file field.
+				m_response.SerializeToCodedStream(m_owner->m_output);
+			}
+
+			// implements SizedOutputStream ---------------------------------
+			void Reserve(int64 size) { m_inner->Reserve(size); }
+
+			// implements ZeroCopyOutputStream ------------------------------
+			bool Next(void **data, int *size) { return m_inner->Next(data, size); }
+			void BackUp(int count) { m_inner->BackUp(count); }
+			int64 ByteCount() const { return m_inner->ByteCount(); }
+
+		private:
+			StreamingResponseContext *m_owner;
+			CodeGeneratorResponse m_response;
+			CodeGeneratorResponse::File *m_file;
+			SizedStringOutputStream *m_inner;
+
+			GOOGLE_DISALLOW_EVIL_CONSTRUCTORS(FileStream);
+		};
+
+		io::CodedOutputStream *m_output;
+		vector<FileDescriptor const *> const &m_parsedFiles;
+
+		GOOGLE_DISALLOW_EVIL_CONSTRUCTORS(StreamingResponseContext);
+	};
+
+} // end anonymous namespace
+
+int RunPlugin(CodeGenerator const *generator)
+{
+#ifdef _WIN32
+	_setmode(STDIN_FILENO, _O_BINARY);
+	_setmode(STDOUT_FILENO, _O_BINARY);
+#endif
+
+	CodeGeneratorRequest request;
+	if(request.ParseFromFileDescriptor(STDIN_FILENO) == false)
+	{
+		std::cerr << "protoc-gen-docbook: protoc sent unparseable request to plugin." << std::endl;
+		return 1;
+	}
+
+	DescriptorPool pool;
+	for(int i = 0; i < request.proto_file_size(); ++i)
+	{
+		if(pool.BuildFile(request.proto_file(i)) == NULL)
+		{
+			// BuildFile() already wrote an error message.
+			return 1;
+		}
+	}
+
+	vector<FileDescriptor const *> parsedFiles;
+	for(int i = 0; i < request.file_to_generate_size(); ++i)
+	{
+		parsedFiles.push_back(pool.FindFileByName(request.file_to_generate(i)));
+		if(parsedFiles.back() == NULL)
+		{
+			std::cerr << "protoc-gen-docbook: protoc asked plugin to generate a file but "
+				"did not provide a descriptor for the file: " 
+				<< request.file_to_generate(i) << std::endl;
+			return 1;
+		}
+	}
+
+	// The descriptors are built, the serialized files are not needed 
+	// anymore.
+	request.clear_proto_file();
+
+	io::FileOutputStream stdoutStream(STDOUT_FILENO);
+	bool writeFailed = false;
+	{
+		io::CodedOutputStream output(&stdoutStream);
+		StreamingResponseContext context(&output, parsedFiles);
+
+		for(size_t i = 0; i < parsedFiles.size(); ++i)
+		{
+			FileDescriptor const *file = parsedFiles[i];
+
+			string error;
+			bool succeeded = generator->Generate(
+				file, request.parameter(), &context, &error);
+
+			if(succeeded == false && error.empty())
+			{
+				error = "Code generator returned false but provided no error "
+					"description.";
+			}
+			if(error.empty() == false)
+			{
+				// Not prefixed with the file name like protoc's own plugins 
+				// do: the document covers every file of the run, and the 
+				// errors that concern a file already name it.
+				context.WriteError(error);
+				break;
+			}
+		}
+
+		writeFailed = output.HadError();
+	}
+
+	if(writeFailed || stdoutStream.Close() == false)
+	{
+		std::cerr << "protoc-gen-docbook: Error writing to stdout." << std::endl;
+		return 1;
+	}
+
+	return 0;
+}
+
+}}}}  // end namespace
@@ -0,0 +1,69 @@
+// protoc-gen-docbook
+// http://code.google.com/p/protoc-gen-docbook/
+//
+// Redistribution and use in source and binary forms, with or without
+//// modification, are permitted provided that the following conditions are
+// met:
+//
+//     * Redistributions of source code must retain the above copyright
+// notice, this list of conditions and the following disclaimer.
+//     * Redistributions in binary form must reproduce the above
+// copyright notice, this list of conditions and the following disclaimer
+// in the documentation and/or other materials provided with the
+// distribution.
+//     * Neither the name of Google Inc. nor the names of its
+// contributors may be used to endorse or promote products derived from
+// this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+// "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+// LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+// A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+// OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+// SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+// LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+// DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+// THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//
+// Author: askldjd@gmail.com
+//
+// Plugin main loop. Same protocol as protoc's PluginMain, but every file
+// of the CodeGeneratorResponse is written to stdout as soon as it is
+// complete, instead of building the whole response in memory first.
+//
+
+#ifndef DOCBOOK_PLUGIN_H__
+#define DOCBOOK_PLUGIN_H__
+
+#include <google/protobuf/stubs/common.h>
+
+namespace google { namespace protobuf { namespace compiler {
+
+	class CodeGenerator;
+
+namespace docbook {
+
+	//! @details
+	//! Read the CodeGeneratorRequest from stdin, run the generator on each
+	//! file to generate, and stream the CodeGeneratorResponse to stdout.
+	//!
+	//! A repeated message field may be written as any number of separate
+	//! entries, so each CodeGeneratorResponse.File is serialized on its own
+	//! when its output stream is closed, and freed right away. Peak memory
+	//! is bounded by the largest single file of the response rather than 
+	//! their total. The files reach protoc in the order their streams are
+	//! closed, so the generator must close a stream before it opens the 
+	//! next one (insertions are applied in that order).
+	//!
+	//! @return
+	//! Process exit code.
+	int RunPlugin(CodeGenerator const *generator);
+
+}  // namespace docbook
+}  // namespace compiler
+}  // namespace protobuf
+}  // namespace google
+
+#endif // DOCBOOK_PLUGIN_H__
@@ -0,0 +1,85 @@
+// protoc-gen-docbook
+// http://code.google.com/p/protoc-gen-docbook/
+//
+// Redistribution and use in source and binary forms, with or without
+//// modification, are permitted provided that the following conditions are
+// met:
+//
+//     * Redistributions of source code must retain the above copyright
+// notice, this list of conditions and the following disclaimer.
+//     * Redistributions in binary form must reproduce the above
+// copyright notice, this list of conditions and the following disclaimer
+// in the documentation and/or other materials provided with the
+// distribution.
+//     * Neither the name of Google Inc. nor the names of its
+// contributors may be used to endorse or promote products derived from
+// this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+// "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+// LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+// A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+// OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+// SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+// LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+// DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+// THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//
+// Author: askldjd@gmail.com
+//
+
+#include "docbook_sized_stream.h"
+
+namespace google { namespace protobuf { namespace compiler { namespace docbook {
+
+SizedStringOutputStream::SizedStringOutputStream(std::string *target)
+	: m_target(target)
+	, m_inner(target)
+	, m_expectedSize(-1)
+{
+}
+
+SizedStringOutputStream::~SizedStringOutputStream()
+{
+	if(m_expectedSize >= 0)
+	{
+		GOOGLE_DCHECK_EQ(ByteCount(), m_expectedSize) 
+			<< "Wrong size reserved for the output.";
+	}
+}
+
+void SizedStringOutputStream::Reserve(int64 size)
+{
+	// StringOutputStream hands out the spare capacity of the string before
+	// it doubles it.
+	m_expectedSize = ByteCount() + size;
+	m_target->reserve(static_cast<std::string::size_type>(m_expectedSize));
+}
+
+bool SizedStringOutputStream::Next(void **data, int *size)
+{
+	return m_inner.Next(data, size);
+}
+
+void SizedStringOutputStream::BackUp(int count)
+{
+	m_inner.BackUp(count);
+}
+
+int64 SizedStringOutputStream::ByteCount() const
+{
+	return m_inner.ByteCount();
+}
+
+void ReserveOutput(io::ZeroCopyOutputStream *stream, int64 size)
+{
+	SizedOutputStream *sized = dynamic_cast<SizedOutputStream *>(stream);
+	if(sized != NULL)
+	{
+		sized->Reserve(size);
+	}
+}
+
+}}}}  // end namespace
@@ -0,0 +1,96 @@
+// protoc-gen-docbook
+// http://code.google.com/p/protoc-gen-docbook/
+//
+// Redistribution and use in source and binary forms, with or without
+//// modification, are permitted provided that the following conditions are
+// met:
+//
+//     * Redistributions of source code must retain the above copyright
+// notice, this list of conditions and the following disclaimer.
+//     * Redistributions in binary form must reproduce the above
+// copyright notice, this list of conditions and the following disclaimer
+// in the documentation and/or other materials provided with the
+// distribution.
+//     * Neither the name of Google Inc. nor the names of its
+// contributors may be used to endorse or promote products derived from
+// this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+// "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+// LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+// A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+// OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+// SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+// LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+// DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+// THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//
+// Author: askldjd@gmail.com
+//
+// Output streams that can be told up front how many bytes will be written
+// to them, so that they allocate their buffer once instead of growing it.
+//
+
+#ifndef DOCBOOK_SIZED_STREAM_H__
+#define DOCBOOK_SIZED_STREAM_H__
+
+#include <google/protobuf/io/zero_copy_stream.h>
+#include <google/protobuf/io/zero_copy_stream_impl_lite.h>
+#include <string>
+
+namespace google { namespace protobuf { namespace compiler {namespace docbook {
+
+	//! @details
+	//! ZeroCopyOutputStream that accepts the exact size of what is about to
+	//! be written to it.
+	class SizedOutputStream : public io::ZeroCopyOutputStream
+	{
+	public:
+		//! @details
+		//! Make room for exactly size more bytes. Writing any other number
+		//! of bytes before the stream is destroyed is a bug, and fails in 
+		//! debug builds.
+		virtual void Reserve(int64 size) = 0;
+	};
+
+	//! @details
+	//! StringOutputStream with SizedOutputStream::Reserve. The string is
+	//! grown to the reserved size once, and the first Next() hands out all
+	//! of it.
+	class SizedStringOutputStream : public SizedOutputStream
+	{
+	public:
+		explicit SizedStringOutputStream(std::string *target);
+		~SizedStringOutputStream();
+
+		// implements SizedOutputStream ------------------------------------
+		void Reserve(int64 size);
+
+		// implements ZeroCopyOutputStream ---------------------------------
+		bool Next(void **data, int *size);
+		void BackUp(int count);
+		int64 ByteCount() const;
+
+	private:
+		std::string *m_target;
+		io::StringOutputStream m_inner;
+
+		//! Size the stream must reach, -1 if nothing was reserved.
+		int64 m_expectedSize;
+
+		GOOGLE_DISALLOW_EVIL_CONSTRUCTORS(SizedStringOutputStream);
+	};
+
+	//! @details
+	//! Reserve size bytes on stream if it is a SizedOutputStream. Other 
+	//! streams, e.g. the ones of protoc itself, just grow as usual.
+	void ReserveOutput(io::ZeroCopyOutputStream *stream, int64 size);
+
+}  // namespace docbook
+}  // namespace compiler
+}  // namespace protobuf
+}  // namespace google
+
+#endif // DOCBOOK_SIZED_STREAM_H__
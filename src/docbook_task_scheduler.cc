@@ -0,0 +1,192 @@
+// protoc-gen-docbook
+// http://code.google.com/p/protoc-gen-docbook/
+//
+// Redistribution and use in source and binary forms, with or without
+//// modification, are permitted provided that the following conditions are
+// met:
+//
+//     * Redistributions of source code must retain the above copyright
+// notice, this list of conditions and the following disclaimer.
+//     * Redistributions in binary form must reproduce the above
+// copyright notice, this list of conditions and the following disclaimer
+// in the documentation and/or other materials provided with the
+// distribution.
+//     * Neither the name of Google Inc. nor the names of its
+// contributors may be used to endorse or promote products derived from
+// this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+// "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+// LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+// A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+// OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+// SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+// LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+// DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+// THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//
+// Author: askldjd@gmail.com
+//
+
+#include "docbook_task_scheduler.h"
+
+namespace google { namespace protobuf { namespace compiler { namespace docbook {
+
+Task *TaskScheduler::Worker::PopBack()
+{
+	MutexLock lock(&m_mutex);
+	if(m_tasks.empty())
+		return NULL;
+
+	Task *task = m_tasks.back();
+	m_tasks.pop_back();
+	return task;
+}
+
+Task *TaskScheduler::Worker::PopFront()
+{
+	MutexLock lock(&m_mutex);
+	if(m_tasks.empty())
+		return NULL;
+
+	Task *task = m_tasks.front();
+	m_tasks.pop_front();
+	return task;
+}
+
+void TaskScheduler::Worker::PushBack(Task *task)
+{
+	MutexLock lock(&m_mutex);
+	m_tasks.push_back(task);
+}
+
+TaskScheduler::TaskScheduler(int threadCount)
+	: m_generation(0)
+{
+	if(threadCount < 1)
+		threadCount = 1;
+
+	for(int i = 0; i < threadCount; ++i)
+	{
+		m_workers.push_back(new Worker(this, i));
+	}
+}
+
+TaskScheduler::~TaskScheduler()
+{
+	// Tasks that never ran (Run was not called) are still owned by us.
+	for(size_t i = 0; i < m_workers.size(); ++i)
+	{
+		while(Task *task = m_workers[i]->PopBack())
+		{
+			delete task;
+		}
+		delete m_workers[i];
+	}
+}
+
+void TaskScheduler::Spawn(Task *task, int worker)
+{
+	// Count the task before it becomes visible, so the pending count can 
+	// never drop to zero while a parent is still spawning.
+	m_pending.Increment();
+	m_workers[worker % m_workers.size()]->PushBack(task);
+	Notify(false);
+}
+
+void TaskScheduler::Notify(bool everyone)
+{
+	MutexLock lock(&m_idleMutex);
+	++m_generation;
+	if(everyone)
+	{
+		m_idle.Broadcast();
+	}
+	else
+	{
+		m_idle.Signal();
+	}
+}
+
+void TaskScheduler::Run()
+{
+	std::vector<Thread *> threads;
+	for(size_t i = 1; i < m_workers.size(); ++i)
+	{
+		Thread *thread = new Thread;
+		if(thread->Start(m_workers[i]))
+		{
+			threads.push_back(thread);
+		}
+		else
+		{
+			// Whatever is queued on this worker is stolen by the others.
+			delete thread;
+		}
+	}
+
+	WorkLoop(0);
+
+	for(size_t i = 0; i < threads.size(); ++i)
+	{
+		threads[i]->Join();
+		delete threads[i];
+	}
+}
+
+Task *TaskScheduler::Steal(int thief)
+{
+	int count = static_cast<int>(m_workers.size());
+	for(int i = 1; i < count; ++i)
+	{
+		Task *task = m_workers[(thief + i) % count]->PopFront();
+		if(task != NULL)
+			return task;
+	}
+	return NULL;
+}
+
+void TaskScheduler::WorkLoop(int worker)
+{
+	for(;;)
+	{
+		// Read before looking for a task, so that a task spawned after the
+		// deques were found empty still wakes this worker up.
+		unsigned long generation = 0;
+		{
+			MutexLock lock(&m_idleMutex);
+			generation = m_generation;
+		}
+
+		Task *task = m_workers[worker]->PopBack();
+		if(task == NULL)
+		{
+			task = Steal(worker);
+		}
+
+		if(task == NULL)
+		{
+			// Everything left is being run by other workers, but they may
+			// still spawn more.
+			MutexLock lock(&m_idleMutex);
+			while(m_generation == generation && m_pending.Get() > 0)
+			{
+				m_idle.Wait(&m_idleMutex);
+			}
+			if(m_pending.Get() == 0)
+				return;
+			continue;
+		}
+
+		task->Run(*this, worker);
+		delete task;
+		if(m_pending.Decrement() == 0)
+		{
+			Notify(true);
+		}
+	}
+}
+
+}}}}  // end namespace
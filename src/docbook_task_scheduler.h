@@ -0,0 +1,153 @@
+// protoc-gen-docbook
+// http://code.google.com/p/protoc-gen-docbook/
+//
+// Redistribution and use in source and binary forms, with or without
+//// modification, are permitted provided that the following conditions are
+// met:
+//
+//     * Redistributions of source code must retain the above copyright
+// notice, this list of conditions and the following disclaimer.
+//     * Redistributions in binary form must reproduce the above
+// copyright notice, this list of conditions and the following disclaimer
+// in the documentation and/or other materials provided with the
+// distribution.
+//     * Neither the name of Google Inc. nor the names of its
+// contributors may be used to endorse or promote products derived from
+// this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+// "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+// LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+// A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+// OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+// SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+// LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+// DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+// THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//
+// Author: askldjd@gmail.com
+//
+// Work-stealing task scheduler. Every worker owns a deque of tasks. A 
+// worker takes its own tasks from the back, so the subtree it just 
+// spawned stays hot in its cache, and steals from the front of the other
+// deques when it runs dry, which hands out the largest pending subtrees
+// first.
+//
+
+#ifndef DOCBOOK_TASK_SCHEDULER_H__
+#define DOCBOOK_TASK_SCHEDULER_H__
+
+#include "docbook_thread.h"
+#include <cstddef>
+#include <deque>
+#include <vector>
+
+namespace google { namespace protobuf { namespace compiler {namespace docbook {
+
+	class TaskScheduler;
+
+	//! @details
+	//! A unit of work. Tasks are owned and deleted by the scheduler once 
+	//! they have run.
+	class Task
+	{
+	public:
+		virtual ~Task()
+		{
+		}
+
+		//! @details
+		//! Do the work. More tasks may be spawned with 
+		//! scheduler.Spawn(task, worker).
+		//!
+		//! @param[in] worker
+		//! Index of the worker running the task.
+		virtual void Run(TaskScheduler &scheduler, int worker) = 0;
+	};
+
+	//! @details
+	//! Runs tasks, and every task they spawn, on a fixed number of threads.
+	//! The calling thread is worker 0, so a scheduler with one thread runs
+	//! everything inline.
+	class TaskScheduler
+	{
+	public:
+		explicit TaskScheduler(int threadCount);
+		~TaskScheduler();
+
+		//! @details
+		//! Queue a task on a worker. Before Run, any worker index may be 
+		//! used to spread the initial tasks. From within a task, use the
+		//! worker index the task was given.
+		void Spawn(Task *task, int worker);
+
+		//! @details
+		//! Run until every task, including the ones spawned along the way,
+		//! has finished.
+		void Run();
+
+		int ThreadCount() const
+		{
+			return static_cast<int>(m_workers.size());
+		}
+
+	private:
+		class Worker : public Runnable
+		{
+		public:
+			Worker(TaskScheduler *owner, int index)
+				: m_owner(owner)
+				, m_index(index)
+			{
+			}
+
+			// implements Runnable ------------------------------------------
+			void Run()
+			{
+				m_owner->WorkLoop(m_index);
+			}
+
+			//! Owner end of the deque.
+			Task *PopBack();
+
+			//! Thief end of the deque.
+			Task *PopFront();
+
+			void PushBack(Task *task);
+
+		private:
+			TaskScheduler *m_owner;
+			int m_index;
+			Mutex m_mutex;
+			std::deque<Task *> m_tasks;
+		};
+
+		void WorkLoop(int worker);
+		Task *Steal(int thief);
+
+		//! Wake up one idle worker, or every one of them.
+		void Notify(bool everyone);
+
+		std::vector<Worker *> m_workers;
+
+		//! Tasks spawned but not finished yet.
+		AtomicCounter m_pending;
+
+		//! Idle workers sleep on m_idle until m_generation changes, i.e. a
+		//! task was spawned or the last one finished.
+		Mutex m_idleMutex;
+		ConditionVariable m_idle;
+		unsigned long m_generation;
+
+		TaskScheduler(TaskScheduler const &);
+		TaskScheduler &operator=(TaskScheduler const &);
+	};
+
+}  // namespace docbook
+}  // namespace compiler
+}  // namespace protobuf
+}  // namespace google
+
+#endif // DOCBOOK_TASK_SCHEDULER_H__
@@ -0,0 +1,326 @@
+// protoc-gen-docbook
+// http://code.google.com/p/protoc-gen-docbook/
+//
+// Redistribution and use in source and binary forms, with or without
+//// modification, are permitted provided that the following conditions are
+// met:
+//
+//     * Redistributions of source code must retain the above copyright
+// notice, this list of conditions and the following disclaimer.
+//     * Redistributions in binary form must reproduce the above
+// copyright notice, this list of conditions and the following disclaimer
+// in the documentation and/or other materials provided with the
+// distribution.
+//     * Neither the name of Google Inc. nor the names of its
+// contributors may be used to endorse or promote products derived from
+// this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+// "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+// LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+// A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+// OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+// SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+// LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+// DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+// THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//
+// Author: askldjd@gmail.com
+//
+
+#include "docbook_thread.h"
+
+#ifdef _WIN32
+#ifndef _WIN32_WINNT
+// Condition variables need Windows Vista or later.
+#define _WIN32_WINNT 0x0600
+#endif
+#include <windows.h>
+#else
+#include <pthread.h>
+#include <sched.h>
+#include <unistd.h>
+#endif
+
+namespace google { namespace protobuf { namespace compiler { namespace docbook {
+
+namespace {
+
+#ifdef _WIN32
+	DWORD WINAPI ThreadEntry(LPVOID runnable)
+	{
+		static_cast<Runnable *>(runnable)->Run();
+		return 0;
+	}
+#else
+	void *ThreadEntry(void *runnable)
+	{
+		static_cast<Runnable *>(runnable)->Run();
+		return NULL;
+	}
+#endif
+
+} // end anonymous namespace
+
+#ifdef _WIN32
+
+struct Mutex::Impl
+{
+	CRITICAL_SECTION mutex;
+};
+
+Mutex::Mutex()
+	: m_impl(new Impl)
+{
+	InitializeCriticalSection(&m_impl->mutex);
+}
+
+Mutex::~Mutex()
+{
+	DeleteCriticalSection(&m_impl->mutex);
+	delete m_impl;
+}
+
+void Mutex::Lock()
+{
+	EnterCriticalSection(&m_impl->mutex);
+}
+
+void Mutex::Unlock()
+{
+	LeaveCriticalSection(&m_impl->mutex);
+}
+
+struct ConditionVariable::Impl
+{
+	CONDITION_VARIABLE condition;
+};
+
+ConditionVariable::ConditionVariable()
+	: m_impl(new Impl)
+{
+	InitializeConditionVariable(&m_impl->condition);
+}
+
+ConditionVariable::~ConditionVariable()
+{
+	delete m_impl;
+}
+
+void ConditionVariable::Wait(Mutex *mutex)
+{
+	SleepConditionVariableCS(&m_impl->condition, &mutex->m_impl->mutex, INFINITE);
+}
+
+void ConditionVariable::Signal()
+{
+	WakeConditionVariable(&m_impl->condition);
+}
+
+void ConditionVariable::Broadcast()
+{
+	WakeAllConditionVariable(&m_impl->condition);
+}
+
+AtomicCounter::AtomicCounter(long value)
+	: m_value(value)
+{
+}
+
+long AtomicCounter::Increment()
+{
+	return InterlockedIncrement(&m_value);
+}
+
+long AtomicCounter::Decrement()
+{
+	return InterlockedDecrement(&m_value);
+}
+
+long AtomicCounter::Get() const
+{
+	return InterlockedCompareExchange(&m_value, 0, 0);
+}
+
+struct Thread::Impl
+{
+	HANDLE thread;
+};
+
+Thread::Thread()
+	: m_impl(NULL)
+{
+}
+
+Thread::~Thread()
+{
+	Join();
+}
+
+bool Thread::Start(Runnable *runnable)
+{
+	HANDLE thread = CreateThread(NULL, 0, &ThreadEntry, runnable, 0, NULL);
+	if(thread == NULL)
+		return false;
+
+	m_impl = new Impl;
+	m_impl->thread = thread;
+	return true;
+}
+
+void Thread::Join()
+{
+	if(m_impl != NULL)
+	{
+		WaitForSingleObject(m_impl->thread, INFINITE);
+		CloseHandle(m_impl->thread);
+		delete m_impl;
+		m_impl = NULL;
+	}
+}
+
+void YieldThread()
+{
+	SwitchToThread();
+}
+
+int HardwareConcurrency()
+{
+	SYSTEM_INFO info;
+	GetSystemInfo(&info);
+	return info.dwNumberOfProcessors > 0 ? info.dwNumberOfProcessors : 1;
+}
+
+#else
+
+struct Mutex::Impl
+{
+	pthread_mutex_t mutex;
+};
+
+Mutex::Mutex()
+	: m_impl(new Impl)
+{
+	pthread_mutex_init(&m_impl->mutex, NULL);
+}
+
+Mutex::~Mutex()
+{
+	pthread_mutex_destroy(&m_impl->mutex);
+	delete m_impl;
+}
+
+void Mutex::Lock()
+{
+	pthread_mutex_lock(&m_impl->mutex);
+}
+
+void Mutex::Unlock()
+{
+	pthread_mutex_unlock(&m_impl->mutex);
+}
+
+struct ConditionVariable::Impl
+{
+	pthread_cond_t condition;
+};
+
+ConditionVariable::ConditionVariable()
+	: m_impl(new Impl)
+{
+	pthread_cond_init(&m_impl->condition, NULL);
+}
+
+ConditionVariable::~ConditionVariable()
+{
+	pthread_cond_destroy(&m_impl->condition);
+	delete m_impl;
+}
+
+void ConditionVariable::Wait(Mutex *mutex)
+{
+	pthread_cond_wait(&m_impl->condition, &mutex->m_impl->mutex);
+}
+
+void ConditionVariable::Signal()
+{
+	pthread_cond_signal(&m_impl->condition);
+}
+
+void ConditionVariable::Broadcast()
+{
+	pthread_cond_broadcast(&m_impl->condition);
+}
+
+AtomicCounter::AtomicCounter(long value)
+	: m_value(value)
+{
+}
+
+long AtomicCounter::Increment()
+{
+	return __sync_add_and_fetch(&m_value, 1);
+}
+
+long AtomicCounter::Decrement()
+{
+	return __sync_sub_and_fetch(&m_value, 1);
+}
+
+long AtomicCounter::Get() const
+{
+	return __sync_add_and_fetch(&m_value, 0);
+}
+
+struct Thread::Impl
+{
+	pthread_t thread;
+};
+
+Thread::Thread()
+	: m_impl(NULL)
+{
+}
+
+Thread::~Thread()
+{
+	Join();
+}
+
+bool Thread::Start(Runnable *runnable)
+{
+	pthread_t thread;
+	if(pthread_create(&thread, NULL, &ThreadEntry, runnable) != 0)
+		return false;
+
+	m_impl = new Impl;
+	m_impl->thread = thread;
+	return true;
+}
+
+void Thread::Join()
+{
+	if(m_impl != NULL)
+	{
+		pthread_join(m_impl->thread, NULL);
+		delete m_impl;
+		m_impl = NULL;
+	}
+}
+
+void YieldThread()
+{
+	sched_yield();
+}
+
+int HardwareConcurrency()
+{
+	long count = sysconf(_SC_NPROCESSORS_ONLN);
+	return count > 0 ? static_cast<int>(count) : 1;
+}
+
+#endif // _WIN32
+
+}}}}  // end namespace
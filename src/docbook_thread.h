@@ -0,0 +1,194 @@
+// protoc-gen-docbook
+// http://code.google.com/p/protoc-gen-docbook/
+//
+// Redistribution and use in source and binary forms, with or without
+//// modification, are permitted provided that the following conditions are
+// met:
+//
+//     * Redistributions of source code must retain the above copyright
+// notice, this list of conditions and the following disclaimer.
+//     * Redistributions in binary form must reproduce the above
+// copyright notice, this list of conditions and the following disclaimer
+// in the documentation and/or other materials provided with the
+// distribution.
+//     * Neither the name of Google Inc. nor the names of its
+// contributors may be used to endorse or promote products derived from
+// this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+// "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+// LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+// A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+// OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+// SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+// LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+// DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+// THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//
+// Author: askldjd@gmail.com
+//
+// Minimal portable threading primitives (pthread on Linux, Win32 on 
+// Windows), enough for the generator to render on several cores without
+// depending on a threading library. The platform headers stay in the
+// .cc file so <windows.h> does not leak into the generator.
+//
+
+#ifndef DOCBOOK_THREAD_H__
+#define DOCBOOK_THREAD_H__
+
+namespace google { namespace protobuf { namespace compiler {namespace docbook {
+
+	//! @details
+	//! Non-recursive mutex.
+	class Mutex
+	{
+	public:
+		Mutex();
+		~Mutex();
+
+		void Lock();
+		void Unlock();
+
+	private:
+		friend class ConditionVariable;
+
+		struct Impl;
+		Impl *m_impl;
+
+		Mutex(Mutex const &);
+		Mutex &operator=(Mutex const &);
+	};
+
+	//! @details
+	//! Holds the mutex for the lifetime of the scope.
+	class MutexLock
+	{
+	public:
+		explicit MutexLock(Mutex *mutex)
+			: m_mutex(mutex)
+		{
+			m_mutex->Lock();
+		}
+
+		~MutexLock()
+		{
+			m_mutex->Unlock();
+		}
+
+	private:
+		Mutex *m_mutex;
+
+		MutexLock(MutexLock const &);
+		MutexLock &operator=(MutexLock const &);
+	};
+
+	//! @details
+	//! Lets threads wait for a change of the state guarded by a mutex. As
+	//! usual, the state must be checked again after each wake up.
+	class ConditionVariable
+	{
+	public:
+		ConditionVariable();
+		~ConditionVariable();
+
+		//! @details
+		//! Release the mutex, wait to be woken up, then lock it again. The 
+		//! caller must hold the mutex.
+		void Wait(Mutex *mutex);
+
+		//! @details
+		//! Wake up one waiting thread.
+		void Signal();
+
+		//! @details
+		//! Wake up every waiting thread.
+		void Broadcast();
+
+	private:
+		struct Impl;
+		Impl *m_impl;
+
+		ConditionVariable(ConditionVariable const &);
+		ConditionVariable &operator=(ConditionVariable const &);
+	};
+
+	//! @details
+	//! Counter that can be changed from several threads at once. Every
+	//! operation is a full memory barrier.
+	class AtomicCounter
+	{
+	public:
+		explicit AtomicCounter(long value = 0);
+
+		//! @return the value after the increment.
+		long Increment();
+
+		//! @return the value after the decrement.
+		long Decrement();
+
+		long Get() const;
+
+	private:
+		mutable volatile long m_value;
+
+		AtomicCounter(AtomicCounter const &);
+		AtomicCounter &operator=(AtomicCounter const &);
+	};
+
+	//! @details
+	//! Work to be done on a thread.
+	class Runnable
+	{
+	public:
+		virtual ~Runnable()
+		{
+		}
+
+		virtual void Run() = 0;
+	};
+
+	//! @details
+	//! A joinable thread. The thread must be joined before it is destroyed.
+	class Thread
+	{
+	public:
+		Thread();
+		~Thread();
+
+		//! @details
+		//! Start running the runnable on a new thread. The runnable must 
+		//! outlive the thread.
+		//!
+		//! @return
+		//! false if the thread could not be created.
+		bool Start(Runnable *runnable);
+
+		//! @details
+		//! Wait for the thread to finish. Does nothing if it never started.
+		void Join();
+
+	private:
+		struct Impl;
+		Impl *m_impl;
+
+		Thread(Thread const &);
+		Thread &operator=(Thread const &);
+	};
+
+	//! @details
+	//! Give up the rest of the time slice of the calling thread.
+	void YieldThread();
+
+	//! @details
+	//! @return
+	//! Number of processors available to the process, at least 1.
+	int HardwareConcurrency();
+
+}  // namespace docbook
+}  // namespace compiler
+}  // namespace protobuf
+}  // namespace google
+
+#endif // DOCBOOK_THREAD_H__
@@ -0,0 +1,407 @@
+// protoc-gen-docbook
+// http://code.google.com/p/protoc-gen-docbook/
+//
+// Redistribution and use in source and binary forms, with or without
+//// modification, are permitted provided that the following conditions are
+// met:
+//
+//     * Redistributions of source code must retain the above copyright
+// notice, this list of conditions and the following disclaimer.
+//     * Redistributions in binary form must reproduce the above
+// copyright notice, this list of conditions and the following disclaimer
+// in the documentation and/or other materials provided with the
+// distribution.
+//     * Neither the name of Google Inc. nor the names of its
+// contributors may be used to endorse or promote products derived from
+// this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+// "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+// LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+// A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+// OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+// SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+// LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+// DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+// THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//
+// Author: askldjd@gmail.com
+//
+// The descriptors of a DescriptorPool can not be replaced once built, so
+// a new pool is linked for every regeneration. The expensive part, reading
+// and parsing the sources, is only done again for the files that changed:
+// every other file is linked from the FileDescriptorProto kept from its 
+// last parse.
+//
+
+#include "docbook_watch.h"
+#include "docbook_generator.h"
+#include <google/protobuf/descriptor.h>
+#include <iostream>
+
+#ifdef __linux__
+#include <poll.h>
+#include <sys/inotify.h>
+#include <sys/time.h>
+#include <unistd.h>
+#endif
+
+namespace google { namespace protobuf { namespace compiler { namespace docbook {
+
+#ifdef __linux__
+
+namespace {
+
+	//! @details
+	//! Time to wait for more events after a change, so that an editor 
+	//! saving several files (or one file in several steps) only causes 
+	//! one regeneration.
+	int const WATCH_SETTLE_MILLISECONDS = 100;
+
+	//! @details
+	//! Rendered section of a file being documented.
+	struct Section
+	{
+		Section()
+			: stale(true)
+		{
+		}
+
+		string text;
+
+		//! See DocbookRenderer::ReferencesOf.
+		string references;
+
+		//! The section must be rendered again.
+		bool stale;
+	};
+
+	long MillisecondsSince(timeval const &start)
+	{
+		timeval now;
+		gettimeofday(&now, NULL);
+		return (now.tv_sec - start.tv_sec) * 1000 + 
+			(now.tv_usec - start.tv_usec) / 1000;
+	}
+
+	//! @details
+	//! The watch loop. See RunWatch.
+	class SourceWatcher
+	{
+	public:
+		explicit SourceWatcher(SourceOptions const &options)
+			: m_options(options)
+			, m_sources(options.protoPaths)
+			, m_renderer(options.docbookOptions)
+			, m_inotify(-1)
+		{
+		}
+
+		~SourceWatcher()
+		{
+			if(m_inotify >= 0)
+			{
+				close(m_inotify);
+			}
+		}
+
+		int Run()
+		{
+			m_inotify = inotify_init();
+			if(m_inotify < 0)
+			{
+				std::cerr << "Unable to initialize inotify." << std::endl;
+				return 1;
+			}
+
+			if(m_sources.MapInputFiles(&m_options.files) == false)
+			{
+				return 1;
+			}
+
+			std::set<string> changed;
+			bool loaded = m_sources.Load(m_options.files, m_options.parseThreads);
+
+			for(;;)
+			{
+				timeval start;
+				gettimeofday(&start, NULL);
+
+				int rendered = 0;
+				if(loaded && Regenerate(&rendered))
+				{
+					std::cerr 
+						<< "Regenerated " << rendered << " of " 
+						<< m_options.files.size() << " files in "
+						<< MillisecondsSince(start) << " ms." << std::endl;
+				}
+				WatchDirectories();
+
+				std::cerr << "Watching for changes..." << std::endl;
+				changed.clear();
+				if(WaitForChanges(&changed) == false)
+				{
+					return 1;
+				}
+
+				loaded = Reload(changed);
+			}
+		}
+
+	private:
+		//! @details
+		//! Parse the changed files again, and any import that is new.
+		//! Every file being documented that depends on a changed file, 
+		//! directly or not, is marked stale.
+		bool Reload(std::set<string> changed)
+		{
+			bool succeeded = true;
+			for(std::set<string>::const_iterator itr = changed.begin(); 
+				itr != changed.end(); ++itr)
+			{
+				succeeded = m_sources.Reparse(*itr) && succeeded;
+			}
+
+			succeeded = m_sources.Load(m_options.files, m_options.parseThreads) && succeeded;
+
+			m_sources.AddDependents(&changed);
+			for(std::set<string>::const_iterator itr = changed.begin(); 
+				itr != changed.end(); ++itr)
+			{
+				m_sections[*itr].stale = true;
+			}
+			return succeeded;
+		}
+
+		//! @details
+		//! Link a fresh pool from the parsed files, render the stale 
+		//! sections and write the documents.
+		bool Regenerate(int *rendered)
+		{
+			BuildErrorCollector errorCollector;
+			DescriptorPool pool(m_sources.Database(), &errorCollector);
+
+			vector<FileDescriptor const *> descriptors;
+			for(size_t i = 0; i < m_options.files.size(); ++i)
+			{
+				FileDescriptor const *descriptor = 
+					pool.FindFileByName(m_options.files[i]);
+				if(descriptor == NULL)
+				{
+					return false;
+				}
+				descriptors.push_back(descriptor);
+			}
+
+			vector<string> problems;
+			string error;
+			if(m_renderer.CheckLinks(descriptors, &problems, &error) == false)
+			{
+				std::cerr << error;
+				return false;
+			}
+			for(size_t i = 0; i < problems.size(); ++i)
+			{
+				std::cerr << "warning: " << problems[i] << std::endl;
+			}
+
+			// Whether a link is written depends on the other files, so a 
+			// section that did not change may still need to be rendered
+			// again once the set of broken links has changed.
+			if(problems != m_linkProblems)
+			{
+				m_linkProblems.swap(problems);
+				for(std::map<string, Section>::iterator itr = m_sections.begin();
+					itr != m_sections.end(); ++itr)
+				{
+					itr->second.stale = true;
+				}
+			}
+
+			vector<pair<string, string> > sections;
+			for(size_t i = 0; i < descriptors.size(); ++i)
+			{
+				Section &section = m_sections[m_options.files[i]];
+
+				// The types of a file that did not change may have gained 
+				// or lost referrers in the files that did.
+				string references = m_renderer.ReferencesOf(descriptors[i]);
+				if(references != section.references)
+				{
+					section.references.swap(references);
+					section.stale = true;
+				}
+
+				if(section.stale)
+				{
+					m_renderer.RenderFile(descriptors[i], &section.text);
+					section.stale = false;
+					++*rendered;
+				}
+				sections.push_back(std::make_pair(m_options.files[i], section.text));
+			}
+
+			std::map<string, string> documents;
+			if(m_renderer.WriteDocuments(sections, &documents, &error) == false)
+			{
+				std::cerr << error << std::endl;
+				return false;
+			}
+
+			return WriteDocumentsToDirectory(documents, m_options.outputDirectory);
+		}
+
+		//! @details
+		//! Watch the directory of every known file. Directories are 
+		//! watched rather than files, so that editors saving through a
+		//! rename are noticed too.
+		//!
+		//! An import that was not found has no directory yet, so the path
+		//! it would have in each proto path is watched instead, when that
+		//! directory exists. Creating the import then regenerates the
+		//! document.
+		void WatchDirectories()
+		{
+			vector<string> fileNames;
+			m_sources.ListFiles(&fileNames);
+
+			m_filesByDiskPath.clear();
+			for(size_t i = 0; i < fileNames.size(); ++i)
+			{
+				string diskPath = m_sources.DiskPath(fileNames[i]);
+				if(diskPath.empty() == false)
+				{
+					WatchPath(diskPath, fileNames[i]);
+					continue;
+				}
+
+				vector<string> const &protoPaths = m_sources.ProtoPaths();
+				for(size_t j = 0; j < protoPaths.size(); ++j)
+				{
+					WatchPath(protoPaths[j] + "/" + fileNames[i], fileNames[i]);
+				}
+			}
+		}
+
+		//! @details
+		//! Watch the directory of a path on disk, for changes to the file.
+		void WatchPath(string const &diskPath, string const &fileName)
+		{
+			m_filesByDiskPath.insert(std::make_pair(diskPath, fileName));
+
+			string::size_type slash = diskPath.find_last_of('/');
+			string prefix = 
+				(slash == string::npos) ? "" : diskPath.substr(0, slash + 1);
+
+			if(m_watchedPrefixes.count(prefix) != 0)
+				return;
+
+			string directory = prefix.empty() ? "." : prefix;
+			int wd = inotify_add_watch(
+				m_inotify, 
+				directory.c_str(), 
+				IN_CLOSE_WRITE | IN_MOVED_TO | IN_CREATE | IN_DELETE);
+			if(wd >= 0)
+			{
+				// The same directory spelled another way gets the same 
+				// watch, so a watch may have several prefixes.
+				m_watchedPrefixes.insert(prefix);
+				m_prefixesByWatch.insert(std::make_pair(wd, prefix));
+			}
+		}
+
+		//! @details
+		//! Block until at least one known file changes.
+		bool WaitForChanges(std::set<string> *changed)
+		{
+			while(changed->empty())
+			{
+				if(ReadEvents(-1, changed) == false)
+					return false;
+
+				// Let the burst of events settle.
+				while(ReadEvents(WATCH_SETTLE_MILLISECONDS, changed))
+				{
+				}
+			}
+			return true;
+		}
+
+		//! @details
+		//! @return
+		//! false if nothing was read within the timeout, or on error.
+		bool ReadEvents(int timeout, std::set<string> *changed)
+		{
+			pollfd fd;
+			fd.fd = m_inotify;
+			fd.events = POLLIN;
+			if(poll(&fd, 1, timeout) <= 0)
+				return false;
+
+			char buffer[4096] 
+				__attribute__((aligned(__alignof__(struct inotify_event))));
+			ssize_t length = read(m_inotify, buffer, sizeof(buffer));
+			if(length <= 0)
+				return false;
+
+			for(char *pos = buffer; pos < buffer + length; )
+			{
+				inotify_event const *event = reinterpret_cast<inotify_event *>(pos);
+				pos += sizeof(inotify_event) + event->len;
+
+				if(event->len == 0)
+					continue;
+
+				typedef std::multimap<int, string>::const_iterator PrefixIterator;
+				std::pair<PrefixIterator, PrefixIterator> prefixes = 
+					m_prefixesByWatch.equal_range(event->wd);
+				for(PrefixIterator prefix = prefixes.first; prefix != prefixes.second; ++prefix)
+				{
+					typedef std::multimap<string, string>::const_iterator Iterator;
+					std::pair<Iterator, Iterator> range = 
+						m_filesByDiskPath.equal_range(prefix->second + event->name);
+					for(Iterator itr = range.first; itr != range.second; ++itr)
+					{
+						changed->insert(itr->second);
+					}
+				}
+			}
+			return true;
+		}
+
+		SourceOptions m_options;
+		ParsedSources m_sources;
+		DocbookRenderer m_renderer;
+		std::map<string, Section> m_sections;
+
+		//! @details
+		//! Broken links of the last regeneration.
+		vector<string> m_linkProblems;
+
+		int m_inotify;
+		std::set<string> m_watchedPrefixes;
+		std::multimap<int, string> m_prefixesByWatch;
+		std::multimap<string, string> m_filesByDiskPath;
+	};
+
+} // end anonymous namespace
+
+int RunWatch(SourceOptions const &options)
+{
+	SourceWatcher watcher(options);
+	return watcher.Run();
+}
+
+#else
+
+int RunWatch(SourceOptions const &options)
+{
+	std::cerr << "--watch is only supported on Linux." << std::endl;
+	return 1;
+}
+
+#endif // __linux__
+
+}}}}  // end namespace
@@ -1,52 +1,398 @@
-// protoc-gen-docbook
-// http://code.google.com/p/protoc-gen-docbook/
-//
-// Redistribution and use in source and binary forms, with or without
-//// modification, are permitted provided that the following conditions are
-// met:
-//
-//     * Redistributions of source code must retain the above copyright
-// notice, this list of conditions and the following disclaimer.
-//     * Redistributions in binary form must reproduce the above
-// copyright notice, this list of conditions and the following disclaimer
-// in the documentation and/or other materials provided with the
-// distribution.
-//     * Neither the name of Google Inc. nor the names of its
-// contributors may be used to endorse or promote products derived from
-// this software without specific prior written permission.
-//
-// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
-// "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
-// LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
-// A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
-// OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
-// SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
-// LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
-// DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
-// THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
-// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
-// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
-//
-// Author: askldjd@gmail.com
-
-#include <iostream>
-#include <google/protobuf/compiler/plugin.h>
-#include "docbook_generator.h"
-#include "version_info.h"
-
-using namespace google::protobuf::compiler::docbook;
-
-int main(int argc, char* argv[]) {
-	DocbookGenerator dbg;
-
-	if(argc == 2)
-	{
-		std::string arg = argv[1];
-		if(arg == "--version")
-		{
-			std::cout << "version = " << DBK_GENERATOR_VERSION << std::endl;
-			return 0;
-		}
-	}
-	return google::protobuf::compiler::PluginMain(argc, argv, &dbg);
-}
\ No newline at end of file
+// protoc-gen-docbook
+// http://code.google.com/p/protoc-gen-docbook/
+//
+// Redistribution and use in source and binary forms, with or without
+//// modification, are permitted provided that the following conditions are
+// met:
+//
+//     * Redistributions of source code must retain the above copyright
+// notice, this list of conditions and the following disclaimer.
+//     * Redistributions in binary form must reproduce the above
+// copyright notice, this list of conditions and the following disclaimer
+// in the documentation and/or other materials provided with the
+// distribution.
+//     * Neither the name of Google Inc. nor the names of its
+// contributors may be used to endorse or promote products derived from
+// this software without specific prior written permission.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+// "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+// LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+// A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+// OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+// SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+// LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+// DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+// THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+// (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//
+// Author: askldjd@gmail.com
+
+#include <cctype>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <google/protobuf/descriptor.h>
+#include <google/protobuf/io/zero_copy_stream_impl.h>
+#include "docbook_generator.h"
+#include "docbook_heap_profile.h"
+#include "docbook_parsed_sources.h"
+#include "docbook_plugin.h"
+#include "docbook_watch.h"
+#include "version_info.h"
+
+#ifdef _WIN32
+#include <io.h>
+#include <fcntl.h>
+#ifndef STDOUT_FILENO
+#define STDOUT_FILENO 1
+#endif
+#else
+#include <unistd.h>
+#endif
+
+using namespace google::protobuf;
+using namespace google::protobuf::compiler::docbook;
+
+namespace {
+
+	char const *USAGE = 
+		"Usage: protoc-gen-docbook [OPTION] PROTO_FILES\n"
+		"Parse PROTO_FILES and generate their DocBook, without protoc.\n"
+		"  -IPATH, --proto_path=PATH   Directory in which to search for\n"
+		"                              imports. May be given multiple times.\n"
+		"                              [default = current directory]\n"
+		"  --docbook_out=[PARAMS:]DIR  Directory to write the DocBook into,\n"
+		"                              with the same optional k=v parameters\n"
+		"                              as the plugin, or - to write the\n"
+		"                              document to stdout. [default = .]\n"
+		"  -jN, --jobs=N               Number of threads parsing the files.\n"
+		"                              [default = one per processor]\n"
+		"  --watch                     Keep running, and regenerate the\n"
+		"                              DocBook every time one of the files\n"
+		"                              or their imports change. An import\n"
+		"                              not found yet is noticed once it is\n"
+		"                              created, if its directory exists.\n"
+		"  --diff OLD NEW              Instead of PROTO_FILES, write a report\n"
+		"                              of the changes between two descriptor\n"
+		"                              sets (protoc --include_imports\n"
+		"                              --include_source_info -o FILE).\n"
+		"  --merge                     Instead of parsing PROTO_FILES, merge\n"
+		"                              the fragments written by the shards of\n"
+		"                              a run (shard=i/n) into its DocBook.\n"
+		"  --version                   Show version info and exit.\n"
+		"\n"
+		"Without arguments, protoc-gen-docbook runs as a protoc plugin.\n";
+
+	//! @details
+	//! @return
+	//! true if text is a Windows absolute path such as C:\out or C:/out,
+	//! whose colon is not the one before the directory.
+	bool IsWindowsAbsolutePath(std::string const &text)
+	{
+		return text.size() >= 3 && text[1] == ':' && 
+			isalpha(static_cast<unsigned char>(text[0])) &&
+			(text[2] == '/' || text[2] == '\\') &&
+			text.find_last_of(':') == 1;
+	}
+
+	//! @details
+	//! Parse the command line arguments.
+	//!
+	//! @return
+	//! false if the arguments are not valid.
+	//!
+	//! @param[out] diffSets
+	//! The old and new descriptor sets of --diff, empty otherwise.
+	//!
+	//! @param[out] merge
+	//! true if the input files are shard fragments to merge.
+	bool ParseArguments(
+		int argc, 
+		char* argv[], 
+		SourceOptions *options, 
+		bool *watch,
+		std::vector<std::string> *diffSets,
+		bool *merge)
+	{
+		std::string parameter;
+		*watch = false;
+		*merge = false;
+
+		for(int i = 1; i < argc; ++i)
+		{
+			std::string arg = argv[i];
+			if(arg == "--watch")
+			{
+				*watch = true;
+			}
+			else if(arg == "--merge")
+			{
+				*merge = true;
+			}
+			else if(arg == "--diff" && i + 2 < argc)
+			{
+				diffSets->push_back(argv[++i]);
+				diffSets->push_back(argv[++i]);
+			}
+			else if(arg == "-I" && i + 1 < argc)
+			{
+				options->protoPaths.push_back(argv[++i]);
+			}
+			else if(arg.compare(0, 2, "-I") == 0)
+			{
+				options->protoPaths.push_back(arg.substr(2));
+			}
+			else if(arg.compare(0, 13, "--proto_path=") == 0)
+			{
+				options->protoPaths.push_back(arg.substr(13));
+			}
+			else if(arg.compare(0, 14, "--docbook_out=") == 0)
+			{
+				// Split the way protoc does: at the first colon, unless the
+				// whole value is a Windows absolute path.
+				std::string value = arg.substr(14);
+				std::string::size_type colon = value.find_first_of(':');
+				if(colon != std::string::npos && IsWindowsAbsolutePath(value) == false)
+				{
+					parameter = value.substr(0, colon);
+					value = value.substr(colon + 1);
+				}
+				options->outputDirectory = value;
+			}
+			else if(arg == "-j" && i + 1 < argc)
+			{
+				std::istringstream(argv[++i]) >> options->parseThreads;
+			}
+			else if(arg.compare(0, 2, "-j") == 0)
+			{
+				std::istringstream(arg.substr(2)) >> options->parseThreads;
+			}
+			else if(arg.compare(0, 7, "--jobs=") == 0)
+			{
+				std::istringstream(arg.substr(7)) >> options->parseThreads;
+			}
+			else if(arg.empty() == false && arg[0] == '-')
+			{
+				std::cerr << "Unknown option: " << arg << std::endl;
+				return false;
+			}
+			else
+			{
+				options->files.push_back(arg);
+			}
+		}
+
+		if(diffSets->empty() == false)
+		{
+			if(options->files.empty() == false || *watch || *merge)
+			{
+				std::cerr << "--diff takes no input file." << std::endl;
+				return false;
+			}
+		}
+		else if(*merge && *watch)
+		{
+			std::cerr << "--merge cannot be watched." << std::endl;
+			return false;
+		}
+		else if(options->files.empty())
+		{
+			std::cerr << "Missing input file." << std::endl;
+			return false;
+		}
+
+		if(options->outputDirectory == "-" && 
+			(diffSets->empty() == false || *watch || *merge))
+		{
+			std::cerr << "Only the DocBook of PROTO_FILES can be written to stdout." << std::endl;
+			return false;
+		}
+
+		options->docbookOptions = ResolveDocbookOptions(parameter);
+		return true;
+	}
+
+	//! @details
+	//! Parse the files in-process, on several threads, and generate their
+	//! DocBook. Replaces the protoc run, and the CodeGeneratorRequest round
+	//! trip that comes with it.
+	int GenerateFromSources(SourceOptions const &options)
+	{
+		DBK_SET_HEAP_PHASE(HEAP_PHASE_DESCRIPTOR_POOL);
+
+		ParsedSources sources(options.protoPaths);
+		std::vector<std::string> fileNames = options.files;
+		if(sources.MapInputFiles(&fileNames) == false || 
+			sources.Load(fileNames, options.parseThreads) == false)
+		{
+			return 1;
+		}
+
+		// Linking is done by a single pool, in import order.
+		BuildErrorCollector errorCollector;
+		DescriptorPool pool(sources.Database(), &errorCollector);
+
+		std::vector<FileDescriptor const *> files;
+		for(size_t i = 0; i < fileNames.size(); ++i)
+		{
+			FileDescriptor const *file = pool.FindFileByName(fileNames[i]);
+			if(file == NULL)
+			{
+				return 1;
+			}
+			files.push_back(file);
+		}
+
+		std::string error;
+		if(options.outputDirectory == "-")
+		{
+			// The document alone, e.g. to pipe it into an XSLT processor.
+#ifdef _WIN32
+			_setmode(STDOUT_FILENO, _O_BINARY);
+#endif
+			io::FileOutputStream output(STDOUT_FILENO);
+			if(GenerateDocbook(files, options.docbookOptions, &output, &error) == false)
+			{
+				std::cerr << error << std::endl;
+				return 1;
+			}
+			if(output.Close() == false)
+			{
+				std::cerr << "Error writing to stdout." << std::endl;
+				return 1;
+			}
+			return 0;
+		}
+
+		std::map<std::string, std::string> documents;
+		if(GenerateDocbook(files, options.docbookOptions, &documents, &error) == false)
+		{
+			std::cerr << error << std::endl;
+			return 1;
+		}
+
+		DBK_SET_HEAP_PHASE(HEAP_PHASE_FINAL_WRITE);
+		return WriteDocumentsToDirectory(documents, options.outputDirectory) ? 0 : 1;
+	}
+
+	//! @details
+	//! Read a whole file.
+	bool ReadFile(std::string const &fileName, std::string *contents)
+	{
+		std::ifstream in(fileName.c_str(), std::ios::in | std::ios::binary);
+		if(!in)
+		{
+			std::cerr << fileName << ": Unable to open the file." << std::endl;
+			return false;
+		}
+		std::ostringstream buffer;
+		buffer << in.rdbuf();
+		*contents = buffer.str();
+		return true;
+	}
+
+	//! @details
+	//! Write the report of the changes between two descriptor sets.
+	int GenerateDiff(
+		std::string const &oldSetName, 
+		std::string const &newSetName, 
+		SourceOptions const &options)
+	{
+		std::string sets[2];
+		if(ReadFile(oldSetName, &sets[0]) == false || 
+			ReadFile(newSetName, &sets[1]) == false)
+		{
+			return 1;
+		}
+
+		std::map<std::string, std::string> documents;
+		std::string error;
+		if(GenerateDocbookDiff(
+			sets[0], sets[1], options.docbookOptions, &documents, &error) == false)
+		{
+			std::cerr << error << std::endl;
+			return 1;
+		}
+
+		return WriteDocumentsToDirectory(documents, options.outputDirectory) ? 0 : 1;
+	}
+
+	//! @details
+	//! Merge the fragments of the shards of a run into its DocBook.
+	int MergeShards(SourceOptions const &options)
+	{
+		std::map<std::string, std::string> fragments;
+		for(size_t i = 0; i < options.files.size(); ++i)
+		{
+			if(ReadFile(options.files[i], &fragments[options.files[i]]) == false)
+			{
+				return 1;
+			}
+		}
+
+		std::map<std::string, std::string> documents;
+		std::string error;
+		if(MergeDocbookShards(
+			fragments, options.docbookOptions, &documents, &error) == false)
+		{
+			std::cerr << error << std::endl;
+			return 1;
+		}
+
+		return WriteDocumentsToDirectory(documents, options.outputDirectory) ? 0 : 1;
+	}
+
+} // end anonymous namespace
+
+int main(int argc, char* argv[]) {
+	DocbookGenerator dbg;
+
+	if(argc == 2)
+	{
+		std::string arg = argv[1];
+		if(arg == "--version")
+		{
+			std::cout << "version = " << DBK_GENERATOR_VERSION << std::endl;
+			return 0;
+		}
+	}
+
+	// protoc always runs the plugin without arguments. Anything else is the
+	// standalone command line.
+	if(argc > 1)
+	{
+		SourceOptions options;
+		bool watch = false;
+		std::vector<std::string> diffSets;
+		bool merge = false;
+		if(ParseArguments(argc, argv, &options, &watch, &diffSets, &merge) == false)
+		{
+			std::cerr << USAGE;
+			return 1;
+		}
+
+		if(diffSets.empty() == false)
+		{
+			return GenerateDiff(diffSets[0], diffSets[1], options);
+		}
+
+		if(merge)
+		{
+			return MergeShards(options);
+		}
+
+		if(watch)
+		{
+			return RunWatch(options);
+		}
+		return GenerateFromSources(options);
+	}
+
+	// RunPlugin reads the request and builds the descriptor pool before
+	// handing each file to the generator.
+	DBK_SET_HEAP_PHASE(HEAP_PHASE_DESCRIPTOR_POOL);
+
+	return RunPlugin(&dbg);
+}
@@ -1,6 +1,6 @@
-#ifndef VERSION_INFO_H_02102013192026
-#define VERSION_INFO_H_02102013192026
-
-#define DBK_GENERATOR_VERSION "0.3.0"
-
+#ifndef VERSION_INFO_H_02102013192026
+#define VERSION_INFO_H_02102013192026
+
+#define DBK_GENERATOR_VERSION "0.3.0"
+
 #endif // VERSION_INFO_H_02102013192026
\ No newline at end of file
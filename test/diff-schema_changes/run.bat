@@ -0,0 +1,10 @@
+@echo off
+
+:: Report of the changes between the old and the new schema.
+
+cmd /c ..\protoc.exe --proto_path=.\old --include_imports --include_source_info -o old.pb old\schema.proto
+cmd /c ..\protoc.exe --proto_path=.\new --include_imports --include_source_info -o new.pb new\schema.proto
+
+cmd /c protoc-gen-docbook.exe --diff old.pb new.pb --docbook_out=.
+
+cmd /c ..\transform.bat ..\fop-1.1 .\docbook_out.xml .\docbook_out.pdf
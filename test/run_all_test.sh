@@ -0,0 +1,397 @@
+#!/bin/sh
+#
+# Linux counterpart of run_all_test.bat.
+#
+# Runs every example under deploy/ and every test case under test/ through
+# each generation mode, and checks that the generated DocBook is
+# byte-identical to the golden files in test/golden/<case>/. A case whose
+# golden directory holds an error.txt must fail instead, with each line of
+# error.txt in its output.
+#
+# Generation modes:
+#   serial      protoc and the plugin, one thread.
+#   parallel    protoc and the plugin, rendering and writing on 4 threads.
+#   standalone  the plugin parsing the files itself, without protoc.
+#   cached      the plugin in --watch mode, which keeps the section of each
+#               file that did not change. The document is compared once a
+#               file was saved again. If the case holds X.proto.before
+#               files, the watch starts from them instead, then each
+#               X.proto is put back.
+#   split       protoc and the plugin with max_rows_per_table=3, compared
+#               against test/golden_split/<case>/.
+#   direct      the plugin writing the document straight to stdout,
+#               without the lint report or the olink target database.
+#   shard2      two protoc runs with shard=0/2 and shard=1/2, whose 
+#               fragments are then put together by --merge.
+#
+# Each test/diff-* case holds an old/ and a new/ schema instead. Both are
+# compiled to descriptor sets, and the --diff report between them is
+# compared against test/golden/<case>/, once, whatever the modes.
+#
+# With the shard2 mode, --merge must also turn down each fragment whose
+# header is corrupted, with an error rather than a crash.
+#
+# usage: run_all_test.sh [--update] [case ...]
+#
+#   --update   regenerate the golden files from the serial and split mode
+#              output instead of comparing against them.
+#   case       only run the named cases (e.g. test-addressbook).
+#              The diff cases only run with the default modes.
+#
+# Environment:
+#   PROTOC     protoc binary to use [default = protoc]
+#   PLUGIN     protoc-gen-docbook binary [default = ../linux/protoc-gen-docbook]
+#   MODES      generation modes to run [default = all of them]
+#
+
+SCRIPT_DIR=$(cd "$(dirname "$0")" && pwd)
+ROOT_DIR=$(cd "$SCRIPT_DIR/.." && pwd)
+GOLDEN_DIR="$SCRIPT_DIR/golden"
+GOLDEN_SPLIT_DIR="$SCRIPT_DIR/golden_split"
+
+PROTOC=${PROTOC:-protoc}
+PLUGIN=${PLUGIN:-$ROOT_DIR/linux/protoc-gen-docbook}
+PLUGIN=$(cd "$(dirname "$PLUGIN")" && pwd)/$(basename "$PLUGIN")
+
+# Every generation mode the plugin supports. Each one must produce exactly
+# the same document as the serial mode, apart from split which has golden
+# files of its own. A new generation path adds its mode here.
+ALL_MODES="serial parallel standalone cached split direct shard2"
+MODES=${MODES:-$ALL_MODES}
+
+# Rows per table of the split mode.
+SPLIT_ROWS=3
+
+# Seconds to wait for --watch to generate the document.
+WATCH_TIMEOUT=60
+
+UPDATE=0
+if [ "$1" = "--update" ]; then
+	UPDATE=1
+	MODES="serial split"
+	shift
+fi
+CASES="$*"
+
+WORK_DIR=$(mktemp -d "${TMPDIR:-/tmp}/docbook_test.XXXXXX")
+trap 'rm -rf "$WORK_DIR"' EXIT
+
+# Same file and path discovery as run.bat: every .proto below the case
+# directory, with the case directory and its sub-directories as proto paths.
+# A case importing files it does not document lists their directories in
+# proto_paths.txt.
+proto_files() {
+	find . -name '*.proto' | sed 's|^\./||' | sort
+}
+
+proto_paths() {
+	echo "--proto_path=."
+	for d in */; do
+		[ -d "$d" ] && echo "--proto_path=./${d%/}"
+	done
+	[ -f proto_paths.txt ] && sed 's|^|--proto_path=|' proto_paths.txt
+}
+
+# golden_dir <mode>
+golden_dir() {
+	if [ "$1" = split ]; then
+		echo "$GOLDEN_SPLIT_DIR/$case_name"
+	else
+		echo "$GOLDEN_DIR/$case_name"
+	fi
+}
+
+# The document among the golden files of the case: neither the lint
+# report nor the olink target database.
+main_document() {
+	targets=$(sed -n 's/^olink_targets *= *\([^ \r]*\).*/\1/p' docbook.properties 2>/dev/null)
+	ls "$GOLDEN_DIR/$case_name" | grep -v '\.lint$' | grep -vxF "${targets:-.}" | head -n 1
+}
+
+# wait_for_watch <log> <count>
+# Waits until --watch is done with its <count>th generation.
+wait_for_watch() {
+	tries=$((WATCH_TIMEOUT * 10))
+	while [ $tries -gt 0 ]; do
+		done_count=$(grep -c "^Watching for changes" "$1")
+		[ "$done_count" -ge "$2" ] && return 0
+		sleep 0.1
+		tries=$((tries - 1))
+	done
+	echo "--watch timed out" >&2
+	return 1
+}
+
+# watch <output dir>
+# Watches a copy of the case. The other cases are linked next to it, so
+# that paths out of the case, e.g. in proto_paths.txt, still resolve.
+watch() {
+	tree="$1.src"
+	src="$tree/$case_name"
+	mkdir -p "$src"
+	cp -R . "$src/"
+	for sibling in ../*; do
+		[ "$sibling" = "../$case_name" ] || 
+			ln -s "$(cd "$sibling" && pwd)" "$tree/$(basename "$sibling")"
+	done
+
+	edits=$(cd "$src" && find . -name '*.proto.before' | sed 's|^\./||;s|\.before$||')
+	if [ -z "$edits" ]; then
+		edits=$(proto_files | tail -n 1)
+	fi
+	for f in $edits; do
+		[ -f "$src/$f.before" ] && cp "$src/$f.before" "$src/$f"
+	done
+
+	(cd "$src" && exec "$PLUGIN" $(proto_paths) $(proto_files) \
+		--docbook_out="$1" --watch) 2> "$1.watch" &
+	pid=$!
+
+	status=0
+	if wait_for_watch "$1.watch" 1; then
+		# Saved through a rename, like most editors do.
+		for f in $edits; do
+			cp "$f" "$src/$f.new" && mv "$src/$f.new" "$src/$f"
+		done
+		wait_for_watch "$1.watch" 2 || status=1
+	else
+		status=1
+	fi
+
+	kill $pid 2> /dev/null
+	wait $pid 2> /dev/null
+	cat "$1.watch" >&2
+	[ $(grep -c "^Regenerated" "$1.watch") -eq 2 ] || status=1
+	return $status
+}
+
+# generate <mode> <output dir>
+# Runs from within the case directory so docbook.properties is picked up.
+generate() {
+	case "$1" in
+	serial)
+		"$PROTOC" --plugin=protoc-gen-docbook="$PLUGIN" \
+			$(proto_paths) $(proto_files) --docbook_out="$2"
+		;;
+	parallel)
+		"$PROTOC" --plugin=protoc-gen-docbook="$PLUGIN" \
+			$(proto_paths) $(proto_files) --docbook_out=threads=4:"$2"
+		;;
+	standalone)
+		"$PLUGIN" $(proto_paths) $(proto_files) --docbook_out="$2"
+		;;
+	cached)
+		watch "$2"
+		;;
+	split)
+		"$PROTOC" --plugin=protoc-gen-docbook="$PLUGIN" \
+			$(proto_paths) $(proto_files) \
+			--docbook_out=max_rows_per_table=$SPLIT_ROWS:"$2"
+		;;
+	direct)
+		"$PLUGIN" $(proto_paths) $(proto_files) --docbook_out=- \
+			> "$2/$(main_document)"
+		;;
+	shard2)
+		mkdir -p "$2.shards"
+		for shard in 0 1; do
+			"$PROTOC" --plugin=protoc-gen-docbook="$PLUGIN" \
+				$(proto_paths) $(proto_files) \
+				--docbook_out=shard=$shard/2:"$2.shards" || return 1
+		done
+		"$PLUGIN" --merge "$2.shards"/*.shard-* --docbook_out="$2" || return 1
+
+		# Whatever else the shards wrote, e.g. the lint report.
+		for f in "$2.shards"/*; do
+			case "$f" in
+			*.shard-*) ;;
+			*) cp "$f" "$2/" ;;
+			esac
+		done
+		;;
+	*)
+		echo "unknown generation mode: $1" >&2
+		return 1
+		;;
+	esac
+}
+
+# compare <mode> <output dir>
+compare() {
+	if [ "$1" = direct ]; then
+		document=$(main_document)
+		diff "$GOLDEN_DIR/$case_name/$document" "$2/$document"
+	else
+		diff -r "$(golden_dir "$1")" "$2"
+	fi
+}
+
+passed=0
+failed=0
+
+for case_dir in "$ROOT_DIR"/test/test-* "$ROOT_DIR"/deploy/example-*; do
+	[ -d "$case_dir" ] || continue
+	case_name=$(basename "$case_dir")
+
+	if [ -n "$CASES" ]; then
+		case " $CASES " in
+		*" $case_name "*) ;;
+		*) continue ;;
+		esac
+	fi
+
+	cd "$case_dir"
+	if [ -z "$(proto_files)" ]; then
+		cd "$ROOT_DIR"
+		continue
+	fi
+
+	expected_error="$GOLDEN_DIR/$case_name/error.txt"
+
+	for mode in $MODES; do
+		out_dir="$WORK_DIR/$case_name/$mode"
+		mkdir -p "$out_dir"
+
+		if [ -f "$expected_error" ]; then
+			if [ $UPDATE -eq 1 ]; then
+				echo "KEPT $case_name: error.txt is written by hand"
+				break
+			elif generate "$mode" "$out_dir" > "$out_dir.log" 2>&1; then
+				echo "FAIL $case_name [$mode]: generation succeeded"
+				failed=$((failed + 1))
+			else
+				missing=$(while IFS= read -r line; do
+					grep -qF -- "$line" "$out_dir.log" || echo "$line"
+				done < "$expected_error")
+				if [ -z "$missing" ]; then
+					echo "PASS $case_name [$mode]"
+					passed=$((passed + 1))
+				else
+					echo "FAIL $case_name [$mode]: missing from the error"
+					echo "$missing" | sed 's/^/    /'
+					failed=$((failed + 1))
+				fi
+			fi
+			continue
+		fi
+
+		if ! generate "$mode" "$out_dir" > "$out_dir.log" 2>&1; then
+			echo "FAIL $case_name [$mode]: generation failed"
+			sed 's/^/    /' "$out_dir.log"
+			failed=$((failed + 1))
+			continue
+		fi
+
+		if [ $UPDATE -eq 1 ]; then
+			golden=$(golden_dir "$mode")
+			rm -rf "$golden"
+			mkdir -p "$golden"
+			cp "$out_dir"/* "$golden/"
+			echo "UPDATED $case_name [$mode]"
+			continue
+		fi
+
+		if compare "$mode" "$out_dir" > "$out_dir.diff" 2>&1; then
+			echo "PASS $case_name [$mode]"
+			passed=$((passed + 1))
+		else
+			echo "FAIL $case_name [$mode]: output differs from golden files"
+			head -n 20 "$out_dir.diff" | sed 's/^/    /'
+			failed=$((failed + 1))
+		fi
+	done
+
+	cd "$ROOT_DIR"
+done
+
+# Fragment headers --merge must report as corrupted.
+CORRUPT_SHARD_HEADERS='shard="0/-1" files="1"
+shard="-1/2" files="1"
+shard="2/2" files="1"
+shard="0/2" files="-3"
+shard="0/2" files="99999999999999"
+shard="0/" files="1"
+shard="x/2" files="1"
+shard="0/2" files="1x"
+shard="0/2"'
+
+case " $MODES " in
+*" shard2 "*)
+	if [ $UPDATE -eq 0 ] && { [ -z "$CASES" ] || 
+		case " $CASES " in *" merge-corrupt_header "*) true ;; *) false ;; esac; }; then
+		out_dir="$WORK_DIR/merge-corrupt_header"
+		mkdir -p "$out_dir"
+		echo "$CORRUPT_SHARD_HEADERS" | while IFS= read -r header; do
+			printf '<?protoc-gen-docbook-shard %s?>\n' "$header" > "$out_dir/fragment"
+			"$PLUGIN" --merge "$out_dir/fragment" --docbook_out="$out_dir" \
+				> "$out_dir.log" 2>&1
+			status=$?
+			if [ $status -ne 1 ] || 
+				! grep -qF "corrupted shard fragment header" "$out_dir.log"; then
+				echo "    $header: exit status $status"
+				sed 's/^/    /' "$out_dir.log"
+			fi
+		done > "$out_dir.diff"
+		if [ -s "$out_dir.diff" ]; then
+			echo "FAIL merge-corrupt_header [shard2]: not reported as corrupted"
+			head -n 20 "$out_dir.diff"
+			failed=$((failed + 1))
+		else
+			echo "PASS merge-corrupt_header [shard2]"
+			passed=$((passed + 1))
+		fi
+	fi
+	;;
+esac
+
+# diff_report <output dir>
+# Runs from within the case directory so docbook.properties is picked up.
+diff_report() {
+	for schema in old new; do
+		(cd "$schema" && "$PROTOC" --include_imports --include_source_info \
+			-o "$1.$schema.pb" $(proto_paths) $(proto_files)) || return 1
+	done
+	"$PLUGIN" --diff "$1.old.pb" "$1.new.pb" --docbook_out="$1"
+}
+
+for case_dir in "$ROOT_DIR"/test/diff-*; do
+	[ -d "$case_dir" ] || continue
+	[ "$MODES" = "$ALL_MODES" ] || [ $UPDATE -eq 1 ] || break
+	case_name=$(basename "$case_dir")
+
+	if [ -n "$CASES" ]; then
+		case " $CASES " in
+		*" $case_name "*) ;;
+		*) continue ;;
+		esac
+	fi
+
+	cd "$case_dir"
+	out_dir="$WORK_DIR/$case_name/diff"
+	mkdir -p "$out_dir"
+
+	if ! diff_report "$out_dir" > "$out_dir.log" 2>&1; then
+		echo "FAIL $case_name [diff]: generation failed"
+		sed 's/^/    /' "$out_dir.log"
+		failed=$((failed + 1))
+	elif [ $UPDATE -eq 1 ]; then
+		rm -rf "$GOLDEN_DIR/$case_name"
+		mkdir -p "$GOLDEN_DIR/$case_name"
+		cp "$out_dir"/* "$GOLDEN_DIR/$case_name/"
+		echo "UPDATED $case_name [diff]"
+	elif diff -r "$GOLDEN_DIR/$case_name" "$out_dir" > "$out_dir.diff" 2>&1; then
+		echo "PASS $case_name [diff]"
+		passed=$((passed + 1))
+	else
+		echo "FAIL $case_name [diff]: output differs from golden files"
+		head -n 20 "$out_dir.diff" | sed 's/^/    /'
+		failed=$((failed + 1))
+	fi
+
+	cd "$ROOT_DIR"
+done
+
+[ $UPDATE -eq 1 ] && exit 0
+
+echo "$passed passed, $failed failed"
+[ $failed -eq 0 ]